@@ -0,0 +1,104 @@
+/**
+ * @file test_damage.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the damage tracker
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Render_Systems/damage_tracker.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+/* Object space 0 to 2 covers the 200 pixels, so 0.1 is 10 pixels */
+const VkExtent2D EXTENT{200, 200};
+
+/* Only its vertices are looked at, so it needs no vertex buffer */
+std::shared_ptr<hop::ObjectModel> square(float size){
+    std::vector<hop::ObjectModel::Vertex> vertices = {
+        {{0.0f, 0.0f}}, {{0.0f, size}}, {{size, 0.0f}},
+        {{0.0f, size}}, {{size, 0.0f}}, {{size, size}}
+    };
+    return std::make_shared<hop::ObjectModel>(nullptr, 0, vertices);
+}
+
+bool covers(const VkRect2D& rect, int32_t x0, int32_t x1){
+    return rect.offset.x <= x0 && rect.offset.x + static_cast<int32_t>(rect.extent.width) >= x1;
+}
+
+void test_moves(){
+    hop::EntityStore store;
+    hop::DamageTracker tracker;
+    auto mesh = square(0.1f);
+    store.create(mesh, {0.0f, 0.0f});
+    hop::Entity far = store.create(mesh, {1.5f, 1.5f});
+
+    /* Everything is new on the first frame, nothing changed on the next */
+    CHECK(tracker.collect(store, 1.0f, EXTENT).size() == 2);
+    CHECK(tracker.collect(store, 1.0f, EXTENT).empty());
+
+    /* Where it was and where it is overlap, so they become one rectangle */
+    store.move(far, {0.02f, 0.0f});
+    const auto& moved = tracker.collect(store, 1.0f, EXTENT);
+    CHECK(moved.size() == 1);
+    if(moved.size() == 1){
+        CHECK(covers(moved[0], 150, 162));
+    }
+
+    /* A destroyed entity leaves damage where it was drawn */
+    store.destroy(far);
+    const auto& destroyed = tracker.collect(store, 1.0f, EXTENT);
+    CHECK(destroyed.size() == 1);
+    if(destroyed.size() == 1){
+        CHECK(covers(destroyed[0], 152, 162));
+    }
+}
+
+void test_collapse(){
+    hop::EntityStore store;
+    hop::DamageTracker tracker;
+    auto mesh = square(0.1f);
+
+    /* Too many rectangles collapse into their bounding box */
+    for(size_t i = 0; i < hop::DamageTracker::MAX_RECTS + 4; i++){
+        store.create(mesh, {0.4f * (i % 5), 0.4f * (i / 5)});
+    }
+    const auto& rects = tracker.collect(store, 1.0f, EXTENT);
+    CHECK(rects.size() == 1);
+    if(rects.size() == 1){
+        CHECK(covers(rects[0], 0, 170));
+    }
+}
+
+void test_view(){
+    hop::EntityStore store;
+    hop::DamageTracker tracker;
+    store.create(square(0.1f), {0.0f, 0.0f});
+    tracker.collect(store, 1.0f, EXTENT);
+
+    /* A camera change moves everything on screen */
+    glm::mat4 view(1.0f);
+    view[3] = glm::vec4(-0.5f, -1.0f, 0.0f, 1.0f);
+    tracker.set_view(view);
+    const auto& rects = tracker.collect(store, 1.0f, EXTENT);
+    CHECK(rects.size() == 1);
+    if(rects.size() == 1){
+        CHECK(rects[0].extent.width == EXTENT.width && rects[0].extent.height == EXTENT.height);
+    }
+    CHECK(tracker.collect(store, 1.0f, EXTENT).empty());
+}
+
+}
+
+int main(){
+    test_moves();
+    test_collapse();
+    test_view();
+    return unit_test::report("test_damage");
+}
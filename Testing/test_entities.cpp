@@ -0,0 +1,100 @@
+/**
+ * @file test_entities.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the entity store
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Entity/entity_store.hpp"
+
+#include <vector>
+
+namespace {
+
+void test_generations(){
+    hop::EntityStore store;
+    hop::Entity first = store.create();
+    store.destroy(first);
+    CHECK(!store.alive(first));
+
+    /* The slot is reused, the old handle stays dead */
+    hop::Entity second = store.create();
+    CHECK(second.index() == first.index());
+    CHECK(second.generation() == first.generation() + 1);
+    CHECK(store.alive(second));
+    CHECK(!store.alive(first));
+    CHECK(store.size() == 1);
+    CHECK(store.get_handle(second.index()) == second);
+
+    /* Destroying through a stale handle does nothing */
+    store.destroy(first);
+    CHECK(store.alive(second));
+    CHECK(store.size() == 1);
+}
+
+void test_allocate_range(){
+    hop::EntityStore store;
+    store.create();
+    auto range = store.allocate_range(3);
+    CHECK(range.size() == 3);
+    CHECK(range[1].index() == range[0].index() + 1 && range[2].index() == range[1].index() + 1);
+    CHECK(store.size() == 4);
+
+    bool all_alive = true;
+    for(hop::Entity e : range){
+        all_alive = all_alive && store.alive(e);
+    }
+    CHECK(all_alive);
+}
+
+void test_columns(){
+    hop::EntityStore store;
+    hop::Entity e = store.create(nullptr, {0.5f, 0.25f}, {1.0f, 0.0f, 0.0f});
+    uint32_t i = e.index();
+    CHECK(store.translation[i] == glm::vec2(0.5f, 0.25f));
+    CHECK(store.color[i] == glm::vec3(1.0f, 0.0f, 0.0f));
+    CHECK(store.scale[i] == glm::vec2(1.0f));
+
+    /* Moving changes the layer's version, so its recording is known to be stale */
+    uint64_t version = store.get_layer_version(0);
+    store.move(e, {0.5f, 0.0f});
+    CHECK(store.translation[i] == glm::vec2(1.0f, 0.25f));
+    CHECK(store.get_layer_version(0) != version);
+}
+
+void test_draw_order(){
+    hop::EntityStore store;
+    hop::Entity low = store.create();
+    hop::Entity first = store.create(nullptr, glm::vec2(0.0f), glm::vec3(0.0f), 1);
+    hop::Entity second = store.create(nullptr, glm::vec2(0.0f), glm::vec3(0.0f), 1);
+
+    /* Higher layers first, then in creation order */
+    std::vector<uint32_t> expected{first.index(), second.index(), low.index()};
+    CHECK(store.get_draw_order() == expected);
+    CHECK(store.draws_before(first, low));
+    CHECK(!store.draws_before(second, first));
+
+    store.set_layer(low, 2);
+    expected = {low.index(), first.index(), second.index()};
+    CHECK(store.get_draw_order() == expected);
+
+    /* Dead entities are left out and compare as drawn last */
+    store.destroy(first);
+    expected = {low.index(), second.index()};
+    CHECK(store.get_draw_order() == expected);
+    CHECK(store.draws_before(second, first));
+}
+
+}
+
+int main(){
+    test_generations();
+    test_allocate_range();
+    test_columns();
+    test_draw_order();
+    return unit_test::report("test_entities");
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_frame_limiter.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the frame limiter
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Timing/frame_limiter.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+void test_pacing(){
+    hop::FrameLimiter limiter(100);
+    limiter.wait();
+
+    /* Deadlines are on a fixed grid, so 20 frames take 20 frame times */
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 20; i++){
+        limiter.wait();
+    }
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    CHECK(elapsed >= 0.19f);
+    CHECK(limiter.delta_time() >= 0.009f);
+}
+
+void test_stats(){
+    hop::FrameLimiter limiter(100);
+    for(int i = 0; i < 21; i++){
+        limiter.wait();
+    }
+
+    /* The first wait only starts the clock */
+    hop::FrameStats stats = limiter.get_stats();
+    CHECK(stats.frame_count == 20);
+    CHECK(std::abs(stats.target_frame_time - 0.01f) < 1e-6f);
+    CHECK(stats.min_frame_time <= stats.average_frame_time && stats.average_frame_time <= stats.max_frame_time);
+    CHECK(stats.average_frame_time >= 0.009f);
+    CHECK(stats.jitter_mean >= 0.0f && stats.jitter_max >= stats.jitter_mean);
+    CHECK(stats.jitter_stddev >= 0.0f);
+
+    limiter.reset_stats();
+    CHECK(limiter.get_stats().frame_count == 0);
+}
+
+void test_unlimited(){
+    hop::FrameLimiter limiter(100);
+    limiter.set_target_fps(0);
+    CHECK(limiter.get_target_fps() == 0);
+    CHECK(limiter.get_stats().target_frame_time == 0.0f);
+
+    /* Nothing to wait for, the frames go by as fast as they're asked for */
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 100; i++){
+        limiter.wait();
+    }
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    CHECK(elapsed < 0.1f);
+    CHECK(limiter.get_stats().frame_count == 99);
+
+    limiter.set_target_fps(-5);
+    CHECK(limiter.get_target_fps() == 0);
+}
+
+}
+
+int main(){
+    test_pacing();
+    test_stats();
+    test_unlimited();
+    return unit_test::report("test_frame_limiter");
+}
@@ -0,0 +1,121 @@
+/**
+ * @file test_jobs.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the job system
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Jobs/job_system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void test_dependencies(){
+    hop::JobSystem jobs(4);
+    std::atomic<int> step{0};
+    std::atomic<bool> in_order{true};
+
+    auto first = jobs.submit([&](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        step = 1;
+    });
+    auto second = jobs.submit([&](){
+        if(step != 1){ in_order = false; }
+        step = 2;
+    }, {first});
+    auto third = jobs.submit([&](){
+        if(step != 2){ in_order = false; }
+        step = 3;
+    }, {second});
+    jobs.wait(third);
+
+    CHECK(jobs.is_done(first) && jobs.is_done(second) && jobs.is_done(third));
+    CHECK(in_order);
+    CHECK(step == 3);
+
+    /* Main thread jobs only run on the thread that waits for them */
+    std::thread::id ran_on;
+    auto main_job = jobs.submit_main([&](){ ran_on = std::this_thread::get_id(); }, {third});
+    jobs.wait(main_job);
+    CHECK(ran_on == std::this_thread::get_id());
+}
+
+void test_parallel_for(){
+    hop::JobSystem jobs(4);
+    const size_t COUNT = 10000;
+    std::vector<int> hits(COUNT, 0);
+    jobs.parallel_for(COUNT, 64, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            hits[i]++;
+        }
+    });
+
+    bool every_once = true;
+    for(int h : hits){
+        every_once = every_once && h == 1;
+    }
+    CHECK(every_once);
+
+    /* One chunk runs right away on the calling thread */
+    bool called = false;
+    jobs.parallel_for(10, 100, [&](size_t begin, size_t end){ called = begin == 0 && end == 10; });
+    CHECK(called);
+}
+
+void test_configure_while_busy(){
+    hop::JobSystem jobs(2);
+    std::atomic<int> finished{0};
+    for(int i = 0; i < 64; i++){
+        jobs.submit([&](){
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            finished++;
+        });
+    }
+
+    /* Every queued job finishes before the workers are replaced */
+    jobs.configure(3, false);
+    CHECK(finished == 64);
+    CHECK(jobs.thread_count() == 3);
+
+    auto after = jobs.submit([&](){ finished++; });
+    jobs.wait(after);
+    CHECK(finished == 65);
+}
+
+void test_stop_runs_queued(){
+    std::atomic<int> finished{0};
+    {
+        hop::JobSystem jobs(1);
+
+        /* The only worker is busy, so the rest are still queued when the system goes */
+        auto busy = jobs.submit([&](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            finished++;
+        });
+        for(int i = 0; i < 16; i++){
+            jobs.submit([&](){ finished++; });
+        }
+        jobs.submit([&](){ finished++; }, {busy});
+    }
+
+    /* Including the one depending on a job that was still running */
+    CHECK(finished == 18);
+}
+
+}
+
+int main(){
+    test_dependencies();
+    test_parallel_for();
+    test_configure_while_busy();
+    test_stop_runs_queued();
+    return unit_test::report("test_jobs");
+}
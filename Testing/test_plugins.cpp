@@ -0,0 +1,147 @@
+/**
+ * @file test_plugins.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the plugin scheduler
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Engine/engine_plugin.hpp"
+#include "Engine/plugin_scheduler.hpp"
+#include "Jobs/job_system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/* Plugins only hold a reference to the engine, a stand-in keeps Vulkan and GLFW out of the test */
+namespace hop {
+class Engine {};
+}
+
+namespace {
+
+/* Plugin that records when it ran, reading and writing the resources it's given */
+class Recorder : public hop::EnginePlugin {
+public:
+    Recorder(hop::Engine& engine, std::vector<std::string> r, std::vector<std::string> w, std::atomic<int>* clock)
+        : EnginePlugin(engine), r{std::move(r)}, w{std::move(w)}, clock{clock} {}
+
+    void init() override { started = true; }
+    void update(float) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ran_at = (*clock)++;
+        updates++;
+        thread = std::this_thread::get_id();
+        if(on_update){
+            on_update();
+        }
+    }
+    void close() override { closed = true; }
+    std::vector<std::string> reads() const override { return r; }
+    std::vector<std::string> writes() const override { return w; }
+
+    std::vector<std::string> r;
+    std::vector<std::string> w;
+    std::atomic<int>* clock;
+    std::function<void()> on_update;
+    bool started = false;
+    bool closed = false;
+    int updates = 0;
+    int ran_at = -1;
+    std::thread::id thread;
+};
+
+using Resources = std::vector<std::string>;
+
+void test_stages(){
+    hop::Engine engine;
+    hop::JobSystem jobs(4);
+    hop::PluginScheduler scheduler;
+    std::atomic<int> clock{0};
+
+    /* writer and its reader conflict, other writes something else */
+    auto writer = std::make_shared<Recorder>(engine, Resources{}, Resources{"score"}, &clock);
+    auto reader = std::make_shared<Recorder>(engine, Resources{"score"}, Resources{"ui"}, &clock);
+    auto other = std::make_shared<Recorder>(engine, Resources{}, Resources{"physics"}, &clock);
+    auto main = std::make_shared<Recorder>(engine, Resources{}, Resources{hop::EnginePlugin::ENGINE}, &clock);
+    scheduler.add(writer, typeid(Recorder).name());
+    scheduler.add(reader, typeid(Recorder).name());
+    scheduler.add(other, typeid(Recorder).name());
+    scheduler.add(main, typeid(Recorder).name());
+    CHECK(scheduler.get_stage_count() == 2);
+
+    scheduler.init();
+    CHECK(writer->started && reader->started && other->started && main->started);
+
+    scheduler.update(1.0f / 60.0f, jobs);
+    CHECK(writer->updates == 1 && reader->updates == 1 && other->updates == 1 && main->updates == 1);
+    CHECK(reader->ran_at > writer->ran_at);
+
+    /* Plugins touching the engine stay on the thread updating the scheduler */
+    CHECK(main->thread == std::this_thread::get_id());
+
+    /* Every plugin is timed under its readable type name */
+    const auto& times = scheduler.get_times();
+    CHECK(times.size() == 4);
+    bool named = !times.empty();
+    for(const hop::PluginTime& time : times){
+        named = named && time.name.find("Recorder") != std::string::npos && time.update_time > 0.0f;
+    }
+    CHECK(named);
+
+    scheduler.close();
+    CHECK(writer->closed && reader->closed && other->closed && main->closed);
+}
+
+void test_add_while_updating(){
+    hop::Engine engine;
+    hop::JobSystem jobs(4);
+    hop::PluginScheduler scheduler;
+    std::atomic<int> clock{0};
+
+    auto other = std::make_shared<Recorder>(engine, Resources{}, Resources{"physics"}, &clock);
+    scheduler.add(other, typeid(Recorder).name());
+    scheduler.init();
+
+    /* A plugin added during an update only starts once every stage is done */
+    auto late = std::make_shared<Recorder>(engine, Resources{}, Resources{"late"}, &clock);
+    bool started_early = true;
+    bool updating = false;
+    other->on_update = [&](){
+        updating = scheduler.is_updating();
+        scheduler.add(late, typeid(Recorder).name());
+        started_early = late->started;
+    };
+
+    scheduler.update(1.0f / 60.0f, jobs);
+    CHECK(updating);
+    CHECK(!started_early);
+    CHECK(late->started && late->updates == 0);
+    CHECK(scheduler.size() == 2);
+    CHECK(!scheduler.is_updating());
+
+    other->on_update = nullptr;
+    scheduler.update(1.0f / 60.0f, jobs);
+    CHECK(late->updates == 1);
+    CHECK(scheduler.get_times().size() == 2);
+
+    scheduler.close();
+    CHECK(late->closed);
+}
+
+}
+
+int main(){
+    test_stages();
+    test_add_while_updating();
+    return unit_test::report("test_plugins");
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_resolution.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the dynamic resolution scaler
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Renderer/resolution_scaler.hpp"
+
+#include <cmath>
+
+namespace {
+
+using Scaler = hop::ResolutionScaler;
+
+bool near(float a, float b){
+    return std::abs(a - b) < 1e-4f;
+}
+
+void test_lowering(){
+    Scaler scaler(0.016f);
+    CHECK(scaler.get_scale() == Scaler::MAX_SCALE);
+
+    /* Lowering needs LOWER_FRAMES slow frames in a row */
+    for(uint32_t i = 0; i + 1 < Scaler::LOWER_FRAMES; i++){
+        CHECK(!scaler.update(0.02f));
+    }
+    CHECK(scaler.update(0.02f));
+    CHECK(near(scaler.get_scale(), 0.9f));
+
+    /* Frames still in flight at the old scale are ignored */
+    bool changed = false;
+    for(uint32_t i = 0; i < Scaler::SETTLE_FRAMES; i++){
+        changed = changed || scaler.update(0.05f);
+    }
+    CHECK(!changed);
+    CHECK(near(scaler.get_scale(), 0.9f));
+}
+
+void test_hysteresis(){
+    Scaler scaler(0.016f);
+    for(uint32_t i = 0; i < Scaler::LOWER_FRAMES + Scaler::SETTLE_FRAMES; i++){
+        scaler.update(0.02f);
+    }
+
+    /* Under budget, but full resolution wouldn't fit, so it stays */
+    bool changed = false;
+    for(int i = 0; i < 200; i++){
+        changed = changed || scaler.update(0.014f);
+    }
+    CHECK(!changed);
+    CHECK(near(scaler.get_scale(), 0.9f));
+
+    /* Raising waits much longer than lowering */
+    uint32_t frames = 0;
+    while(!scaler.update(0.008f) && frames < 1000){
+        frames++;
+    }
+    CHECK(frames >= Scaler::RAISE_FRAMES);
+    CHECK(scaler.get_scale() == Scaler::MAX_SCALE);
+}
+
+void test_limits(){
+    Scaler scaler(0.016f);
+
+    /* Never below MIN_SCALE */
+    for(int i = 0; i < 1000; i++){
+        scaler.update(1.0f);
+    }
+    CHECK(near(scaler.get_scale(), Scaler::MIN_SCALE));
+
+    /* Never above MAX_SCALE */
+    scaler.reset();
+    CHECK(scaler.get_scale() == Scaler::MAX_SCALE);
+    bool changed = false;
+    for(int i = 0; i < 1000; i++){
+        changed = changed || scaler.update(0.001f);
+    }
+    CHECK(!changed);
+    CHECK(scaler.get_scale() == Scaler::MAX_SCALE);
+}
+
+}
+
+int main(){
+    test_lowering();
+    test_hysteresis();
+    test_limits();
+    return unit_test::report("test_resolution");
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_scene_graph.cpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit tests of the scene graph
+ *
+ */
+
+#include "unit_test.hpp"
+
+#include "Entity/scene_graph.hpp"
+
+#include <cmath>
+
+namespace {
+
+bool near(glm::vec2 a, glm::vec2 b){
+    return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f;
+}
+
+void test_compose(){
+    hop::SceneGraph scene;
+    hop::NodeId parent = scene.create_node();
+    hop::NodeId child = scene.create_node();
+    CHECK(scene.set_parent(child, parent));
+    scene.move(parent, {1.0f, 0.0f});
+    scene.move(child, {0.5f, 1.0f});
+
+    /* Children compose on top of their parent */
+    CHECK(near(scene.get_world_transforms(1.0f)[child].translation, {1.5f, 1.0f}));
+    CHECK(near(scene.world_transform(child).translation, {1.5f, 1.0f}));
+    CHECK(near(scene.world_transform(hop::NO_NODE).translation, {0.0f, 0.0f}));
+
+    /* Flipping the parent mirrors the child around the parent's origin */
+    scene.flip_x(parent, 0.0f);
+    const auto& flipped = scene.get_world_transforms(1.0f);
+    CHECK(near(flipped[child].translation, {0.5f, 1.0f}));
+    CHECK(flipped[child].scale.x < 0.0f);
+}
+
+void test_reparent(){
+    hop::SceneGraph scene;
+    hop::NodeId parent = scene.create_node();
+    hop::NodeId child = scene.create_node();
+    scene.set_parent(child, parent);
+    scene.move(parent, {1.0f, 0.0f});
+    scene.move(child, {0.5f, 1.0f});
+
+    /* Reparenting keeps the world transform */
+    hop::NodeId other = scene.create_node();
+    scene.move(other, {3.0f, 3.0f});
+    glm::vec2 before = scene.world_transform(child).translation;
+    CHECK(scene.set_parent(child, other));
+    CHECK(near(scene.world_transform(child).translation, before));
+    CHECK(near(scene.get_world_transforms(1.0f)[child].translation, before));
+
+    /* A node can't become its own ancestor */
+    CHECK(!scene.set_parent(other, child));
+    CHECK(!scene.set_parent(other, other));
+
+    /* Releasing a node hands its children to its parent where they are */
+    scene.release_node(other);
+    CHECK(near(scene.get_world_transforms(1.0f)[child].translation, before));
+    CHECK(scene.create_node() == other);
+}
+
+void test_interpolation(){
+    hop::SceneGraph scene;
+    hop::NodeId parent = scene.create_node();
+    hop::NodeId child = scene.create_node();
+    scene.set_parent(child, parent);
+    scene.move(child, {1.0f, 0.0f});
+
+    /* Drawn between the previous and current step, children follow their parent */
+    scene.store_previous_translations();
+    scene.move(parent, {0.0f, 2.0f});
+    CHECK(scene.is_interpolating());
+    CHECK(near(scene.get_world_transforms(0.5f)[child].translation, {1.0f, 1.0f}));
+    CHECK(near(scene.get_world_transforms(1.0f)[child].translation, {1.0f, 2.0f}));
+
+    /* Changes bump the version every cached recording depends on */
+    uint64_t version = scene.get_version();
+    scene.move(child, {1.0f, 0.0f});
+    CHECK(scene.get_version() != version);
+}
+
+}
+
+int main(){
+    test_compose();
+    test_reparent();
+    test_interpolation();
+    return unit_test::report("test_scene_graph");
+}
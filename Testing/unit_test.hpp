@@ -0,0 +1,49 @@
+/**
+ * @file unit_test.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Checks shared by the unit tests, each test is its own program
+ *
+ */
+
+#pragma once
+
+#include <iostream>
+
+namespace unit_test {
+
+inline int checks = 0;
+inline int failures = 0;
+
+/**
+ * @brief Records a check, printing it if it failed
+ *
+ * @param passed Result of the check
+ * @param condition The checked expression as written
+ * @param file File the check is in
+ * @param line Line the check is on
+ * @return void
+ */
+inline void check(bool passed, const char* condition, const char* file, int line){
+    checks++;
+    if(!passed){
+        failures++;
+        std::cout << "FAILED " << file << ":" << line << ": " << condition << std::endl;
+    }
+}
+
+/**
+ * @brief Prints how many checks passed
+ *
+ * @param name Name of the test program
+ * @return Exit code of the test program, 1 if any check failed
+ */
+inline int report(const char* name){
+    std::cout << name << ": " << checks - failures << "/" << checks << " checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+}
+
+#define CHECK(condition) ::unit_test::check((condition), #condition, __FILE__, __LINE__)
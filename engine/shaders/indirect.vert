@@ -0,0 +1,35 @@
+#version 450
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec3 color;
+
+layout(location = 0) out vec3 fragColor;
+
+struct Object {
+  vec2 translation;
+  vec2 scale;
+  vec2 boundsMin;
+  vec2 boundsMax;
+  vec4 color;
+  uint firstVertex;
+  uint vertexCount;
+  uint group;
+  uint base;
+  uint rank;
+};
+
+layout(set = 0, binding = 0) uniform Camera {
+  mat4 view;
+  mat4 pixelView;
+} camera;
+
+layout(std430, set = 1, binding = 0) readonly buffer Objects {
+  Object objects[];
+};
+
+void main() {
+  Object o = objects[gl_InstanceIndex];
+  vec4 projected = camera.view * vec4(o.translation + o.scale * position, 0.0, 1.0);
+  gl_Position = vec4(projected.xy, o.color.w, 1.0);
+  fragColor = color * o.color.rgb;
+}
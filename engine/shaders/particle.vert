@@ -0,0 +1,18 @@
+#version 450
+
+layout(location = 0) in vec2 vertex;
+layout(location = 1) in vec2 position;
+layout(location = 2) in float size;
+layout(location = 3) in vec4 color;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(set = 0, binding = 0) uniform Camera {
+  mat4 view;
+  mat4 pixelView;
+} camera;
+
+void main() {
+  gl_Position = camera.pixelView * vec4(position + vertex * size, 0.0, 1.0);
+  fragColor = color;
+}
@@ -0,0 +1,41 @@
+#version 450
+
+layout(location = 0) in vec2 fragLocal;
+layout(location = 1) in vec2 fragHalfSize;
+layout(location = 2) in vec2 fragParams;
+layout(location = 3) in vec3 fragColor;
+layout(location = 4) flat in uint fragShape;
+
+layout(location = 0) out vec4 outColor;
+
+// Same order as hop::SdfShape
+const uint CIRCLE = 0;
+const uint ROUNDED_RECT = 1;
+const uint RING = 2;
+const uint CAPSULE = 3;
+
+// Distance in pixels from the edge of the shape, negative inside
+float shapeDistance(vec2 p) {
+  float radius = fragParams.x;
+  if (fragShape == ROUNDED_RECT) {
+    vec2 q = abs(p) - fragHalfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+  }
+  if (fragShape == RING) {
+    return abs(length(p) - radius) - fragParams.y * 0.5;
+  }
+  if (fragShape == CAPSULE) {
+    float halfLength = fragHalfSize.x - radius;
+    p.x -= clamp(p.x, -halfLength, halfLength);
+  }
+  return length(p) - radius;
+}
+
+void main() {
+  // Pixels half covered by the shape are on its edge
+  float coverage = clamp(0.5 - shapeDistance(fragLocal), 0.0, 1.0);
+  if (coverage <= 0.0) {
+    discard;
+  }
+  outColor = vec4(fragColor, coverage);
+}
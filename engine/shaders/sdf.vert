@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec2 center;
+layout(location = 1) in vec2 halfSize;
+layout(location = 2) in vec2 axis;
+layout(location = 3) in vec2 params;
+layout(location = 4) in vec3 color;
+layout(location = 5) in uint shape;
+
+layout(location = 0) out vec2 fragLocal;
+layout(location = 1) out vec2 fragHalfSize;
+layout(location = 2) out vec2 fragParams;
+layout(location = 3) out vec3 fragColor;
+layout(location = 4) flat out uint fragShape;
+
+layout(set = 0, binding = 0) uniform Camera {
+  mat4 view;
+  mat4 pixelView;
+} camera;
+
+const vec2 corners[6] = vec2[](
+  vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+  vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+void main() {
+  // One pixel of padding so the anti-aliased edge isn't cut off
+  vec2 local = corners[gl_VertexIndex] * (halfSize + 1.0);
+  vec2 position = center + axis * local.x + vec2(-axis.y, axis.x) * local.y;
+  gl_Position = camera.pixelView * vec4(position, 0.0, 1.0);
+  fragLocal = local;
+  fragHalfSize = halfSize;
+  fragParams = params;
+  fragColor = color;
+  fragShape = shape;
+}
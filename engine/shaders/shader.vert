@@ -3,12 +3,22 @@
 layout(location = 0) in vec2 position;
 layout(location = 1) in vec3 color;
 
+layout(location = 0) out vec3 fragColor;
+
+layout(set = 0, binding = 0) uniform Camera {
+  mat4 view;
+  mat4 pixelView;
+} camera;
+
 layout(push_constant) uniform Push {
   mat2 transform;
   vec2 offset;
+  float depth;
   vec3 color;
 } push;
 
 void main() {
-  gl_Position = vec4(push.transform * position + push.offset, 0.0, 1.0);
+  gl_Position = camera.view * vec4(push.transform * position + push.offset, 0.0, 1.0);
+  gl_Position.z = push.depth;
+  fragColor = color * push.color;
 }
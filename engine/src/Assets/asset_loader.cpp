@@ -0,0 +1,20 @@
+#include "asset_loader.hpp"
+
+namespace hop {
+
+AssetLoader::AssetLoader(JobSystem& jobs) : jobs{jobs}, state{std::make_shared<State>()} {}
+
+AssetLoader::~AssetLoader(){
+    /* Queued work sees the flag and skips loading, running work is waited on */
+    state->cancelled = true;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->idle.wait(lock, [this](){ return state->pending == 0; });
+}
+
+void AssetLoader::State::finish(){
+    std::lock_guard<std::mutex> lock(mutex);
+    pending--;
+    idle.notify_all();
+}
+
+}
@@ -0,0 +1,126 @@
+/**
+ * @file asset_loader.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Loads assets on background threads so the game loop never has to wait on
+ * disk reads or file decoding
+ *
+ */
+
+#pragma once
+
+#include "Utilities/status_print.hpp"
+#include "Jobs/job_system.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace hop {
+
+/**
+ * @brief Loads assets on the job system
+ *
+ * Work handed to the loader runs as a job on one of the job system's worker
+ * threads. The caller immediately gets back a std::shared_future that becomes
+ * ready once the work is done, so it can either poll it or keep going and use
+ * the asset later.
+ *
+ * An optional completion callback can be given with the work. Callbacks never
+ * run on a worker thread, they are main thread jobs that depend on the work
+ * and run during JobSystem::run_main_thread_jobs(). This makes it safe for a
+ * callback to touch the rest of the engine (create objects, upload to the
+ * GPU, ...).
+ *
+ * NOTE: Work runs concurrently with the game loop, it must not touch engine
+ *       state that isn't thread safe. Do that in the completion callback.
+ */
+class AssetLoader {
+public:
+    /**
+     * @brief Constructor
+     * @param jobs Job system the work runs on
+     */
+    AssetLoader(JobSystem& jobs);
+
+    /**
+     * @brief Deconstructor
+     *
+     * Work that has not started yet is dropped, work that is running is
+     * finished before this returns. Callbacks that have not run are dropped.
+     */
+    ~AssetLoader();
+
+    // Prevents copying of this object
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    /**
+     * @brief Loads an asset in the background
+     *
+     * If the work throws, the exception is stored in the future and the
+     * completion callback is not called.
+     *
+     * @tparam T Type of the loaded asset
+     * @param work Function that loads the asset, runs on a worker thread
+     * @param on_loaded Called with the asset on the main thread once it's loaded
+     * @return A future that becomes ready when the asset is loaded
+     */
+    template<typename T>
+    std::shared_future<T> load(std::function<T()> work, std::function<void(const T&)> on_loaded = nullptr){
+        auto task = std::make_shared<std::packaged_task<T()>>(std::move(work));
+        std::shared_future<T> future = task->get_future().share();
+
+        std::shared_ptr<State> state = this->state;
+        state->pending++;
+        JobHandle loaded = jobs.submit([state, task](){
+            if(!state->cancelled){
+                (*task)();
+            }
+            state->finish();
+        });
+
+        if(on_loaded){
+            jobs.submit_main([state, future, on_loaded](){
+                if(state->cancelled){
+                    return;
+                }
+                try {
+                    const T& asset = future.get();
+                    on_loaded(asset);
+                } catch(const std::exception& e){
+                    WARNING("ASSET LOADER", e.what());
+                }
+            }, {loaded});
+        }
+
+        return future;
+    }
+
+    /**
+     * @brief Amount of work that has not finished yet
+     * @return Pending work count, including work that is currently running
+     */
+    size_t pending() const { return state->pending; }
+
+private:
+    /* Shared with the jobs, which can outlive the loader */
+    struct State {
+        std::atomic<size_t> pending{0};
+        std::atomic<bool> cancelled{false};
+        std::mutex mutex;
+        std::condition_variable idle;
+
+        void finish();
+    };
+
+    JobSystem& jobs;
+    std::shared_ptr<State> state;
+};
+
+}
@@ -15,6 +15,7 @@ bool AudioEngine::init(){
     }
     else{
     }
+    initialized = true;
     return true;
 }
 
@@ -29,9 +30,10 @@ AudioEngine::EngineSound::~EngineSound(){
 }
 
 
-bool AudioEngine::EngineSound::init(ma_engine* engine, bool loop_sound){
+bool AudioEngine::EngineSound::init(ma_engine* engine, bool loop_sound, bool decode){
 this->engine = engine;
-ma_result result = ma_sound_init_from_file(engine, file_path.c_str(), 0, NULL, NULL, &sound);
+ma_uint32 flags = decode ? MA_SOUND_FLAG_DECODE : 0;
+ma_result result = ma_sound_init_from_file(engine, file_path.c_str(), flags, NULL, NULL, &sound);
 if (result != MA_SUCCESS) {
     return false;
 }
@@ -44,16 +46,20 @@ else{
 
 }
 
-std::shared_ptr<AudioEngine::EngineSound> AudioEngine::create_sound(const char* file_name, bool loop_sound){
+std::shared_ptr<AudioEngine::EngineSound> AudioEngine::create_sound(const char* file_name, bool loop_sound, bool decode){
 
+    if(!initialized){
+        return nullptr;
+    }
     std::shared_ptr<EngineSound> return_sound = std::make_shared<EngineSound>(file_name);
-    if(!(return_sound->init(&this->engine, loop_sound))){
+    if(!(return_sound->init(&this->engine, loop_sound, decode))){
         return nullptr;
     }
     else{
         if(loop_sound){
 
         }
+        std::lock_guard<std::mutex> lock(sounds_mutex);
         sounds.push_back(return_sound);
         return return_sound;
     }
@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <mutex>
+#include <atomic>
 
 namespace hop{
 
@@ -19,7 +21,7 @@ class AudioEngine{
 
         EngineSound(const char* file_name);
         ~EngineSound();
-        bool init(ma_engine* engine, bool loop_sound);
+        bool init(ma_engine* engine, bool loop_sound, bool decode = false);
         void play();
         void pause();
 
@@ -29,12 +31,17 @@ class AudioEngine{
         std::string file_path;
 
     };
-    std::shared_ptr<EngineSound> create_sound(const char* file_name, bool loop_sound);
+    // Safe to call from any thread once init() has returned, returns nullptr
+    // before that or if init() failed. When decode is true the whole file is
+    // decoded up front instead of streamed while playing
+    std::shared_ptr<EngineSound> create_sound(const char* file_name, bool loop_sound, bool decode = false);
 
     private:
 
     ma_engine engine;
+    std::atomic<bool> initialized{false};
     std::vector<std::shared_ptr<EngineSound>> sounds;
+    std::mutex sounds_mutex;
 
 
 };
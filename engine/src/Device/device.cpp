@@ -2,6 +2,7 @@
 
 #include "Utilities/status_print.hpp"
 
+#include <algorithm>
 #include <set>
 #include <cstring>
 
@@ -35,10 +36,25 @@ Device::Device(Window& win) : window{win} {
 }
 
 Device::~Device(){
+    wait_for_uploads();
+    for(StagingBlock& block : free_staging_blocks){
+        destroy_staging_block(block);
+    }
+
     if(enable_validation_layers){
         destroy_debug_utils_messenger_EXT(instance, debug_messenger, nullptr);
     }
 
+    for(VkSemaphore s : upload_semaphores){
+        vkDestroySemaphore(device, s, nullptr);
+    }
+    for(VkSemaphore s : free_semaphores){
+        vkDestroySemaphore(device, s, nullptr);
+    }
+
+    if(dedicated_transfer){
+        vkDestroyCommandPool(device, transfer_command_pool, nullptr);
+    }
     vkDestroyCommandPool(device, command_pool, nullptr);
     VK_INFO("destroyed command pool");
 
@@ -256,9 +272,8 @@ void Device::pick(){
 
     if(physical_device == VK_NULL_HANDLE){ VK_ERROR("failed to find a suitable GPU"); }
     
-    VkPhysicalDeviceProperties device_properties;
-    vkGetPhysicalDeviceProperties(physical_device, &device_properties);
-    VK_INFO("physical device: " << device_properties.deviceName);
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    VK_INFO("physical device: " << properties.deviceName);
 }
 
 bool Device::is_device_suitable(VkPhysicalDevice device){
@@ -303,6 +318,21 @@ bool Device::check_device_extension_support(VkPhysicalDevice device){
     return required_extensions.empty();
 }
 
+bool Device::supports_extension(VkPhysicalDevice device, const char* name){
+    uint32_t count;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &count, extensions.data());
+
+    for(const auto& e : extensions){
+        if(std::string(e.extensionName) == name){
+            return true;
+        }
+    }
+    return false;
+}
+
 QueFamilyIndices Device::find_que_families(VkPhysicalDevice device){
     QueFamilyIndices indices;
     
@@ -315,9 +345,15 @@ QueFamilyIndices Device::find_que_families(VkPhysicalDevice device){
     vkGetPhysicalDeviceQueueFamilyProperties(device, &count, que_families.data());
 
     for(size_t i = 0; i < count; i++){
-        /* Check to see if one of the queue families support VK_QUEUE_GRAPHICS_BIT */
-        if(que_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT){
-            indices.graphics_family = i;
+        VkQueueFlags flags = que_families[i].queueFlags;
+
+        /* Check to see if one of the queue families support VK_QUEUE_GRAPHICS_BIT, prefer ones that compute too */
+        if(flags & VK_QUEUE_GRAPHICS_BIT){
+            bool compute = (flags & VK_QUEUE_COMPUTE_BIT) != 0;
+            if(!indices.graphics_compute || compute){
+                indices.graphics_family = i;
+                indices.graphics_compute = compute;
+            }
         }
 
         /* Check to see if one of the queue families support surfaceKHR presentation */ 
@@ -326,6 +362,18 @@ QueFamilyIndices Device::find_que_families(VkPhysicalDevice device){
         if(present_support){
             indices.present_family = i;
         }
+
+        /* 
+        A transfer family without graphics usually maps to the GPU's copy 
+        engines, copies there run alongside rendering. Families without
+        compute as well are the most dedicated, prefer those.
+        */
+        if((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)){
+            bool pure_transfer = !(flags & VK_QUEUE_COMPUTE_BIT);
+            if(!indices.transfer_family.has_value() || pure_transfer){
+                indices.transfer_family = i;
+            }
+        }
     }
 
     return indices;
@@ -333,12 +381,16 @@ QueFamilyIndices Device::find_que_families(VkPhysicalDevice device){
 
 void Device::create_logical_device(){
     QueFamilyIndices indices = find_que_families(physical_device);
+    que_indices = indices;
 
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
     std::set<uint32_t> unique_queue_families = {
         indices.graphics_family.value(),
         indices.present_family.value()
     };
+    if(indices.transfer_family.has_value()){
+        unique_queue_families.insert(indices.transfer_family.value());
+    }
 
     float queue_priority = 1.f;
     for(uint32_t qf : unique_queue_families){        
@@ -352,15 +404,36 @@ void Device::create_logical_device(){
 
     VkPhysicalDeviceFeatures features = {};
 
+    /* Drawing GPU generated draws needs many draws per call starting at any instance */
+    VkPhysicalDeviceFeatures supported_features = {};
+    vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+    bool indirect_count = supported_features.multiDrawIndirect
+        && supported_features.drawIndirectFirstInstance
+        && supports_extension(physical_device, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if(indirect_count){
+        features.multiDrawIndirect = VK_TRUE;
+        features.drawIndirectFirstInstance = VK_TRUE;
+    }
+
     VkDeviceCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.pEnabledFeatures = &features;
 
-    /* enable VK_KHR_swapchain */
-    create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
-    create_info.ppEnabledExtensionNames = device_extensions.data();
+    /* enable VK_KHR_swapchain, and optional extensions the device has */
+    std::vector<const char*> extensions = device_extensions;
+    if(supports_extension(physical_device, VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME)){
+        extensions.push_back(VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+        incremental_present = true;
+        VK_INFO("enabled " << VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+    }
+    if(indirect_count){
+        extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        VK_INFO("enabled " << VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+    create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    create_info.ppEnabledExtensionNames = extensions.data();
 
     /* This is unnecessary but we have this here to support older vulkan devices */
     if(enable_validation_layers){
@@ -375,8 +448,21 @@ void Device::create_logical_device(){
     }
     VK_INFO("created logical device");
 
+    if(indirect_count){
+        cmd_draw_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>(vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR"));
+    }
+
     vkGetDeviceQueue(device, indices.graphics_family.value(), 0, &gfx_queue);
     vkGetDeviceQueue(device, indices.present_family.value(), 0, &present_queue);
+
+    if(indices.transfer_family.has_value()){
+        dedicated_transfer = true;
+        vkGetDeviceQueue(device, indices.transfer_family.value(), 0, &transfer_queue);
+        VK_INFO("using dedicated transfer queue family " << indices.transfer_family.value());
+    } else {
+        transfer_queue = gfx_queue;
+        VK_INFO("no dedicated transfer queue family, uploading on graphics queue");
+    }
 }
 
 SwapChainSupportDetails Device::query_swapchain_support(VkPhysicalDevice device){
@@ -415,6 +501,12 @@ VkFormat Device::find_supported_format(const std::vector<VkFormat>& candidates,
     VK_ERROR("failed to find supported format");
 }
 
+bool Device::supports_format_features(VkFormat format, VkFormatFeatureFlags features){
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &format_properties);
+    return (format_properties.optimalTilingFeatures & features) == features;
+}
+
 uint32_t Device::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties mem_properties;
     vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
@@ -434,6 +526,16 @@ void Device::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemory
     buffer_info.usage = usage;
     buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    /* Upload targets are written by the transfer queue and read by the graphics queue */
+    uint32_t qfi[2];
+    if(dedicated_transfer && (usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT)){
+        qfi[0] = que_indices.graphics_family.value();
+        qfi[1] = que_indices.transfer_family.value();
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = 2;
+        buffer_info.pQueueFamilyIndices = qfi;
+    }
+
     if(vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS){
         VK_ERROR("failed to create vertex buffer");
     }
@@ -480,8 +582,17 @@ void Device::end_single_time_commands(VkCommandBuffer command_buffer){
     submit_info.commandBufferCount = 1;
     submit_info.pCommandBuffers = &command_buffer;
 
-    vkQueueSubmit(gfx_queue, 1, &submit_info, VK_NULL_HANDLE);
-    vkQueueWaitIdle(gfx_queue);
+    /* Wait on just this submission instead of the whole queue going idle */
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if(vkCreateFence(device, &fence_info, nullptr, &fence) != VK_SUCCESS){
+        VK_ERROR("failed to create fence for single time commands");
+    }
+
+    vkQueueSubmit(gfx_queue, 1, &submit_info, fence);
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device, fence, nullptr);
 
     vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
 }
@@ -541,6 +652,198 @@ void Device::create_image_with_info(const VkImageCreateInfo& image_info, VkMemor
     }
 }
 
+void Device::upload_buffer_async(const void* data, VkDeviceSize size, VkBuffer dst_buffer, VkDeviceSize dst_offset){
+    if(recording_upload.command_buffer == VK_NULL_HANDLE){
+        begin_upload_batch();
+    }
+
+    std::vector<StagingBlock>& blocks = recording_upload.blocks;
+    if(blocks.empty() || blocks.back().size - blocks.back().used < size){
+        blocks.push_back(get_staging_block(size));
+    }
+    StagingBlock& block = blocks.back();
+    memcpy(static_cast<char*>(block.mapped) + block.used, data, static_cast<size_t>(size));
+
+    VkBufferCopy copy_region{};
+    copy_region.srcOffset = block.used;
+    copy_region.dstOffset = dst_offset;
+    copy_region.size = size;
+    vkCmdCopyBuffer(recording_upload.command_buffer, block.buffer, dst_buffer, 1, &copy_region);
+
+    /* Keeps every copy's source 16 byte aligned */
+    block.used = std::min(block.size, (block.used + size + 15) & ~static_cast<VkDeviceSize>(15));
+}
+
+void Device::flush_uploads(){
+    if(recording_upload.command_buffer == VK_NULL_HANDLE){
+        return;
+    }
+    PendingUpload upload = std::move(recording_upload);
+    recording_upload = PendingUpload{};
+
+    /* 
+    On the graphics queue, make the copies visible to every draw submitted 
+    after them. A transfer queue can't name the vertex input stage, there the
+    semaphore the graphics submit waits on does the same job.
+    */
+    if(!dedicated_transfer){
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        vkCmdPipelineBarrier(
+            upload.command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr
+        );
+    }
+
+    if(vkEndCommandBuffer(upload.command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record upload command buffer");
+    }
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if(vkCreateFence(device, &fence_info, nullptr, &upload.fence) != VK_SUCCESS){
+        VK_ERROR("failed to create upload fence");
+    }
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &upload.command_buffer;
+
+    VkSemaphore finished = VK_NULL_HANDLE;
+    if(dedicated_transfer){
+        finished = get_semaphore();
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &finished;
+    }
+
+    if(vkQueueSubmit(transfer_queue, 1, &submit_info, upload.fence) != VK_SUCCESS){
+        VK_ERROR("failed to submit upload");
+    }
+
+    if(finished != VK_NULL_HANDLE){
+        upload_semaphores.push_back(finished);
+    }
+
+    pending_uploads.push_back(std::move(upload));
+}
+
+size_t Device::poll_uploads(){
+    auto finished = [this](PendingUpload& upload){
+        if(vkGetFenceStatus(device, upload.fence) != VK_SUCCESS){
+            return false;
+        }
+        release_upload(upload);
+        return true;
+    };
+    pending_uploads.erase(std::remove_if(pending_uploads.begin(), pending_uploads.end(), finished), pending_uploads.end());
+    return pending_uploads.size();
+}
+
+void Device::wait_for_uploads(){
+    flush_uploads();
+    for(auto& upload : pending_uploads){
+        vkWaitForFences(device, 1, &upload.fence, VK_TRUE, UINT64_MAX);
+        release_upload(upload);
+    }
+    pending_uploads.clear();
+}
+
+void Device::begin_upload_batch(){
+    recording_upload.pool = dedicated_transfer ? transfer_command_pool : command_pool;
+
+    VkCommandBufferAllocateInfo allocation_info = {};
+    allocation_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocation_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocation_info.commandPool = recording_upload.pool;
+    allocation_info.commandBufferCount = 1;
+    if(vkAllocateCommandBuffers(device, &allocation_info, &recording_upload.command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to allocate upload command buffer");
+    }
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if(vkBeginCommandBuffer(recording_upload.command_buffer, &begin_info) != VK_SUCCESS){
+        VK_ERROR("failed to begin recording upload command buffer");
+    }
+}
+
+Device::StagingBlock Device::get_staging_block(VkDeviceSize size){
+    if(size <= STAGING_BLOCK_SIZE && !free_staging_blocks.empty()){
+        StagingBlock block = free_staging_blocks.back();
+        free_staging_blocks.pop_back();
+        block.used = 0;
+        return block;
+    }
+
+    /* Uploads bigger than a block get a block of their own, it's freed instead of reused */
+    StagingBlock block;
+    block.size = std::max(size, STAGING_BLOCK_SIZE);
+    create_buffer(
+        block.size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        block.buffer,
+        block.memory
+    );
+    if(vkMapMemory(device, block.memory, 0, block.size, 0, &block.mapped) != VK_SUCCESS){
+        VK_ERROR("failed to map staging memory");
+    }
+    return block;
+}
+
+void Device::destroy_staging_block(StagingBlock& block){
+    vkUnmapMemory(device, block.memory);
+    vkDestroyBuffer(device, block.buffer, nullptr);
+    vkFreeMemory(device, block.memory, nullptr);
+}
+
+void Device::release_upload(PendingUpload& upload){
+    vkDestroyFence(device, upload.fence, nullptr);
+    vkFreeCommandBuffers(device, upload.pool, 1, &upload.command_buffer);
+    for(StagingBlock& block : upload.blocks){
+        if(block.size == STAGING_BLOCK_SIZE && free_staging_blocks.size() < MAX_FREE_STAGING_BLOCKS){
+            free_staging_blocks.push_back(block);
+        } else {
+            destroy_staging_block(block);
+        }
+    }
+    upload.blocks.clear();
+}
+
+std::vector<VkSemaphore> Device::take_upload_semaphores(){
+    flush_uploads();
+    std::vector<VkSemaphore> taken;
+    taken.swap(upload_semaphores);
+    return taken;
+}
+
+void Device::recycle_semaphores(std::vector<VkSemaphore>& semaphores){
+    free_semaphores.insert(free_semaphores.end(), semaphores.begin(), semaphores.end());
+    semaphores.clear();
+}
+
+VkSemaphore Device::get_semaphore(){
+    if(!free_semaphores.empty()){
+        VkSemaphore s = free_semaphores.back();
+        free_semaphores.pop_back();
+        return s;
+    }
+
+    VkSemaphoreCreateInfo semaphore_info = {};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VkSemaphore s;
+    if(vkCreateSemaphore(device, &semaphore_info, nullptr, &s) != VK_SUCCESS){
+        VK_ERROR("failed to create upload semaphore");
+    }
+    return s;
+}
+
 void Device::create_command_pool(){
     QueFamilyIndices qfi = find_physical_que_families();
     
@@ -557,6 +860,14 @@ void Device::create_command_pool(){
         VK_ERROR("failed to create command pool");
     }
     VK_INFO("created command pool");
+
+    if(dedicated_transfer){
+        pool_info.queueFamilyIndex = qfi.transfer_family.value();
+        if (vkCreateCommandPool(device, &pool_info, nullptr, &transfer_command_pool) != VK_SUCCESS) {
+            VK_ERROR("failed to create transfer command pool");
+        }
+        VK_INFO("created transfer command pool");
+    }
 }
 
 VkDevice Device::get_vk_device(){
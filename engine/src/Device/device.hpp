@@ -40,6 +40,12 @@ struct QueFamilyIndices {
     std::optional<uint32_t> graphics_family;
     std::optional<uint32_t> present_family;
 
+    /* Optional, only set if the device has a transfer family without graphics */
+    std::optional<uint32_t> transfer_family;
+
+    /* Whether the graphics family can also dispatch compute work */
+    bool graphics_compute = false;
+
     bool operator~(){
         return graphics_family.has_value() && present_family.has_value();
     }
@@ -118,6 +124,68 @@ public:
      * @return
      */
     VkQueue get_present_que(){ return present_queue; }
+
+    /**
+     * @brief Gets the queue uploads are submitted to
+     *
+     * This is a dedicated transfer queue if the device has one, otherwise it
+     * is the graphics queue.
+     *
+     * @return Transfer que in a `VkQueue` struct
+     */
+    VkQueue get_transfer_que(){ return transfer_queue; }
+
+    /**
+     * @brief Checks if uploads run on their own queue
+     * @return true if a dedicated transfer queue family is used
+     */
+    bool has_dedicated_transfer_que() const { return dedicated_transfer; }
+
+    /**
+     * @brief Checks if compute work can be recorded with graphics work
+     * @return true if the graphics queue family supports compute
+     */
+    bool supports_compute() const { return que_indices.graphics_compute; }
+
+    /**
+     * @brief Checks if VK_KHR_incremental_present is enabled
+     *
+     * With it, presenting can tell the presentation engine which parts of
+     * the image changed.
+     *
+     * @return true if the extension is enabled
+     */
+    bool has_incremental_present() const { return incremental_present; }
+
+    /**
+     * @brief Checks if GPU generated draws can be submitted
+     *
+     * True when VK_KHR_draw_indirect_count is enabled along with the
+     * multiDrawIndirect and drawIndirectFirstInstance features, so a buffer
+     * of draws whose count is also in a buffer can be drawn with one call.
+     *
+     * @return true if draw_indirect_count can be used
+     */
+    bool has_draw_indirect_count() const { return cmd_draw_indirect_count != nullptr; }
+
+    /**
+     * @brief Checks if the GPU can time work on the graphics queue
+     *
+     * Timestamps are in ticks of get_timestamp_period() nanoseconds.
+     *
+     * @return true if timestamps can be written on graphics and compute queues
+     */
+    bool supports_timestamps() const { return properties.limits.timestampComputeAndGraphics == VK_TRUE && properties.limits.timestampPeriod > 0.0f; }
+    float get_timestamp_period() const { return properties.limits.timestampPeriod; }
+
+    /**
+     * @brief Records vkCmdDrawIndirectCountKHR
+     *
+     * NOTE: Only valid if has_draw_indirect_count()
+     */
+    void draw_indirect_count(VkCommandBuffer command_buffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer count_buffer, VkDeviceSize count_offset, uint32_t max_draw_count, uint32_t stride){
+        cmd_draw_indirect_count(command_buffer, buffer, offset, count_buffer, count_offset, max_draw_count, stride);
+    }
     
     /**
      * @brief
@@ -164,6 +232,14 @@ public:
      */
     VkFormat find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
+    /**
+     * @brief Checks if images of a format with optimal tiling support features
+     * @param format
+     * @param features Every feature that's needed
+     * @return true if all of them are supported
+     */
+    bool supports_format_features(VkFormat format, VkFormatFeatureFlags features);
+
     /**
      * @brief
      *
@@ -217,6 +293,85 @@ public:
      * @return
      */
     void create_image_with_info(const VkImageCreateInfo& image_info, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& image_memory);
+
+    /**
+     * @brief Uploads data into a device local buffer without waiting on it
+     *
+     * The data is copied into a staging block right away, so the caller can
+     * free it as soon as this returns. Uploads are only recorded here, every
+     * upload since the last flush is submitted together by flush_uploads with
+     * one command buffer and fence, however many shapes were created. Staging
+     * blocks are reused once the batch's fence signals, nothing ever waits
+     * for a queue to be idle.
+     *
+     * If the device has a dedicated transfer queue, the batch runs there and
+     * signals one semaphore. The next graphics submit waits on that semaphore
+     * (see take_upload_semaphores) so drawing never reads a half copied
+     * buffer, while the rest of the frame runs in parallel with the copy.
+     * Otherwise the batch is submitted to the graphics queue with a barrier
+     * that makes it visible to every draw submitted after it.
+     *
+     * Either way the buffer can be drawn from straight away.
+     *
+     * NOTE: Must be called from the main thread
+     * NOTE: dst_buffer must have been created with VK_BUFFER_USAGE_TRANSFER_DST_BIT
+     *       by create_buffer, so it can be shared with the transfer queue
+     *
+     * @param data Data to upload
+     * @param size Size of data in bytes
+     * @param dst_buffer Buffer the data is copied into
+     * @param dst_offset Offset into dst_buffer in bytes
+     * @return void
+     */
+    void upload_buffer_async(const void* data, VkDeviceSize size, VkBuffer dst_buffer, VkDeviceSize dst_offset = 0);
+
+    /**
+     * @brief Submits every upload recorded since the last flush
+     *
+     * Called by take_upload_semaphores and wait_for_uploads, so uploads are
+     * always submitted before the frame that draws them.
+     *
+     * @return void
+     */
+    void flush_uploads();
+
+    /**
+     * @brief Frees staging buffers of uploads that have finished
+     *
+     * This is cheap and should be called once per frame.
+     *
+     * @return Amount of upload batches still in flight
+     */
+    size_t poll_uploads();
+
+    /**
+     * @brief Blocks until every upload has finished
+     * @return void
+     */
+    void wait_for_uploads();
+
+    /**
+     * @brief Takes the semaphores of uploads the graphics queue hasn't waited on
+     *
+     * Flushes the uploads first, see flush_uploads.
+     *
+     * The caller must make its next graphics submit wait on every returned
+     * semaphore, and hand them back with recycle_semaphores once that submit
+     * has finished executing.
+     *
+     * @return Semaphores signaled by uploads, empty without a transfer queue
+     */
+    std::vector<VkSemaphore> take_upload_semaphores();
+
+    /**
+     * @brief Returns semaphores to the device for reuse
+     *
+     * NOTE: Every wait on the semaphores must have completed
+     *
+     * @param semaphores Semaphores from take_upload_semaphores
+     * @return void
+     */
+    void recycle_semaphores(std::vector<VkSemaphore>& semaphores);
     
     VkPhysicalDeviceProperties properties;
 
@@ -239,6 +394,7 @@ private:
     void pick();
     bool is_device_suitable(VkPhysicalDevice);
     bool check_device_extension_support(VkPhysicalDevice);
+    bool supports_extension(VkPhysicalDevice, const char* name);
     QueFamilyIndices find_que_families(VkPhysicalDevice);
 
     /* Functions for creating and setting up logical device*/
@@ -249,6 +405,37 @@ private:
 
     /* Functions for command pool */
     void create_command_pool();
+    VkSemaphore get_semaphore();
+
+    /* Part of a persistently mapped staging buffer that uploads are copied into */
+    struct StagingBlock {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkDeviceSize size = 0;
+        VkDeviceSize used = 0;
+    };
+
+    /* Uploads submitted together */
+    struct PendingUpload {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        std::vector<StagingBlock> blocks;
+    };
+
+    static constexpr VkDeviceSize STAGING_BLOCK_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t MAX_FREE_STAGING_BLOCKS = 4;
+
+    void begin_upload_batch();
+    StagingBlock get_staging_block(VkDeviceSize size);
+    void destroy_staging_block(StagingBlock& block);
+    void release_upload(PendingUpload& upload);
+    PendingUpload recording_upload;
+    std::vector<PendingUpload> pending_uploads;
+    std::vector<StagingBlock> free_staging_blocks;
+    std::vector<VkSemaphore> upload_semaphores;
+    std::vector<VkSemaphore> free_semaphores;
 
     VkInstance instance;
     VkDebugUtilsMessengerEXT debug_messenger;
@@ -258,7 +445,13 @@ private:
     VkDevice device;
     VkQueue gfx_queue;
     VkQueue present_queue;
+    VkQueue transfer_queue;
     VkCommandPool command_pool;
+    VkCommandPool transfer_command_pool;
+    QueFamilyIndices que_indices;
+    bool dedicated_transfer = false;
+    bool incremental_present = false;
+    PFN_vkCmdDrawIndirectCountKHR cmd_draw_indirect_count = nullptr;
 
     const std::vector<const char*> validation_layers = {"VK_LAYER_KHRONOS_validation"};
     const std::vector<const char*> device_extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -1,6 +1,7 @@
 #include "engine.hpp"
 #include "Utilities/status_print.hpp"
 #include <algorithm>
+#include <cmath>
 
 namespace hop {
 
@@ -10,7 +11,13 @@ Engine::Engine(const char* window_title){
 }
 
 Engine::~Engine(){
+    /* Does nothing if the window already closed them */
+    plugins.close();
 
+    /* Frames may still be in flight, let them finish before anything is freed */
+    if(device != nullptr){
+        vkDeviceWaitIdle(device->get_device());
+    }
 }
 
 void Engine::run(bool fullscreen){
@@ -18,66 +25,154 @@ void Engine::run(bool fullscreen){
     EngineGameObject::set_resolution(this->width,this->height);
     window->Initialize(fullscreen);
     device = std::make_shared<Device>(*window);
-    renderer = std::make_shared<Renderer>(*window, *device);
-    render_system = std::make_shared<ObjectRenderSystem>(*device, renderer->get_swapchain_render_pass());
+    renderer = std::make_shared<Renderer>(*window, *device, latency_mode);
+    if(frames_in_flight > 0){
+        renderer->set_frames_in_flight(frames_in_flight);
+    }
+    camera.set_resolution(this->width, this->height);
+    camera_buffer = std::make_unique<CameraBuffer>(*device);
+    render_system = std::make_shared<ObjectRenderSystem>(*device, renderer->get_swapchain_render_pass(), *camera_buffer, &jobs);
+    render_system->get_static_batch().set_promotion_frames(static_promotion_frames);
+    renderer->set_partial_redraw(partial_redraw);
+    render_system->set_front_to_back(front_to_back);
+    if(gpu_culling && !render_system->set_gpu_culling(true)){
+        WARNING("ENGINE", "GPU culling isn't supported, culling on the CPU");
+        gpu_culling = false;
+    }
+    if(dynamic_resolution && !renderer->set_dynamic_resolution(true)){
+        WARNING("ENGINE", "Dynamic resolution isn't supported, drawing at full resolution");
+        dynamic_resolution = false;
+    }
+    immediate_batch = std::make_unique<ImmediateBatch>(*device);
+    particles = std::make_unique<ParticleSystem>(*device, renderer->get_swapchain_render_pass(), camera_buffer->get_set_layout());
+    particles->set_resolution(this->width, this->height);
+    sdf_batch = std::make_unique<SdfBatch>(*device, renderer->get_swapchain_render_pass(), camera_buffer->get_set_layout());
+    sdf_batch->set_resolution(this->width, this->height);
+    circle_meshes = std::make_unique<CircleMeshes>(*device);
+    EngineCircle::meshes = circle_meshes.get();
+    unit_rectangle = std::make_shared<ObjectModel>(*device, std::vector<Vertex>{
+        {{0, 0}},
+        {{0, 1}},
+        {{1, 0}},
+        {{0, 1}},
+        {{1, 0}},
+        {{1, 1}}
+    });
+    running = true;
+    plugins.init();
     this->update();
 }
 
-std::shared_ptr<Object> Engine::create_object(const std::vector<Vertex>& vertices, const glm::vec2& translation, const glm::vec3& color){
+Entity Engine::create_object(const std::vector<Vertex>& vertices, const glm::vec2& translation, const glm::vec3& color){
+    return create_object(std::make_shared<ObjectModel>(*device, vertices), translation, color);
+}
+
+Entity Engine::create_object(std::shared_ptr<ObjectModel> model, const glm::vec2& translation, const glm::vec3& color){
+    return entities.create(std::move(model), translation, color);
+}
+
+Entity Engine::bake(const std::vector<Entity>& parts, NodeId node){
+    /* Everything is merged in the space of node, so the node still moves the result */
+    Affine2D to_node = entities.scene.world_transform(node).inverse();
+
+    std::vector<Entity> ordered = parts;
+    std::stable_sort(ordered.begin(), ordered.end(), [this](Entity a, Entity b){
+        return entities.draws_before(a, b);
+    });
+
+    std::vector<Entity> merged_parts;
+    std::vector<Vertex> vertices;
+    for(Entity part : ordered){
+        if(!entities.alive(part)){
+            continue;
+        }
+        uint32_t i = part.index();
+        if(entities.mesh[i] == nullptr){
+            continue;
+        }
+
+        Affine2D transform = to_node * entities.scene.world_transform(entities.node[i]) * Affine2D{entities.translation[i], entities.scale[i]};
+        for(const auto& v : entities.mesh[i]->get_vertices()){
+            vertices.push_back({transform.apply(v.position), v.color * entities.color[i]});
+        }
+        merged_parts.push_back(part);
+    }
+
+    if(merged_parts.empty()){
+        return Entity{};
+    }
     auto model = std::make_shared<ObjectModel>(*device, vertices);
-    std::shared_ptr<Object> object = std::make_shared<Object>();
-    object->model = model;
-    object->color = color;
-    object->transform.translation = translation;
-    objects.push_back(object);
-    return object;
+    return entities.merge(merged_parts, model, node);
 }
 
-std::shared_ptr<EngineRectangle> Engine::create_rectangle(int x, int y, int width, int height, Color color){
-    float float_width = 2.0 * width / this->width;
-    float float_height = 2.0 * height / this->height;
-    float float_x = x*2.0/this->width;
-    float float_y = 2.0 - ((2.0*y + 2.0*height)/this->height);
-    std::vector<Vertex> vertices = {
-        {{0, 0}},
-        {{0, float_height}},
-        {{float_width, 0}},
-        {{0, float_height}},
-        {{float_width, 0 }},
-        {{float_width, float_height}}
-    };
+void Engine::place_entity(Entity entity, std::shared_ptr<ObjectModel> model, const glm::vec2& translation, const Color& color){
+    uint32_t i = entity.index();
+    entities.mesh[i] = std::move(model);
+    entities.translation[i] = translation;
+    entities.previous_translation[i] = translation;
+    entities.color[i] = color;
+}
+
+std::shared_ptr<EngineRectangle> Engine::make_rectangle(const RectDesc& rect, Entity entity){
+    float float_x = rect.x*2.0/this->width;
+    float float_y = 2.0 - ((2.0*rect.y + 2.0*rect.height)/this->height);
+    float float_width = 2.0 * rect.width / this->width;
+    float float_height = 2.0 * rect.height / this->height;
 
+    /* Shared unit square scaled to the size, nothing is built or uploaded per rectangle */
     auto rectangle = std::make_shared<EngineRectangle>();
-    rectangle->set_object(create_object(vertices, {float_x, float_y}, color));
-    rectangle->x = x;
-    rectangle->y = y;
-    rectangle->width = width;
-    rectangle->height = height;
+    place_entity(entity, unit_rectangle, {float_x, float_y}, rect.color);
+    entities.scale[entity.index()] = glm::vec2(float_width, float_height);
+    rectangle->set_entity(&entities, entity);
+    rectangle->x = rect.x;
+    rectangle->y = rect.y;
+    rectangle->width = rect.width;
+    rectangle->height = rect.height;
     return rectangle;
 }
 
-std::shared_ptr<EngineGameObject> Engine::create_triangle(int v1x, int v1y, int v2x, int v2y, int v3x, int v3y, Color color){
-    
-    int min_x = std::min(v1x,v2x);
-    min_x = std::min(min_x, v3x);
-    int min_y = std::min(v1y,v2y);
-    min_y = std::min(min_y,v3y);
-    int max_x = std::max(v1x,v2x);
-    max_x = std::max(max_x,v3x);
-    int max_y = std::max(v1y,v2y);
-    max_y = std::max(max_y,v3y);
-    float f_v1x = (2.0 * v1x)/this->width;
-    float f_v1y = 2 - (2.0 * v1y)/this->height;
-    float f_v2x = (2.0 * v2x)/this->width;
-    float f_v2y = 2 - (2.0 * v2y)/this->height;
-    float f_v3x = (2.0 * v3x)/this->width;
-    float f_v3y = 2 - (2.0 * v3y)/this->height;
+std::shared_ptr<EngineRectangle> Engine::create_rectangle(int x, int y, int width, int height, Color color){
+    RectDesc rect{x, y, width, height, color};
+    return make_rectangle(rect, entities.create());
+}
+
+std::vector<std::shared_ptr<EngineRectangle>> Engine::create_rectangles(const std::vector<RectDesc>& rects){
+    auto handles = entities.allocate_range(rects.size());
+
+    std::vector<std::shared_ptr<EngineRectangle>> rectangles;
+    rectangles.reserve(rects.size());
+    for(size_t i = 0; i < rects.size(); i++){
+        rectangles.push_back(make_rectangle(rects[i], handles[i]));
+    }
+    return rectangles;
+}
+
+std::vector<Vertex> Engine::triangle_vertices(const TriangleDesc& tri){
+    float f_v1x = (2.0 * tri.v1x)/this->width;
+    float f_v1y = 2 - (2.0 * tri.v1y)/this->height;
+    float f_v2x = (2.0 * tri.v2x)/this->width;
+    float f_v2y = 2 - (2.0 * tri.v2y)/this->height;
+    float f_v3x = (2.0 * tri.v3x)/this->width;
+    float f_v3y = 2 - (2.0 * tri.v3y)/this->height;
     Vertex v1{{f_v1x,f_v1y}};
     Vertex v2{{f_v2x,f_v2y}};
     Vertex v3{{f_v3x,f_v3y}};
-    std::vector<Vertex> vertices = {{v1}, {v2}, {v3}};
+    return {{v1}, {v2}, {v3}};
+}
+
+std::shared_ptr<EngineGameObject> Engine::make_triangle(const TriangleDesc& tri, std::shared_ptr<ObjectModel> model, Entity entity){
+    int min_x = std::min(tri.v1x,tri.v2x);
+    min_x = std::min(min_x, tri.v3x);
+    int min_y = std::min(tri.v1y,tri.v2y);
+    min_y = std::min(min_y,tri.v3y);
+    int max_x = std::max(tri.v1x,tri.v2x);
+    max_x = std::max(max_x,tri.v3x);
+    int max_y = std::max(tri.v1y,tri.v2y);
+    max_y = std::max(max_y,tri.v3y);
+
     auto game_object = std::make_shared<EngineGameObject>();
-    game_object->set_object(create_object(vertices, {0, 0}, color));
+    place_entity(entity, std::move(model), {0, 0}, tri.color);
+    game_object->set_entity(&entities, entity);
     game_object->x = min_x;
     game_object->y = min_y;
     game_object->width = max_x - min_x;
@@ -85,42 +180,63 @@ std::shared_ptr<EngineGameObject> Engine::create_triangle(int v1x, int v1y, int
     return game_object;
 }
 
-std::shared_ptr<EngineCircle> Engine::create_circle(int x, int y, int radius, Color color){
-    float f_radius = 2.0*radius/EngineGameObject::resolution_height;
-    float r_x = (2.0*radius)/EngineGameObject::resolution_width;
-    float r_y = (-2.0*radius)/EngineGameObject::resolution_height;
-    float f_x = (2.0*x)/EngineGameObject::resolution_width;
-    float f_y =  2.0 - (2.0*y + 4.0*radius)/EngineGameObject::resolution_height;
+std::shared_ptr<EngineGameObject> Engine::create_triangle(int v1x, int v1y, int v2x, int v2y, int v3x, int v3y, Color color){
+    TriangleDesc tri{v1x, v1y, v2x, v2y, v3x, v3y, color};
+    return make_triangle(tri, std::make_shared<ObjectModel>(*device, triangle_vertices(tri)), entities.create());
+}
 
-    int sides = std::max(static_cast<int>(f_radius * 100.0f), 8);
-    std::vector<Vertex> side_vertices = {};
-    for(int i = 0; i < sides; i++){
-        float theta = glm::two_pi<float>() * i / sides;
-        float x1 = r_x * glm::cos(theta);
-        float y1 = r_y * glm::sin(theta);
-        side_vertices.push_back({{x1, y1}});
+std::vector<std::shared_ptr<EngineGameObject>> Engine::create_triangles(const std::vector<TriangleDesc>& tris){
+    std::vector<std::vector<Vertex>> meshes;
+    meshes.reserve(tris.size());
+    for(const auto& tri : tris){
+        meshes.push_back(triangle_vertices(tri));
     }
+    auto models = ObjectModel::create_batch(*device, meshes);
+    auto handles = entities.allocate_range(tris.size());
 
-    side_vertices.push_back({{0, 0}});
-
-    std::vector<Vertex> vertices{};
-    for(int i = 0; i < sides; i++){
-        vertices.push_back(side_vertices[i]);
-        vertices.push_back(side_vertices[(i + 1) % sides]);
-        vertices.push_back(side_vertices[sides]);
+    std::vector<std::shared_ptr<EngineGameObject>> triangles;
+    triangles.reserve(tris.size());
+    for(size_t i = 0; i < tris.size(); i++){
+        triangles.push_back(make_triangle(tris[i], models[i], handles[i]));
     }
-    
+    return triangles;
+}
+
+std::shared_ptr<EngineCircle> Engine::make_circle(const CircleDesc& desc, Entity entity){
+    float r_x = (2.0*desc.radius)/EngineGameObject::resolution_width;
+    float r_y = (2.0*desc.radius)/EngineGameObject::resolution_height;
+    float f_x = (2.0*desc.x)/EngineGameObject::resolution_width;
+    float f_y =  2.0 - (2.0*desc.y + 4.0*desc.radius)/EngineGameObject::resolution_height;
+
+    /* Shared unit circle scaled to the radius, nothing is built or uploaded per circle */
     auto circle = std::make_shared<EngineCircle>();
-    circle->set_object(create_object(vertices, {f_x + r_x,f_y - r_y}, color));
-    circle->radius = radius;
-    circle->x = x;
-    circle->y = y;
-    circle->width = 2*radius;
-    circle->height = 2*radius;
+    place_entity(entity, circle_meshes->select(desc.radius), {f_x + r_x, f_y + r_y}, desc.color);
+    entities.scale[entity.index()] = glm::vec2(r_x, r_y);
+    circle->set_entity(&entities, entity);
+    circle->radius = desc.radius;
+    circle->x = desc.x;
+    circle->y = desc.y;
+    circle->width = 2*desc.radius;
+    circle->height = 2*desc.radius;
     
     return circle;
 }
 
+std::shared_ptr<EngineCircle> Engine::create_circle(int x, int y, int radius, Color color){
+    return make_circle(CircleDesc{x, y, radius, color}, entities.create());
+}
+
+std::vector<std::shared_ptr<EngineCircle>> Engine::create_circles(const std::vector<CircleDesc>& circles){
+    auto handles = entities.allocate_range(circles.size());
+
+    std::vector<std::shared_ptr<EngineCircle>> created;
+    created.reserve(circles.size());
+    for(size_t i = 0; i < circles.size(); i++){
+        created.push_back(make_circle(circles[i], handles[i]));
+    }
+    return created;
+}
+
 bool Engine::set_window_size(int width, int height){
     
     if((width < 1)||(width > 2000)){
@@ -149,18 +265,274 @@ void Engine::update(){
 
     if(!(window->should_close())){
         glfwPollEvents();
+        device->poll_uploads();
+        entities.advance_frame();
+        float delta_time = advance_clock();
+        update_plugins(delta_time);
+        update_circle_detail();
+        particles->update(delta_time);
+        if(render_on_demand && !needs_redraw()){
+            skipped_frames++;
+            glfwWaitEventsTimeout(idle_timeout);
+            return;
+        }
+
+        redraw_requested = false;
+        drawn_version = entities.get_version();
+        drawn_swapchain_version = renderer->get_swapchain_version();
+        drawn_alpha = interpolation_alpha;
+        drawn_immediate = !immediate_batch->empty();
+        drawn_particles = particles->has_particles();
+        drawn_sdf = !sdf_batch->empty();
+        drawn_camera_version = camera.get_version();
+        damage_tracker.set_view(camera.get_view());
+        const auto& damage = damage_tracker.collect(entities, interpolation_alpha, renderer->get_swapchain_extent());
+        damage_tracker.add_transient(*immediate_batch, renderer->get_swapchain_extent());
+        damage_tracker.add_transient(*particles, renderer->get_swapchain_extent());
+        damage_tracker.add_transient(*sdf_batch, renderer->get_swapchain_extent());
+        renderer->add_damage(damage);
+        if(dynamic_resolution){
+            if(auto gpu_time = renderer->take_gpu_time()){
+                resolution_scaler.update(*gpu_time);
+            }
+            renderer->set_render_scale(resolution_scaler.get_scale());
+        }
         if(auto command_buffer = renderer->begin_frame()){
-            renderer->begin_swapchain_render_pass(command_buffer);
-            render_system->render_objects(command_buffer, objects);
+            camera_buffer->update(renderer->get_frame_index(), camera);
+            particles->dispatch(command_buffer);
+            render_system->prepare(command_buffer, *renderer, entities, interpolation_alpha);
+            renderer->begin_swapchain_render_pass(command_buffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            render_system->render_objects(command_buffer, *renderer, entities, interpolation_alpha, immediate_batch.get(), particles.get(), sdf_batch.get());
             renderer->end_swapchain_render_pass(command_buffer);
             renderer->end_frame();
+            release_retired_meshes();
+        } else {
+            /* The swapchain was out of date, nothing was drawn */
+            redraw_requested = true;
         }
+        immediate_batch->clear();
+        sdf_batch->clear();
     }
     else{
+        if(this->window_open){
+            plugins.close();
+        }
         this->window_open= false;
     }
-    vkDeviceWaitIdle(device->get_device());
+}
+
+float Engine::advance_clock(){
+    auto now = std::chrono::steady_clock::now();
+    float delta_time = last_update_time ? std::chrono::duration<float>(now - *last_update_time).count() : 0.0f;
+    last_update_time = now;
+    return delta_time;
+}
+
+void Engine::update_plugins(float delta_time){
+    auto now = std::chrono::steady_clock::now();
+    plugins.update(delta_time, jobs);
+    plugin_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - now).count();
+}
+
+void Engine::update_circle_detail(){
+    if(camera.get_zoom() == circle_meshes->get_zoom()){
+        return;
+    }
+    circle_meshes->set_zoom(camera.get_zoom());
 
+    /* Circle scales are their radius in object space, see make_circle */
+    float to_pixels = EngineGameObject::resolution_width / 2.0f;
+
+    /* A copy, changing the mesh of a merged part unmerges it and reorders */
+    std::vector<uint32_t> order = entities.get_draw_order();
+    for(uint32_t i : order){
+        if(circle_meshes->get_level(entities.mesh[i].get()) < 0){
+            continue;
+        }
+        float node_scale = entities.node[i] == NO_NODE ? 1.0f : entities.scene.world_transform(entities.node[i]).scale.x;
+        const std::shared_ptr<ObjectModel>& model = circle_meshes->select(std::abs(entities.scale[i].x) * to_pixels, node_scale);
+        if(model != entities.mesh[i]){
+            entities.set_mesh(entities.get_handle(i), model, entities.scale[i]);
+        }
+    }
+}
+
+bool Engine::needs_redraw(){
+    if(window->take_refresh_request()){
+        redraw_requested = true;
+    }
+    if(redraw_requested || window->was_window_resized() || drawn_immediate || !immediate_batch->empty() || drawn_sdf || !sdf_batch->empty()){
+        return true;
+    }
+    /* Particles move every frame, and once gone the frame after clears them */
+    if(drawn_particles || particles->has_particles()){
+        return true;
+    }
+    if(entities.get_version() != drawn_version || renderer->get_swapchain_version() != drawn_swapchain_version || camera.get_version() != drawn_camera_version){
+        return true;
+    }
+    return entities.is_interpolating() && interpolation_alpha != drawn_alpha;
+}
+
+void Engine::set_render_on_demand(bool enabled, float max_idle_seconds){
+    render_on_demand = enabled;
+    idle_timeout = std::max(max_idle_seconds, 0.0f);
+    redraw_requested = true;
+}
+
+void Engine::release_retired_meshes(){
+    /*
+     * Starting this frame waited on the fence of the frame RETIRE_SLOTS - 1
+     * frames ago, so meshes retired before that frame are no longer in use
+     */
+    retire_slot = (retire_slot + 1) % RETIRE_SLOTS;
+    retired_meshes[retire_slot].clear();
+    retired_meshes[retire_slot] = entities.take_retired();
+}
+
+void Engine::store_previous_transforms(){
+    entities.store_previous_translations();
+}
+
+void Engine::set_static_promotion_frames(int frames){
+    static_promotion_frames = std::max(frames, 0);
+    if(render_system != nullptr){
+        render_system->get_static_batch().set_promotion_frames(static_promotion_frames);
+    }
+}
+
+bool Engine::set_gpu_culling(bool enabled){
+    gpu_culling = enabled;
+    if(render_system != nullptr && !render_system->set_gpu_culling(enabled)){
+        gpu_culling = false;
+        return false;
+    }
+    return true;
+}
+
+bool Engine::set_dynamic_resolution(bool enabled, float gpu_budget){
+    dynamic_resolution = enabled;
+    resolution_scaler.set_budget(gpu_budget);
+    resolution_scaler.reset();
+    if(renderer != nullptr && !renderer->set_dynamic_resolution(enabled)){
+        dynamic_resolution = false;
+        return false;
+    }
+    return true;
+}
+
+float Engine::get_render_scale(){
+    return renderer != nullptr ? renderer->get_render_scale() : 1.0f;
+}
+
+float Engine::get_gpu_time(){
+    return renderer != nullptr ? renderer->get_gpu_time() : 0.0f;
+}
+
+void Engine::set_front_to_back(bool enabled){
+    front_to_back = enabled;
+    if(render_system != nullptr){
+        render_system->set_front_to_back(enabled);
+    }
+}
+
+void Engine::set_partial_redraw(bool enabled){
+    partial_redraw = enabled;
+    if(renderer != nullptr){
+        renderer->set_partial_redraw(enabled);
+    }
+}
+
+void Engine::draw_rect(int x, int y, int width, int height, const Color& color){
+    glm::vec2 min{2.0f * x / this->width, 2.0f - 2.0f * (y + height) / this->height};
+    glm::vec2 max{2.0f * (x + width) / this->width, 2.0f - 2.0f * y / this->height};
+    immediate_batch->add_quad({min, {min.x, max.y}, max, {max.x, min.y}}, color);
+}
+
+void Engine::draw_line(int x1, int y1, int x2, int y2, const Color& color, float thickness){
+    /* Widen the line sideways in pixels so it's equally thick at every angle */
+    glm::vec2 p1{x1, y1};
+    glm::vec2 p2{x2, y2};
+    glm::vec2 direction = p2 - p1;
+    float length = glm::length(direction);
+    direction = length > 0.0f ? direction / length : glm::vec2(1.0f, 0.0f);
+    glm::vec2 side = glm::vec2(-direction.y, direction.x) * (thickness * 0.5f);
+
+    auto to_float = [this](glm::vec2 p){
+        return glm::vec2{2.0f * p.x / this->width, 2.0f - 2.0f * p.y / this->height};
+    };
+    immediate_batch->add_quad({to_float(p1 + side), to_float(p2 + side), to_float(p2 - side), to_float(p1 - side)}, color);
+}
+
+void Engine::draw_circle(int x, int y, float radius, const Color& color){
+    sdf_batch->add_circle(glm::vec2(x, y), radius, color);
+}
+
+void Engine::draw_rounded_rect(int x, int y, int width, int height, float corner_radius, const Color& color){
+    sdf_batch->add_rounded_rect(glm::vec2(x, y), glm::vec2(x + width, y + height), corner_radius, color);
+}
+
+void Engine::draw_ring(int x, int y, float radius, float thickness, const Color& color){
+    sdf_batch->add_ring(glm::vec2(x, y), radius, thickness, color);
+}
+
+void Engine::draw_capsule(int x1, int y1, int x2, int y2, float radius, const Color& color){
+    sdf_batch->add_capsule(glm::vec2(x1, y1), glm::vec2(x2, y2), radius, color);
+}
+
+std::shared_ptr<ParticleEmitter> Engine::create_emitter(int x, int y, const EmitterDesc& desc){
+    return particles->create_emitter(glm::vec2(x, y), desc);
+}
+
+RenderStats Engine::get_render_stats(){
+    if(render_system == nullptr){
+        return {};
+    }
+    return render_system->get_stats();
+}
+
+void Engine::set_interpolation_alpha(float alpha){
+    interpolation_alpha = std::clamp(alpha, 0.0f, 1.0f);
+}
+
+void Engine::set_latency_mode(LatencyMode mode){
+    latency_mode = mode;
+    frames_in_flight = 0;
+    if(renderer != nullptr){
+        renderer->set_latency_mode(mode);
+    }
+}
+
+LatencyMode Engine::get_latency_mode(){
+    return latency_mode;
+}
+
+bool Engine::set_frames_in_flight(int count){
+    if((count < 1)||(count > SwapChain::MAX_FRAMES_IN_FLIGHT)){
+        return false;
+    }
+    frames_in_flight = count;
+    if(renderer != nullptr){
+        renderer->set_frames_in_flight(count);
+    }
+    return true;
+}
+
+int Engine::get_frames_in_flight(){
+    if(renderer != nullptr){
+        return renderer->get_frames_in_flight();
+    }
+    if(frames_in_flight > 0){
+        return frames_in_flight;
+    }
+    return latency_mode == LatencyMode::LOW_LATENCY ? 1 : SwapChain::MAX_FRAMES_IN_FLIGHT;
+}
+
+std::chrono::steady_clock::time_point Engine::get_last_present_time(){
+    if(renderer == nullptr){
+        return {};
+    }
+    return renderer->get_last_present_time();
 }
 
 float EngineGameObject::coord_to_float_x(int i_x){
@@ -171,14 +543,49 @@ float EngineGameObject::coord_to_float_y(int i_y){
     return (-2.0 *i_y)/this->resolution_height;
 }
 
-void EngineGameObject::set_object(std::shared_ptr<Object>&& obj){
-    object.reset();
-    object = obj;
+void EngineGameObject::set_entity(EntityStore* entity_store, Entity new_entity){
+    store = entity_store;
+    entity = new_entity;
 }
 
 void EngineGameObject::set_color(const Color& new_color){
     color = new_color;
-    object->color = new_color;
+    if(store != nullptr){
+        store->set_color(entity, new_color);
+    }
+}
+
+bool EngineCircle::set_radius(int new_radius){
+    if(new_radius < 1 || !is_alive()){
+        return false;
+    }
+    /* Scale is relative to the entity's node, so grow it by the same factor */
+    uint32_t i = entity.index();
+    glm::vec2 new_scale = store->scale[i] * (static_cast<float>(new_radius) / radius);
+    float node_scale = store->node[i] == NO_NODE ? 1.0f : store->scene.world_transform(store->node[i]).scale.x;
+    store->set_mesh(entity, meshes->select(new_radius, node_scale), new_scale);
+    x += radius - new_radius;
+    y += radius - new_radius;
+    width = 2*new_radius;
+    height = 2*new_radius;
+    radius = new_radius;
+    return true;
+}
+
+void EngineGameObject::set_layer(int layer){
+    if(is_alive()){
+        store->set_layer(entity, layer);
+    }
+}
+
+int EngineGameObject::get_layer(){
+    return is_alive() ? store->layer[entity.index()] : 0;
+}
+
+void EngineGameObject::destroy(){
+    if(store != nullptr){
+        store->destroy(entity);
+    }
 }
 
 void EngineGameObject::set_resolution(int res_width, int res_height ){
@@ -186,4 +593,3 @@ void EngineGameObject::set_resolution(int res_width, int res_height ){
     resolution_height = res_height;
 }
 }
-
@@ -13,14 +13,26 @@
 #include "Window/window.hpp"
 #include "Device/device.hpp"
 #include "Renderer/renderer.hpp"
+#include "Renderer/camera.hpp"
+#include "Renderer/resolution_scaler.hpp"
 #include "Objects/object.hpp"
+#include "Objects/circle_meshes.hpp"
+#include "Entity/entity_store.hpp"
 #include "Render_Systems/object_render_system.hpp"
+#include "Render_Systems/damage_tracker.hpp"
+#include "Jobs/job_system.hpp"
+#include "Physics/physics_world.hpp"
+#include "engine_plugin.hpp"
+#include "plugin_scheduler.hpp"
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <chrono>
 #include <memory>
 #include <optional>
+#include <string>
+#include <typeinfo>
 namespace hop {
 
 
@@ -30,10 +42,13 @@ using Color = glm::vec3;
 class Engine;
 
 /**
- * @brief Wrapper class for Object class
+ * @brief Wrapper class for an entity
  *
- * Wrapper for Object class for better ease of use
+ * Wrapper for an entity in the engine's EntityStore for better ease of use.
+ * Only the pixel position and size live here, everything that is drawn lives
+ * in the store's columns.
  *
+ * NOTE: Letting go of the wrapper does not remove the entity, call destroy()
  */
 class EngineGameObject {
 public:
@@ -47,22 +62,53 @@ public:
     void move(int x_offset, int y_offset){
                 x = x + x_offset;
                 y = y + y_offset; 
+                if(store == nullptr){
+                    return;
+                }
                 float f_move_x = coord_to_float_x(x_offset);
                 float f_move_y = coord_to_float_y(y_offset);
-                object->transform.translation.x += f_move_x;
-                object->transform.translation.y += f_move_y;
+                store->move(entity, glm::vec2(f_move_x, f_move_y));
         
     }
 
-    void set_object(std::shared_ptr<Object>&& obj);
+    void set_entity(EntityStore* entity_store, Entity new_entity);
+    Entity get_entity() const { return entity; }
     void set_color(const Color& new_color);
+
+    /**
+     * @brief Changes the layer the object is drawn on
+     *
+     * Objects on higher layers are drawn on top of objects on lower layers.
+     * Within a layer, objects created first are on top. Every object starts
+     * on layer 0.
+     *
+     * @param layer The new layer
+     * @return void
+     */
+    void set_layer(int layer);
+    int get_layer();
+
+    /**
+     * @brief Removes the object from the engine
+     *
+     * The object stops being drawn and its slot in the entity store is freed.
+     * Calling anything on the object afterwards does nothing.
+     *
+     * @return void
+     */
+    void destroy();
+    bool is_alive() const { return store != nullptr && store->alive(entity); }
+
     static void set_resolution(int res_width, int res_height);
     float coord_to_float_x(int i_x);
     float coord_to_float_y(int i_y);
 
+protected:
+    EntityStore* store = nullptr;
+    Entity entity;
+
 private:
     Color color;
-    std::shared_ptr<Object> object;
 
 };
 
@@ -85,61 +131,62 @@ class EngineRectangle : public EngineGameObject {};
 class EngineCircle : public EngineGameObject {
 public:
     int radius = 0;
-};
 
-/** 
- * @brief Plugin for Engine
- *
- * To create a plugin, any derived class must:
- *  1. Inherit from hop::EnginePlugin
- *  2. Have default consturtor defined as:
- *       ```cpp
- *           Plugin(hop::Engine& engine) : EnginePlugin(engine) { }
- *       ```
- *  3. Define the following functions:
- *       void init();
- *       void update(float);
- *       void close();
- *
- * NOTE: Every plugin has a reference to the engine, this is so plugins can
- *       create their own objects and call other engine functions
- */
-class EnginePlugin {
-public:
-    EnginePlugin(Engine& _engine) : engine{_engine} {}
+    /* Meshes every circle is drawn with, set by Engine::run */
+    inline static const CircleMeshes* meshes = nullptr;
 
     /**
-     * @brief starts plugin
+     * @brief Changes the radius of the circle, keeping its center in place
      *
-     * This function is called when right before the main game loop starts.
-     * aka before engine.run() is called.
-     *
-     * @return void
-     */
-    virtual void init() = 0;
-
-    /**
-     * @brief updates plugin
+     * The circle switches to the level of detail that fits its new size, see
+     * CircleMeshes. No mesh is created.
      *
-     * This function is called within the main game engine loop. Every draw
-     * call this function is called, along with the functions of all other
-     * plugins added to the engine.
+     * NOTE: A physics body added for the circle keeps its old radius
      *
-     * @param delta_time The amount of time passed since last frame drawn
-     * @return void
+     * @param new_radius The new radius in pixels
+     * @return false if new_radius is less than 1 or the circle was destroyed
      */
-    virtual void update(float delta_time) = 0;
+    bool set_radius(int new_radius);
+};
 
-    /** 
-     * @brief closes plugin
-     *
-     * This function is called right after the game loop ends.
-     *
-     * @return void
-     */
-    virtual void close() = 0;
+/**
+ * @brief Description of a rectangle for bulk creation
+ *
+ * Same parameters as Engine::create_rectangle
+ */
+struct RectDesc {
+    int x;
+    int y;
+    int width;
+    int height;
+    Color color;
+};
+
+/**
+ * @brief Description of a circle for bulk creation
+ *
+ * Same parameters as Engine::create_circle
+ */
+struct CircleDesc {
+    int x;
+    int y;
+    int radius;
+    Color color;
+};
 
-    Engine& engine;
+/**
+ * @brief Description of a triangle for bulk creation
+ *
+ * Same parameters as Engine::create_triangle
+ */
+struct TriangleDesc {
+    int v1x;
+    int v1y;
+    int v2x;
+    int v2y;
+    int v3x;
+    int v3y;
+    Color color;
 };
 
 /**
@@ -156,6 +203,7 @@ private:
 bool cooldown = false;
 
 public:
+    static constexpr float DEFAULT_IDLE_TIMEOUT = 0.25f;
 
     /**
      * @brief Default Constructor
@@ -191,6 +239,297 @@ public:
     
     void update();
 
+    /**
+     * @brief Saves the current state of every object as the previous state
+     *
+     * Called before each fixed simulation step so rendering can interpolate
+     * between the state before and after the step.
+     *
+     * @return void
+     */
+    void store_previous_transforms();
+
+    /**
+     * @brief Sets how far between the last two simulation states to render
+     *
+     * @param alpha 0 renders the previous state, 1 renders the current state
+     * @return void
+     */
+    void set_interpolation_alpha(float alpha);
+
+    /**
+     * @brief Sets the latency mode of the swapchain
+     *
+     * Can be called before or after run(). If the engine is already running
+     * the swapchain is recreated right away.
+     *
+     * @param mode The new latency mode
+     * @return void
+     */
+    void set_latency_mode(LatencyMode mode);
+    LatencyMode get_latency_mode();
+
+    /**
+     * @brief Overrides how many frames can be in flight
+     *
+     * By default this follows the latency mode.
+     *
+     * @param count Frames in flight, 1 to SwapChain::MAX_FRAMES_IN_FLIGHT
+     * @return true if the count was valid, false otherwise
+     */
+    bool set_frames_in_flight(int count);
+    int get_frames_in_flight();
+
+    /**
+     * @brief Gets when the last frame was handed to the presentation engine
+     * @return Time point of the last present
+     */
+    std::chrono::steady_clock::time_point get_last_present_time();
+
+    /**
+     * @brief Sets how many frames an object has to stay unchanged to be
+     *        drawn from the merged static buffers
+     *
+     * See StaticBatch. Can be called before or after run().
+     *
+     * @param frames Frame count, 0 turns static batching off
+     * @return void
+     */
+    void set_static_promotion_frames(int frames);
+
+    /**
+     * @brief Counters of the last rendered frame
+     * @return Draw calls and static and dynamic object counts
+     */
+    RenderStats get_render_stats();
+
+    /**
+     * @brief Only draws a frame when something on screen could have changed
+     *
+     * While nothing changed, update() does not acquire, record or present a
+     * frame. It blocks waiting for window events instead, for at most
+     * max_idle_seconds, so an idle game uses next to no CPU or GPU time.
+     *
+     * A frame is drawn when an entity or scene node changed, the window was
+     * resized or uncovered, the interpolation alpha changed while something
+     * is moving, or request_redraw() was called.
+     *
+     * @param enabled true to turn render on demand on
+     * @param max_idle_seconds Longest update() blocks waiting for events
+     * @return void
+     */
+    void set_render_on_demand(bool enabled, float max_idle_seconds = DEFAULT_IDLE_TIMEOUT);
+    bool get_render_on_demand(){ return render_on_demand; }
+
+    /**
+     * @brief Makes the next update() draw a frame even if nothing changed
+     * @return void
+     */
+    void request_redraw(){ redraw_requested = true; }
+
+    /**
+     * @brief Turns drawing only the parts of the screen that changed on or off
+     *
+     * Objects that move, change or are created or destroyed mark where they
+     * were and are as damaged, see DamageTracker. Only the damaged area is
+     * cleared and drawn, the rest of the image is kept from the last time it
+     * was shown. On by default.
+     *
+     * @param enabled true to only draw what changed
+     * @return void
+     */
+    void set_partial_redraw(bool enabled);
+
+    /**
+     * @brief Culls objects and generates their draws on the GPU
+     *
+     * Instead of recording a draw per object, a compute shader tests every
+     * object against the screen and writes the draws of the visible ones,
+     * which are drawn with one call per vertex buffer. Recording then costs
+     * the same no matter how many objects there are, but nothing is reused
+     * between frames. See GpuCulling. When off, objects outside the screen
+     * are culled on the CPU while recording.
+     *
+     * NOTE: Needs VK_KHR_draw_indirect_count, when missing objects keep
+     *       being culled on the CPU
+     *
+     * @param enabled true to cull on the GPU
+     * @return false if it's not supported, known once run() was called
+     */
+    bool set_gpu_culling(bool enabled);
+
+    /**
+     * @brief Draws layers from the top one down
+     *
+     * Off draws them from the bottom one up, same picture but every covered
+     * fragment is shaded. For measuring, see ObjectRenderSystem::set_front_to_back
+     *
+     * @param enabled true to draw the top layer first
+     * @return void
+     */
+    void set_front_to_back(bool enabled);
+
+    /**
+     * @brief Lowers the resolution frames are drawn at when the GPU is too slow
+     *
+     * Frames are drawn into an offscreen image and stretched over the window.
+     * Every frame is timed on the GPU and ResolutionScaler picks the scale
+     * from those times, between ResolutionScaler::MIN_SCALE and full
+     * resolution. Every frame is drawn whole while it's on, see
+     * Renderer::set_dynamic_resolution. Can be called before or after run().
+     *
+     * NOTE: Needs timestamp queries and a swapchain that can be blitted to
+     *
+     * @param enabled true to scale the resolution
+     * @param gpu_budget Seconds the GPU may spend on a frame
+     * @return false if it's not supported, known once run() was called
+     */
+    bool set_dynamic_resolution(bool enabled, float gpu_budget = 1.0f / 60.0f);
+
+    /* Scale the last frame was drawn at, 1 without dynamic resolution */
+    float get_render_scale();
+
+    /* Seconds the GPU spent on the newest finished frame, 0 if frames can't be timed */
+    float get_gpu_time();
+
+    /**
+     * @brief Draws a rectangle for the next frame only
+     *
+     * Nothing is kept after the frame is drawn, so call this every frame the
+     * rectangle should be seen. All shapes of a frame are drawn with one draw
+     * call, on top of every object, later shapes on top of earlier ones. See
+     * ImmediateBatch.
+     *
+     * NOTE: Must be called after run()
+     *
+     * @param x Left edge in pixels
+     * @param y Bottom edge in pixels
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param color Color of the rectangle
+     * @return void
+     */
+    void draw_rect(int x, int y, int width, int height, const Color& color);
+
+    /**
+     * @brief Draws a line for the next frame only
+     *
+     * See draw_rect
+     *
+     * @param x1 x of the first end in pixels
+     * @param y1 y of the first end in pixels
+     * @param x2 x of the second end in pixels
+     * @param y2 y of the second end in pixels
+     * @param color Color of the line
+     * @param thickness Width of the line in pixels
+     * @return void
+     */
+    void draw_line(int x1, int y1, int x2, int y2, const Color& color, float thickness = 1.0f);
+
+    /**
+     * @brief Draws a circle for the next frame only
+     *
+     * Unlike draw_rect the shape is a single quad whose edge is worked out per
+     * pixel from its signed distance field, so it's exactly round and
+     * anti-aliased at any size, see SdfBatch. Every SDF shape of a frame is
+     * one instanced draw, drawn over every object with later calls on top.
+     *
+     * NOTE: Must be called after run()
+     * NOTE: SDF shapes only exist for the frame they're drawn in, they aren't
+     *       entities and can't be layered, parented, baked or given a body.
+     *       Use create_circle for a circle that stays
+     *
+     * @param x x of the center in pixels
+     * @param y y of the center in pixels
+     * @param radius Radius in pixels
+     * @param color Color of the circle
+     * @return void
+     */
+    void draw_circle(int x, int y, float radius, const Color& color);
+
+    /**
+     * @brief Draws a rectangle with rounded corners for the next frame only
+     *
+     * See draw_circle
+     *
+     * @param x x of the bottom left corner in pixels
+     * @param y y of the bottom left corner in pixels
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param corner_radius Radius of the corners in pixels
+     * @param color Color of the rectangle
+     * @return void
+     */
+    void draw_rounded_rect(int x, int y, int width, int height, float corner_radius, const Color& color);
+
+    /**
+     * @brief Draws a ring for the next frame only
+     *
+     * See draw_circle
+     *
+     * @param x x of the center in pixels
+     * @param y y of the center in pixels
+     * @param radius Distance from the center to the middle of the ring in pixels
+     * @param thickness Width of the ring in pixels
+     * @param color Color of the ring
+     * @return void
+     */
+    void draw_ring(int x, int y, float radius, float thickness, const Color& color);
+
+    /**
+     * @brief Draws a line with round ends for the next frame only
+     *
+     * See draw_circle
+     *
+     * @param x1 x of the first end in pixels
+     * @param y1 y of the first end in pixels
+     * @param x2 x of the second end in pixels
+     * @param y2 y of the second end in pixels
+     * @param radius Half the width of the capsule in pixels
+     * @param color Color of the capsule
+     * @return void
+     */
+    void draw_capsule(int x1, int y1, int x2, int y2, float radius, const Color& color);
+
+    /**
+     * @brief Creates a particle emitter
+     *
+     * The emitter spawns particles every frame until it's destroyed, see
+     * ParticleEmitter::destroy. Particles are moved with the frame time and
+     * drawn on top of everything, see ParticleSystem.
+     *
+     * NOTE: Must be called after run()
+     *
+     * @param x x of the emitter in pixels
+     * @param y y of the emitter in pixels
+     * @param desc How particles spawn and look
+     * @return The emitter
+     */
+    std::shared_ptr<ParticleEmitter> create_emitter(int x, int y, const EmitterDesc& desc);
+
+    /**
+     * @brief Camera the world is drawn with
+     *
+     * Moving, zooming or turning the camera changes what part of the world is
+     * shown without touching any object. Objects, immediate shapes and
+     * particles are all positioned in the world. See Camera.
+     *
+     * @return The camera
+     */
+    Camera& get_camera(){ return camera; }
+
+    /**
+     * @brief Gets the particle system, nullptr before run()
+     * @return The particle system
+     */
+    ParticleSystem* get_particles(){ return particles.get(); }
+
+    /**
+     * @brief Amount of update() calls that skipped drawing, see set_render_on_demand
+     * @return The count
+     */
+    uint64_t get_skipped_frames(){ return skipped_frames; }
+
     /**
      * @brief creates an object
      *
@@ -202,32 +541,100 @@ public:
      * @param vertices Array of vertices the object is made up of
      * @param translation Where to object will be moved to
      * @param color Color of the object
-     * @return pointer to the created object
+     * @return handle to the created entity
+     */
+    Entity create_object(const std::vector<ObjectModel::Vertex>& vertices, const glm::vec2& translation, const glm::vec3& color);
+
+    /**
+     * @brief creates an object from an existing model
+     *
+     * Models can be shared between objects, see ObjectModel::create_batch
+     *
+     * @param model The model of the object
+     * @param translation Where to object will be moved to
+     * @param color Color of the object
+     * @return handle to the created entity
+     */
+    Entity create_object(std::shared_ptr<ObjectModel> model, const glm::vec2& translation, const glm::vec3& color);
+
+    /**
+     * @brief Merges entities into one mesh drawn with a single draw call
+     *
+     * The vertices of every part are transformed into the space of node and
+     * given the part's color, then uploaded as one model. The parts stay in
+     * the store but aren't drawn until the merged entity is removed, see
+     * EntityStore::merge. Parts are merged in draw order so overlapping parts
+     * look the same as before.
+     *
+     * @param parts Entities to merge
+     * @param node Node the merged entity is attached to
+     * @return The merged entity, invalid if there was nothing to merge
+     */
+    Entity bake(const std::vector<Entity>& parts, NodeId node);
+
+    /**
+     * @brief Gets the store holding every entity
+     * @return The entity store
+     */
+    EntityStore& get_entities(){ return entities; }
+
+    /**
+     * @brief Gets the job system the engine and game run work on
+     * @return The job system
+     */
+    JobSystem& get_jobs(){ return jobs; }
+
+    /**
+     * @brief Gets the physics world bodies are simulated in
+     *
+     * NOTE: The engine doesn't step the world, Game does
+     *
+     * @return The physics world
      */
-    std::shared_ptr<Object> create_object(const std::vector<ObjectModel::Vertex>& vertices, const glm::vec2& translation, const glm::vec3& color);
+    PhysicsWorld& get_physics(){ return physics; }
     
     /**
      * @brief Function to register a plugin
      *
      * This function registers a plugin by taking the type of the implemented
-     * plugin and creating an instance of it. All instances of plugins are added
-     * to an array of plugins
+     * plugin and creating an instance of it. Plugins are started by run(),
+     * updated every update() and closed when the window closes. A plugin
+     * registered after run() is started right away, unless it's registered
+     * by a plugin's update: then it's only queued and started once every
+     * plugin is done updating, see PluginScheduler::add.
      *
      * @tparam P Class which derived from EnginePlugin
      * @return void
      */
     template<typename P>
     void plugin(){
-        std::shared_ptr<P> plug = std::make_shared<P>(*this);
-        plugins.push_back(std::move(plug));
+        plugins.add(std::make_shared<P>(*this), typeid(P).name());
+        if(running && !plugins.is_updating()){
+            plugins.init();
+        }
     }
 
+    /**
+     * @brief Gets how long each plugin's last update took
+     * @return Update times, in the order the plugins were registered
+     */
+    const std::vector<PluginTime>& get_plugin_times() const { return plugins.get_times(); }
+
+    /**
+     * @brief Gets how long updating all plugins took last frame
+     * @return Wall time in seconds
+     */
+    float get_plugin_time() const { return plugin_time; }
+
     /**
      * @brief creates a rectangle
      *
      * Creates a square object the engine will render. The (x, y) coord refers 
      * to the top left corner of the shape.
      *
+     * Every rectangle is drawn with one shared unit square scaled to its
+     * size, so nothing is built or uploaded per rectangle.
+     *
      * @param x x position of square on the screen
      * @param y y position of square on the screen
      * @param width The width of the square
@@ -257,6 +664,9 @@ std::shared_ptr<EngineRectangle> create_rectangle(int x, int y, int width, int h
      * Creates a circle object the engine will render. The (x, y) coord refers
      * to the center of the circle
      *
+     * The circle is drawn with one of the shared unit circles, see
+     * CircleMeshes, so the only allocation is the returned wrapper.
+     *
      * @param x x position of circle on the screen
      * @param y y position of circle on the screen
      * @param radius The radius of the circle
@@ -264,22 +674,112 @@ std::shared_ptr<EngineRectangle> create_rectangle(int x, int y, int width, int h
      * @return pointer to created circle object
      */
     std::shared_ptr<EngineCircle> create_circle(int x, int y, int radius, Color color);
+
+    /**
+     * @brief creates many rectangles at once
+     *
+     * Works like calling create_rectangle for every description, except the
+     * entities are allocated next to each other in one go. Use this when
+     * building levels or other large scenes.
+     *
+     * @param rects Description of each rectangle
+     * @return pointers to the created rectangles, in the same order as rects
+     */
+    std::vector<std::shared_ptr<EngineRectangle>> create_rectangles(const std::vector<RectDesc>& rects);
+
+    /**
+     * @brief creates many circles at once
+     *
+     * See create_rectangles
+     *
+     * @param circles Description of each circle
+     * @return pointers to the created circles, in the same order as circles
+     */
+    std::vector<std::shared_ptr<EngineCircle>> create_circles(const std::vector<CircleDesc>& circles);
+
+    /**
+     * @brief creates many triangles at once
+     *
+     * Works like calling create_triangle for every description, except all
+     * the geometry goes into one vertex buffer that is uploaded in a single
+     * submission.
+     *
+     * @param triangles Description of each triangle
+     * @return pointers to the created triangles, in the same order as triangles
+     */
+    std::vector<std::shared_ptr<EngineGameObject>> create_triangles(const std::vector<TriangleDesc>& triangles);
+
     bool window_open = true;
     std::shared_ptr<Window> window;
 
 private:
+    std::vector<Vertex> triangle_vertices(const TriangleDesc& triangle);
+    std::shared_ptr<EngineRectangle> make_rectangle(const RectDesc& rect, Entity entity);
+    std::shared_ptr<EngineCircle> make_circle(const CircleDesc& circle, Entity entity);
+    std::shared_ptr<EngineGameObject> make_triangle(const TriangleDesc& triangle, std::shared_ptr<ObjectModel> model, Entity entity);
+    void place_entity(Entity entity, std::shared_ptr<ObjectModel> model, const glm::vec2& translation, const Color& color);
+    void release_retired_meshes();
+    bool needs_redraw();
+    float advance_clock();
+    void update_plugins(float delta_time);
+    void update_circle_detail();
+
     std::shared_ptr<Device> device;
     std::shared_ptr<Renderer> renderer;
+    /* Before everything drawing with it, so it's destroyed after them */
+    std::unique_ptr<CameraBuffer> camera_buffer;
     std::shared_ptr<ObjectRenderSystem> render_system;
+    std::unique_ptr<ImmediateBatch> immediate_batch;
+    std::unique_ptr<ParticleSystem> particles;
+    std::unique_ptr<SdfBatch> sdf_batch;
+    Camera camera;
+    std::unique_ptr<CircleMeshes> circle_meshes;
+    /* Square from (0, 0) to (1, 1) every rectangle is scaled from */
+    std::shared_ptr<ObjectModel> unit_rectangle;
     /*Window* window;
     Device* device;
     Renderer* renderer;*/
     const char* window_title;
     int width = 800;
     int height = 600;
-    std::vector<std::shared_ptr<Object>> objects;
-    std::vector<std::shared_ptr<EnginePlugin>> plugins;
+    float interpolation_alpha = 1.0f;
+    LatencyMode latency_mode = LatencyMode::THROUGHPUT;
+    int frames_in_flight = 0;
+    int static_promotion_frames = StaticBatch::DEFAULT_PROMOTION_FRAMES;
+    bool partial_redraw = true;
+    bool gpu_culling = false;
+    bool front_to_back = true;
+    bool dynamic_resolution = false;
+    ResolutionScaler resolution_scaler;
+    EntityStore entities;
+    DamageTracker damage_tracker;
+    PhysicsWorld physics{&jobs};
+
+    /* What the last drawn frame showed, see set_render_on_demand */
+    bool render_on_demand = false;
+    float idle_timeout = DEFAULT_IDLE_TIMEOUT;
+    bool redraw_requested = true;
+    uint64_t drawn_version = 0;
+    uint64_t drawn_swapchain_version = 0;
+    float drawn_alpha = 1.0f;
+    bool drawn_immediate = false;
+    bool drawn_particles = false;
+    bool drawn_sdf = false;
+    uint64_t drawn_camera_version = 0;
+    uint64_t skipped_frames = 0;
+
+    /* Meshes of destroyed entities, kept until no frame in flight can use them */
+    static constexpr size_t RETIRE_SLOTS = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+    std::vector<std::shared_ptr<ObjectModel>> retired_meshes[RETIRE_SLOTS];
+    size_t retire_slot = 0;
+
+    PluginScheduler plugins;
+    bool running = false;
+    float plugin_time = 0.0f;
+    std::optional<std::chrono::steady_clock::time_point> last_update_time;
 
+    /* Declared last so running jobs finish before anything they use is destroyed */
+    JobSystem jobs;
 };
 
 
@@ -0,0 +1,103 @@
+/**
+ * @file engine_plugin.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Base class of the plugins added to the engine
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace hop {
+
+class Engine;
+
+/** 
+ * @brief Plugin for Engine
+ *
+ * To create a plugin, any derived class must:
+ *  1. Inherit from hop::EnginePlugin
+ *  2. Have default consturtor defined as:
+ *       ```cpp
+ *           Plugin(hop::Engine& engine) : EnginePlugin(engine) { }
+ *       ```
+ *  3. Define the following functions:
+ *       void init();
+ *       void update(float);
+ *       void close();
+ *
+ * A plugin can also override reads() and writes() to say which data its
+ * update uses. Plugins that don't touch each others data update at the same
+ * time on worker threads, see PluginScheduler.
+ *
+ * NOTE: Every plugin has a reference to the engine, this is so plugins can
+ *       create their own objects and call other engine functions
+ */
+class EnginePlugin {
+public:
+    /* Resource standing for the engine itself, plugins using it update on the main thread */
+    static constexpr const char* ENGINE = "engine";
+
+    EnginePlugin(Engine& _engine) : engine{_engine} {}
+    virtual ~EnginePlugin() = default;
+
+    /**
+     * @brief starts plugin
+     *
+     * This function is called when right before the main game loop starts.
+     * aka when engine.run() is called. Plugins added after that are started
+     * right away.
+     *
+     * @return void
+     */
+    virtual void init() = 0;
+
+    /**
+     * @brief updates plugin
+     *
+     * This function is called within the main game engine loop. Every frame
+     * this function is called, along with the functions of all other
+     * plugins added to the engine.
+     *
+     * @param delta_time Seconds passed since the last update
+     * @return void
+     */
+    virtual void update(float delta_time) = 0;
+
+    /** 
+     * @brief closes plugin
+     *
+     * This function is called right after the game loop ends.
+     *
+     * @return void
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Names of the resources update reads
+     *
+     * Resources are just names the plugins agree on, like "physics" or
+     * "score". Use ENGINE for anything owned by the engine.
+     *
+     * @return Resources read, nothing by default
+     */
+    virtual std::vector<std::string> reads() const { return {}; }
+
+    /**
+     * @brief Names of the resources update writes
+     *
+     * NOTE: Defaults to ENGINE, so plugins that don't say otherwise update on
+     *       the main thread one after another
+     *
+     * @return Resources written
+     */
+    virtual std::vector<std::string> writes() const { return {ENGINE}; }
+
+    Engine& engine;
+};
+
+}
@@ -0,0 +1,155 @@
+#include "plugin_scheduler.hpp"
+#include "engine_plugin.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace hop {
+
+static std::string demangle(const char* type_name){
+#if defined(__GNUG__)
+    int status = 0;
+    char* readable = abi::__cxa_demangle(type_name, nullptr, nullptr, &status);
+    if(status == 0 && readable != nullptr){
+        std::string name = readable;
+        std::free(readable);
+        return name;
+    }
+#endif
+    return type_name;
+}
+
+void PluginScheduler::add(std::shared_ptr<EnginePlugin> plugin, const char* type_name){
+    Entry entry;
+    entry.reads = plugin->reads();
+    entry.writes = plugin->writes();
+    auto uses_engine = [](const std::vector<std::string>& resources){
+        return std::find(resources.begin(), resources.end(), EnginePlugin::ENGINE) != resources.end();
+    };
+    entry.main_thread = uses_engine(entry.reads) || uses_engine(entry.writes);
+    entry.plugin = std::move(plugin);
+    entry.name = demangle(type_name);
+
+    /* Workers are still reading entries during an update, so adding waits until it's over */
+    if(updating){
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending.push_back(std::move(entry));
+        return;
+    }
+    times.push_back({entry.name, 0.0f});
+    entries.push_back(std::move(entry));
+    stages_dirty = true;
+}
+
+void PluginScheduler::init(){
+    add_pending();
+    for(size_t i = 0; i < entries.size(); i++){
+        if(!entries[i].started){
+            entries[i].started = true;
+            started_order.push_back(i);
+            entries[i].plugin->init();
+        }
+    }
+}
+
+void PluginScheduler::update(float delta_time, JobSystem& jobs){
+    if(stages_dirty){
+        build_stages();
+    }
+
+    updating = true;
+    std::vector<JobHandle> running;
+    for(const auto& stage : stages){
+        running.clear();
+        for(size_t i : stage){
+            if(entries[i].started && !entries[i].main_thread){
+                running.push_back(jobs.submit([this, i, delta_time](){ run(i, delta_time); }));
+            }
+        }
+
+        /* The main thread takes its own plugins while the workers run the rest */
+        for(size_t i : stage){
+            if(entries[i].started && entries[i].main_thread){
+                run(i, delta_time);
+            }
+        }
+        for(const JobHandle& job : running){
+            jobs.wait(job);
+        }
+    }
+    updating = false;
+
+    /* Every stage has joined, plugins added by the updates can start on the main thread */
+    if(!pending.empty()){
+        init();
+    }
+}
+
+void PluginScheduler::add_pending(){
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    for(Entry& entry : pending){
+        times.push_back({entry.name, 0.0f});
+        entries.push_back(std::move(entry));
+        stages_dirty = true;
+    }
+    pending.clear();
+}
+
+void PluginScheduler::run(size_t index, float delta_time){
+    /* Each plugin only writes its own slot of times */
+    auto start = std::chrono::steady_clock::now();
+    entries[index].plugin->update(delta_time);
+    times[index].update_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PluginScheduler::close(){
+    for(auto it = started_order.rbegin(); it != started_order.rend(); it++){
+        entries[*it].started = false;
+        entries[*it].plugin->close();
+    }
+    started_order.clear();
+}
+
+size_t PluginScheduler::get_stage_count(){
+    if(stages_dirty){
+        build_stages();
+    }
+    return stages.size();
+}
+
+bool PluginScheduler::conflicts(const Entry& a, const Entry& b){
+    auto overlaps = [](const std::vector<std::string>& x, const std::vector<std::string>& y){
+        for(const std::string& resource : x){
+            if(std::find(y.begin(), y.end(), resource) != y.end()){
+                return true;
+            }
+        }
+        return false;
+    };
+    return overlaps(a.writes, b.writes) || overlaps(a.writes, b.reads) || overlaps(a.reads, b.writes);
+}
+
+void PluginScheduler::build_stages(){
+    stages.clear();
+    for(size_t i = 0; i < entries.size(); i++){
+        size_t stage = 0;
+        for(size_t j = 0; j < i; j++){
+            if(conflicts(entries[i], entries[j])){
+                stage = std::max(stage, entries[j].stage + 1);
+            }
+        }
+        entries[i].stage = stage;
+        if(stage >= stages.size()){
+            stages.resize(stage + 1);
+        }
+        stages[stage].push_back(i);
+    }
+    stages_dirty = false;
+}
+
+}
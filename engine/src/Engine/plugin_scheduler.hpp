@@ -0,0 +1,140 @@
+/**
+ * @file plugin_scheduler.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Runs the init, update and close functions of engine plugins, updating
+ * plugins that don't share any data at the same time
+ *
+ */
+
+#pragma once
+
+#include "Jobs/job_system.hpp"
+#include "Timing/frame_stats.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hop {
+
+class EnginePlugin;
+
+/**
+ * @brief Orders plugin updates by the resources they read and write
+ *
+ * Every plugin names the resources it reads and writes, see
+ * EnginePlugin::reads and EnginePlugin::writes. Two plugins conflict when one
+ * writes a resource the other reads or writes. Plugins are put into stages in
+ * the order they were added: each plugin goes in the stage right after the
+ * last plugin it conflicts with. The plugins of a stage update at the same
+ * time on the job system, and a stage only starts once the one before it is
+ * done. So plugins that conflict always update in the order they were added.
+ *
+ * Plugins that read or write EnginePlugin::ENGINE update on the main thread,
+ * since the engine and Vulkan can only be used from there.
+ */
+class PluginScheduler {
+public:
+    /**
+     * @brief Adds a plugin
+     *
+     * NOTE: reads and writes are asked for once, here
+     * NOTE: Plugins added by a plugin's update, from any thread, are only
+     *       queued, update adds and starts them once every stage is done
+     *
+     * @param plugin Plugin to add
+     * @param type_name typeid name of the plugin's class, demangled where the
+     *                  compiler supports it and reported with its update time
+     * @return void
+     */
+    void add(std::shared_ptr<EnginePlugin> plugin, const char* type_name);
+
+    /**
+     * @brief Calls init on every plugin that hasn't been started yet
+     *
+     * Plugins are started in the order they were added.
+     *
+     * NOTE: Must be called from the main thread, outside of update
+     *
+     * @return void
+     */
+    void init();
+
+    /**
+     * @brief Updates every started plugin once
+     *
+     * Returns once all of them are done. Must be called from the main thread.
+     * Plugins added during the update are started after the last stage.
+     *
+     * @param delta_time Seconds since the last update
+     * @param jobs Job system worker plugins run on
+     * @return void
+     */
+    void update(float delta_time, JobSystem& jobs);
+
+    /**
+     * @brief Calls close on every started plugin
+     *
+     * Plugins are closed in the reverse order they were started. Nothing
+     * happens for plugins that are already closed.
+     *
+     * @return void
+     */
+    void close();
+
+    /**
+     * @brief Gets how long each plugin's last update took
+     * @return Update times, in the order the plugins were added
+     */
+    const std::vector<PluginTime>& get_times() const { return times; }
+
+    /**
+     * @brief Gets the amount of stages plugins are split into
+     *
+     * 1 means every plugin can update at the same time, the plugin count means
+     * they all update one after another.
+     *
+     * @return Amount of stages
+     */
+    size_t get_stage_count();
+
+    size_t size() const { return entries.size(); }
+
+    /**
+     * @brief Checks if plugins are being updated right now
+     * @return true from the start of update until its last stage is done
+     */
+    bool is_updating() const { return updating; }
+
+private:
+    struct Entry {
+        std::shared_ptr<EnginePlugin> plugin;
+        std::string name;
+        std::vector<std::string> reads;
+        std::vector<std::string> writes;
+        bool main_thread = false;
+        bool started = false;
+        size_t stage = 0;
+    };
+
+    static bool conflicts(const Entry& a, const Entry& b);
+    void build_stages();
+    void run(size_t index, float delta_time);
+    void add_pending();
+
+    std::vector<Entry> entries;
+    std::vector<std::vector<size_t>> stages;
+    bool stages_dirty = false;
+    std::vector<PluginTime> times;
+    std::vector<size_t> started_order;
+    std::vector<Entry> pending;
+    std::mutex pending_mutex;
+    std::atomic<bool> updating{false};
+};
+
+}
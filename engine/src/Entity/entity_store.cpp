@@ -0,0 +1,310 @@
+#include "entity_store.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace hop {
+
+uint32_t EntityStore::push_slot(){
+    if(generation.size() >= MAX_ENTITIES){
+        throw std::runtime_error("entity store is full");
+    }
+
+    uint32_t index = static_cast<uint32_t>(generation.size());
+    translation.emplace_back(0.0f);
+    previous_translation.emplace_back(0.0f);
+    scale.emplace_back(1.0f);
+    color.emplace_back(0.0f);
+    mesh.emplace_back();
+    layer.push_back(0);
+    node.push_back(NO_NODE);
+    merged_into.emplace_back();
+    changed_frame.push_back(0);
+    is_static.push_back(0);
+    is_merge.push_back(0);
+    generation.push_back(0);
+    live.push_back(0);
+    sequence.push_back(0);
+    return index;
+}
+
+Entity EntityStore::create(std::shared_ptr<ObjectModel> m, glm::vec2 t, glm::vec3 c, int l){
+    uint32_t index;
+    if(!free_slots.empty()){
+        index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        index = push_slot();
+    }
+
+    translation[index] = t;
+    previous_translation[index] = t;
+    scale[index] = glm::vec2(1.0f);
+    color[index] = c;
+    mesh[index] = std::move(m);
+    layer[index] = l;
+    node[index] = NO_NODE;
+    merged_into[index] = Entity{};
+    changed_frame[index] = frame;
+    is_static[index] = 0;
+    is_merge[index] = 0;
+    live[index] = 1;
+    sequence[index] = next_sequence++;
+    count++;
+    order_dirty = true;
+    bump_layer(l);
+    return make_handle(index);
+}
+
+std::vector<Entity> EntityStore::allocate_range(size_t n){
+    std::vector<Entity> handles;
+    handles.reserve(n);
+
+    size_t new_size = generation.size() + n;
+    translation.reserve(new_size);
+    previous_translation.reserve(new_size);
+    scale.reserve(new_size);
+    color.reserve(new_size);
+    mesh.reserve(new_size);
+    layer.reserve(new_size);
+    node.reserve(new_size);
+    merged_into.reserve(new_size);
+    changed_frame.reserve(new_size);
+    is_static.reserve(new_size);
+    is_merge.reserve(new_size);
+    generation.reserve(new_size);
+    live.reserve(new_size);
+    sequence.reserve(new_size);
+
+    for(size_t i = 0; i < n; i++){
+        uint32_t index = push_slot();
+        live[index] = 1;
+        changed_frame[index] = frame;
+        sequence[index] = next_sequence++;
+        handles.push_back(make_handle(index));
+    }
+    count += n;
+    order_dirty = true;
+    bump_layer(0);
+    return handles;
+}
+
+void EntityStore::destroy(Entity e){
+    if(!alive(e)){
+        return;
+    }
+
+    uint32_t index = e.index();
+    touch(index);
+    if(is_merge[index]){
+        for(uint32_t i = 0; i < merged_into.size(); i++){
+            if(merged_into[i] == e){
+                merged_into[i] = Entity{};
+                bump_layer(layer[i]);
+            }
+        }
+        is_merge[index] = 0;
+    }
+
+    if(mesh[index] != nullptr){
+        retired.push_back(std::move(mesh[index]));
+    }
+    mesh[index] = nullptr;
+    live[index] = 0;
+    generation[index] = (generation[index] + 1) & Entity::GENERATION_MASK;
+    free_slots.push_back(index);
+    count--;
+    order_dirty = true;
+}
+
+void EntityStore::set_layer(Entity e, int new_layer){
+    if(!alive(e) || layer[e.index()] == new_layer){
+        return;
+    }
+    touch(e.index());
+    layer[e.index()] = new_layer;
+    bump_layer(new_layer);
+    order_dirty = true;
+}
+
+void EntityStore::attach(Entity e, NodeId new_node){
+    if(!alive(e)){
+        return;
+    }
+
+    uint32_t i = e.index();
+    touch(i);
+    Affine2D to_local = scene.world_transform(new_node).inverse() * scene.world_transform(node[i]);
+    translation[i] = to_local.apply(translation[i]);
+    previous_translation[i] = to_local.apply(previous_translation[i]);
+    interpolating = true;
+    scale[i] *= to_local.scale;
+    node[i] = new_node;
+}
+
+void EntityStore::release_node(NodeId released){
+    if(released == NO_NODE){
+        return;
+    }
+    for(uint32_t i = 0; i < node.size(); i++){
+        if(live[i] && node[i] == released){
+            attach(make_handle(i), NO_NODE);
+        }
+    }
+    scene.release_node(released);
+}
+
+void EntityStore::move(Entity e, glm::vec2 delta){
+    if(!alive(e)){
+        return;
+    }
+
+    uint32_t i = e.index();
+    touch(i);
+    if(node[i] != NO_NODE){
+        delta /= scene.world_transform(node[i]).scale;
+    }
+    translation[i] += delta;
+    interpolating = true;
+}
+
+void EntityStore::set_color(Entity e, glm::vec3 new_color){
+    if(!alive(e)){
+        return;
+    }
+    touch(e.index());
+    color[e.index()] = new_color;
+}
+
+void EntityStore::set_mesh(Entity e, std::shared_ptr<ObjectModel> new_mesh, glm::vec2 new_scale){
+    if(!alive(e)){
+        return;
+    }
+    uint32_t i = e.index();
+    touch(i);
+    if(mesh[i] != new_mesh && mesh[i] != nullptr){
+        retired.push_back(std::move(mesh[i]));
+    }
+    mesh[i] = std::move(new_mesh);
+    scale[i] = new_scale;
+}
+
+Entity EntityStore::merge(const std::vector<Entity>& parts, std::shared_ptr<ObjectModel> merged_mesh, NodeId merged_node){
+    Entity merged = create(std::move(merged_mesh), glm::vec2(0.0f), glm::vec3(1.0f));
+    uint32_t m = merged.index();
+    node[m] = merged_node;
+    is_merge[m] = 1;
+
+    bool first = true;
+    for(Entity part : parts){
+        if(!alive(part)){
+            continue;
+        }
+        uint32_t i = part.index();
+        merged_into[i] = merged;
+        bump_layer(layer[i]);
+        if(first || sequence[i] < sequence[m]){
+            sequence[m] = sequence[i];
+            layer[m] = layer[i];
+            first = false;
+        }
+    }
+    order_dirty = true;
+    bump_layer(layer[m]);
+    return merged;
+}
+
+void EntityStore::unmerge(Entity merged){
+    if(alive(merged) && is_merge[merged.index()]){
+        destroy(merged);
+    }
+}
+
+void EntityStore::touch(uint32_t index){
+    changed_frame[index] = frame;
+    bump_layer(layer[index]);
+    if(is_static[index]){
+        is_static[index] = 0;
+        static_version++;
+    }
+
+    /* Merged meshes are snapshots, editing a part means drawing it on its own again */
+    if(merged_into[index] != Entity{}){
+        unmerge(merged_into[index]);
+    }
+}
+
+void EntityStore::set_static(uint32_t index, bool value){
+    if(is_static[index] == value){
+        return;
+    }
+    is_static[index] = value;
+    static_version++;
+    bump_layer(layer[index]);
+}
+
+uint64_t EntityStore::get_layer_version(int l) const {
+    auto it = layer_versions.find(l);
+    return it == layer_versions.end() ? 0 : it->second;
+}
+
+void EntityStore::retire(std::shared_ptr<ObjectModel> retired_mesh){
+    if(retired_mesh != nullptr){
+        retired.push_back(std::move(retired_mesh));
+    }
+}
+
+void EntityStore::store_previous_translations(){
+    for(uint32_t i = 0; i < translation.size(); i++){
+        if(previous_translation[i] != translation[i]){
+            previous_translation[i] = translation[i];
+            bump_layer(layer[i]);
+        }
+    }
+    interpolating = false;
+    scene.store_previous_translations();
+}
+
+const std::vector<uint32_t>& EntityStore::get_draw_order(){
+    if(!order_dirty){
+        return draw_order;
+    }
+
+    draw_order.clear();
+    draw_order.reserve(count);
+    for(uint32_t i = 0; i < live.size(); i++){
+        if(live[i] && merged_into[i] == Entity{}){
+            draw_order.push_back(i);
+        }
+    }
+
+    std::sort(draw_order.begin(), draw_order.end(), [this](uint32_t a, uint32_t b){
+        return index_draws_before(a, b);
+    });
+
+    order_dirty = false;
+    order_version++;
+    return draw_order;
+}
+
+bool EntityStore::index_draws_before(uint32_t a, uint32_t b) const {
+    if(layer[a] != layer[b]){
+        return layer[a] > layer[b];
+    }
+    return sequence[a] < sequence[b];
+}
+
+bool EntityStore::draws_before(Entity a, Entity b) const {
+    if(!alive(a) || !alive(b)){
+        return alive(a) && !alive(b);
+    }
+    return index_draws_before(a.index(), b.index());
+}
+
+std::vector<std::shared_ptr<ObjectModel>> EntityStore::take_retired(){
+    std::vector<std::shared_ptr<ObjectModel>> taken;
+    taken.swap(retired);
+    return taken;
+}
+
+}
@@ -0,0 +1,351 @@
+/**
+ * @file entity_store.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Storage for everything the engine draws. Entities are stored as a
+ * structure of arrays and referred to by small generational handles.
+ *
+ */
+
+#pragma once
+
+#include "Objects/object.hpp"
+#include "scene_graph.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Handle to an entity
+ *
+ * A 32 bit value made up of a slot index (low 20 bits) and the generation of
+ * that slot (high 12 bits). When an entity is destroyed its slot's generation
+ * is bumped, so any handle still pointing at the old entity stops being alive
+ * instead of silently referring to whatever reuses the slot.
+ *
+ */
+struct Entity {
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    uint32_t id = INVALID;
+
+    uint32_t index() const { return id & INDEX_MASK; }
+    uint32_t generation() const { return id >> INDEX_BITS; }
+
+    bool operator==(const Entity& e) const { return id == e.id; }
+    bool operator!=(const Entity& e) const { return id != e.id; }
+};
+
+/**
+ * @brief Structure of arrays holding every entity
+ *
+ * Each component is its own column, a std::vector indexed by
+ * Entity::index(). Per frame work (interpolation, drawing) walks the columns
+ * front to back instead of chasing a pointer per object.
+ *
+ * Slots of destroyed entities are reused by create(), allocate_range() always
+ * appends so a bulk creation gets contiguous slots.
+ *
+ * NOTE: Columns are public for fast iteration. Only read slots that are alive,
+ *       dead slots keep stale data.
+ */
+class EntityStore {
+public:
+    static constexpr uint32_t MAX_ENTITIES = Entity::INDEX_MASK;
+
+    /**
+     * @brief Creates an entity
+     *
+     * @param mesh The model the entity is drawn with
+     * @param translation Position of the entity
+     * @param color Color of the entity
+     * @param layer Entities on higher layers are drawn on top
+     * @return Handle to the new entity
+     */
+    Entity create(std::shared_ptr<ObjectModel> mesh = nullptr, glm::vec2 translation = glm::vec2(0.0f), glm::vec3 color = glm::vec3(0.0f), int layer = 0);
+
+    /**
+     * @brief Creates count entities in contiguous slots
+     *
+     * The entities are created with no mesh, at the origin. Fill their
+     * columns before the next frame is drawn.
+     *
+     * @param count Amount of entities to create
+     * @return Handles of the new entities, their indices are consecutive
+     */
+    std::vector<Entity> allocate_range(size_t count);
+
+    /**
+     * @brief Destroys an entity
+     *
+     * The entity's mesh is moved to the retired list instead of being freed,
+     * since a frame in flight may still be drawing it. See take_retired.
+     *
+     * @param e Entity to destroy, does nothing if it isn't alive
+     * @return void
+     */
+    void destroy(Entity e);
+
+    /**
+     * @brief Checks if a handle refers to an existing entity
+     * @param e Handle to check
+     * @return true if the entity exists
+     */
+    bool alive(Entity e) const {
+        uint32_t i = e.index();
+        return i < generation.size() && generation[i] == e.generation() && live[i];
+    }
+
+    /**
+     * @brief Handle of the entity in a slot
+     * @param index Slot of an alive entity, e.g. from get_draw_order
+     * @return Handle to the entity
+     */
+    Entity get_handle(uint32_t index) const { return make_handle(index); }
+
+    /**
+     * @brief Changes the layer of an entity
+     *
+     * @param e Entity to change
+     * @param new_layer Layer to move the entity to
+     * @return void
+     */
+    void set_layer(Entity e, int new_layer);
+
+    /**
+     * @brief Attaches an entity to a scene node
+     *
+     * The entity's translation and scale become relative to the node. They
+     * are converted so the entity stays where it is on screen.
+     *
+     * @param e Entity to attach
+     * @param node Node to attach to, NO_NODE detaches the entity
+     * @return void
+     */
+    void attach(Entity e, NodeId node);
+
+    /**
+     * @brief Detaches every entity from a scene node and frees the node
+     *
+     * The entities stay where they are on screen. See SceneGraph::release_node
+     *
+     * @param node Node to free
+     * @return void
+     */
+    void release_node(NodeId node);
+
+    /**
+     * @brief Moves an entity
+     * @param e Entity to move
+     * @param delta Distance to move in world space
+     * @return void
+     */
+    void move(Entity e, glm::vec2 delta);
+
+    /**
+     * @brief Changes the color of an entity
+     * @param e Entity to change
+     * @param new_color The new color
+     * @return void
+     */
+    void set_color(Entity e, glm::vec3 new_color);
+
+    /**
+     * @brief Changes the mesh and scale of an entity
+     *
+     * The old mesh is retired like the mesh of a destroyed entity, unless it
+     * stays the same.
+     *
+     * @param e Entity to change
+     * @param new_mesh The mesh to draw the entity with
+     * @param new_scale The new scale, relative to the entity's node
+     * @return void
+     */
+    void set_mesh(Entity e, std::shared_ptr<ObjectModel> new_mesh, glm::vec2 new_scale);
+
+    /**
+     * @brief Replaces entities with a single merged entity
+     *
+     * The parts stop being drawn and the merged entity is drawn in their
+     * place, at the spot in the draw order of the earliest part. Editing any
+     * part (move, set_color, set_layer, destroy) unmerges it automatically.
+     *
+     * @param parts Entities that were merged
+     * @param merged_mesh Mesh holding every part, in the space of node
+     * @param node Node the merged entity is attached to
+     * @return Handle to the merged entity
+     */
+    Entity merge(const std::vector<Entity>& parts, std::shared_ptr<ObjectModel> merged_mesh, NodeId node);
+
+    /**
+     * @brief Destroys a merged entity and draws its parts again
+     * @param merged Entity returned by merge
+     * @return void
+     */
+    void unmerge(Entity merged);
+
+    /**
+     * @brief Copies every translation into previous_translation
+     *
+     * Includes the translations of scene nodes. See
+     * Engine::store_previous_transforms
+     *
+     * @return void
+     */
+    void store_previous_translations();
+
+    /**
+     * @brief Order entities should be drawn in
+     *
+     * Higher layers first, then by creation order within a layer. Only alive
+     * entities are listed. The order is cached and rebuilt only after entities
+     * are created, destroyed or change layer.
+     *
+     * NOTE: Each layer is drawn at its own depth and within a layer the depth
+     *       test keeps whatever was drawn first, so entities earlier in this
+     *       list are on top. See ObjectRenderSystem::layer_depth
+     *
+     * @return Indices of alive entities in draw order
+     */
+    const std::vector<uint32_t>& get_draw_order();
+
+    /**
+     * @brief Compares the draw order of two entities
+     *
+     * Dead entities compare as drawn last.
+     *
+     * @return true if a is drawn before b, see get_draw_order
+     */
+    bool draws_before(Entity a, Entity b) const;
+
+    /**
+     * @brief Retires a mesh that is no longer needed
+     *
+     * The mesh is freed once no frame in flight can be using it, like the
+     * meshes of destroyed entities.
+     *
+     * @param retired_mesh Mesh to free
+     * @return void
+     */
+    void retire(std::shared_ptr<ObjectModel> retired_mesh);
+
+    /**
+     * @brief Marks the start of a new frame
+     *
+     * Entities remember the frame they were last changed in, see changed_frame
+     *
+     * @return void
+     */
+    void advance_frame(){ frame++; }
+    uint64_t get_frame() const { return frame; }
+
+    /**
+     * @brief Counters that change whenever the draw order or the set of
+     *        static entities changes, for caching things built from them
+     */
+    uint64_t get_order_version() const { return order_version; }
+    uint64_t get_static_version() const { return static_version; }
+
+    /**
+     * @brief Counter that changes whenever anything drawn on a layer changes
+     *
+     * Creating, destroying, editing, merging or moving an entity in or out of
+     * the layer all change it.
+     *
+     * @param l The layer
+     * @return The version of the layer, 0 if nothing was ever on it
+     */
+    uint64_t get_layer_version(int l) const;
+
+    /**
+     * @brief Counter that changes whenever anything that is drawn changes
+     *
+     * Includes the scene graph.
+     *
+     * @return The version
+     */
+    uint64_t get_version() const { return layer_version_counter + scene.get_version(); }
+
+    /**
+     * @brief Checks if anything moved since the last store_previous_translations
+     * @return true if drawing with a different alpha gives a different result
+     */
+    bool is_interpolating() const { return interpolating || scene.is_interpolating(); }
+
+    /**
+     * @brief Moves an entity in or out of the static set
+     *
+     * Static entities are drawn from merged chunk buffers, see StaticBatch. Any
+     * change to a static entity moves it back out of the static set.
+     *
+     * @param index Index of an alive entity
+     * @param value true to make the entity static
+     * @return void
+     */
+    void set_static(uint32_t index, bool value);
+
+    /**
+     * @brief Takes the meshes of destroyed entities
+     * @return The retired meshes, the caller decides when they are safe to free
+     */
+    std::vector<std::shared_ptr<ObjectModel>> take_retired();
+
+    /**
+     * @brief Amount of alive entities
+     * @return Entity count
+     */
+    size_t size() const { return count; }
+
+    /* Columns */
+    std::vector<glm::vec2> translation;
+    std::vector<glm::vec2> previous_translation;
+    std::vector<glm::vec2> scale;
+    std::vector<glm::vec3> color;
+    std::vector<std::shared_ptr<ObjectModel>> mesh;
+    std::vector<int> layer;
+    std::vector<NodeId> node;
+    std::vector<Entity> merged_into;
+    std::vector<uint64_t> changed_frame;
+    std::vector<uint8_t> is_static;
+
+    /* Nodes entities can be attached to */
+    SceneGraph scene;
+
+private:
+    uint32_t push_slot();
+    void touch(uint32_t index);
+    void bump_layer(int l){ layer_versions[l] = ++layer_version_counter; }
+    bool index_draws_before(uint32_t a, uint32_t b) const;
+    Entity make_handle(uint32_t index) const { return Entity{(generation[index] << Entity::INDEX_BITS) | index}; }
+
+    std::vector<uint32_t> generation;
+    std::vector<uint8_t> live;
+    std::vector<uint64_t> sequence;
+    std::vector<uint8_t> is_merge;
+    std::vector<uint32_t> free_slots;
+    std::vector<uint32_t> draw_order;
+    std::vector<std::shared_ptr<ObjectModel>> retired;
+    uint64_t next_sequence = 0;
+    uint64_t frame = 0;
+    uint64_t order_version = 0;
+    uint64_t static_version = 0;
+    std::unordered_map<int, uint64_t> layer_versions;
+    uint64_t layer_version_counter = 0;
+    bool interpolating = false;
+    size_t count = 0;
+    bool order_dirty = false;
+};
+
+}
@@ -0,0 +1,185 @@
+#include "scene_graph.hpp"
+
+namespace hop {
+
+NodeId SceneGraph::create_node(){
+    NodeId node;
+    if(!free_nodes.empty()){
+        node = free_nodes.back();
+        free_nodes.pop_back();
+        translation[node] = glm::vec2(0.0f);
+        previous_translation[node] = glm::vec2(0.0f);
+        scale[node] = glm::vec2(1.0f);
+    } else {
+        node = static_cast<NodeId>(parent.size());
+        translation.emplace_back(0.0f);
+        previous_translation.emplace_back(0.0f);
+        scale.emplace_back(1.0f);
+        parent.push_back(NO_NODE);
+        first_child.push_back(NO_NODE);
+        next_sibling.push_back(NO_NODE);
+        dirty.push_back(0);
+        moving.push_back(0);
+        world.emplace_back();
+    }
+    mark_dirty(node);
+    version++;
+    return node;
+}
+
+void SceneGraph::release_node(NodeId node){
+    while(first_child[node] != NO_NODE){
+        set_parent(first_child[node], parent[node]);
+    }
+    unlink(node);
+    translation[node] = glm::vec2(0.0f);
+    previous_translation[node] = glm::vec2(0.0f);
+    scale[node] = glm::vec2(1.0f);
+    free_nodes.push_back(node);
+    version++;
+}
+
+bool SceneGraph::set_parent(NodeId node, NodeId new_parent){
+    for(NodeId n = new_parent; n != NO_NODE; n = parent[n]){
+        if(n == node){
+            return false;
+        }
+    }
+
+    /* local = parent_world^-1 * world keeps the node in place */
+    Affine2D parent_world = world_transform(new_parent).inverse();
+    Affine2D current = parent_world * world_transform(node);
+    Affine2D previous = parent_world * (world_transform(parent[node]) * Affine2D{previous_translation[node], scale[node]});
+
+    translation[node] = current.translation;
+    previous_translation[node] = previous.translation;
+    scale[node] = current.scale;
+    unlink(node);
+    link(node, new_parent);
+    mark_moving(node);
+    mark_dirty(node);
+    interpolating = true;
+    version++;
+    return true;
+}
+
+void SceneGraph::move(NodeId node, glm::vec2 delta){
+    glm::vec2 local_delta = delta / world_transform(parent[node]).scale;
+    translation[node] += local_delta;
+    mark_moving(node);
+    mark_dirty(node);
+    interpolating = true;
+    version++;
+}
+
+void SceneGraph::flip_x(NodeId node, float pivot_x){
+    /* Mirroring p around pivot_x before the local transform: t + s * (2 * pivot_x - p) */
+    float shift = 2.0f * scale[node].x * pivot_x;
+    translation[node].x += shift;
+    previous_translation[node].x += shift;
+    scale[node].x = -scale[node].x;
+    mark_dirty(node);
+    version++;
+}
+
+Affine2D SceneGraph::world_transform(NodeId node) const {
+    Affine2D result;
+    for(NodeId n = node; n != NO_NODE; n = parent[n]){
+        result = Affine2D{translation[n], scale[n]} * result;
+    }
+    return result;
+}
+
+void SceneGraph::store_previous_translations(){
+    if(!moving_nodes.empty()){
+        /* What these nodes blend to no longer depends on alpha */
+        for(NodeId node : moving_nodes){
+            previous_translation[node] = translation[node];
+            moving[node] = 0;
+            mark_dirty(node);
+        }
+        moving_nodes.clear();
+        version++;
+    }
+    interpolating = false;
+}
+
+const std::vector<Affine2D>& SceneGraph::get_world_transforms(float alpha){
+    if(alpha != world_alpha){
+        for(NodeId node : moving_nodes){
+            mark_dirty(node);
+        }
+        world_alpha = alpha;
+    }
+
+    for(NodeId node : dirty_nodes){
+        if(!dirty[node]){
+            continue;
+        }
+
+        /* Composing the highest dirty ancestor covers every dirty node below it */
+        NodeId root = node;
+        for(NodeId n = parent[node]; n != NO_NODE; n = parent[n]){
+            if(dirty[n]){
+                root = n;
+            }
+        }
+        compose_subtree(root, alpha);
+    }
+    dirty_nodes.clear();
+    return world;
+}
+
+void SceneGraph::mark_dirty(NodeId node){
+    if(!dirty[node]){
+        dirty[node] = 1;
+        dirty_nodes.push_back(node);
+    }
+}
+
+void SceneGraph::mark_moving(NodeId node){
+    if(!moving[node]){
+        moving[node] = 1;
+        moving_nodes.push_back(node);
+    }
+}
+
+void SceneGraph::link(NodeId node, NodeId new_parent){
+    parent[node] = new_parent;
+    if(new_parent != NO_NODE){
+        next_sibling[node] = first_child[new_parent];
+        first_child[new_parent] = node;
+    }
+}
+
+void SceneGraph::unlink(NodeId node){
+    NodeId old_parent = parent[node];
+    if(old_parent != NO_NODE){
+        NodeId* link = &first_child[old_parent];
+        while(*link != node){
+            link = &next_sibling[*link];
+        }
+        *link = next_sibling[node];
+    }
+    parent[node] = NO_NODE;
+    next_sibling[node] = NO_NODE;
+}
+
+void SceneGraph::compose_subtree(NodeId root, float alpha){
+    compose_stack.push_back(root);
+    while(!compose_stack.empty()){
+        NodeId node = compose_stack.back();
+        compose_stack.pop_back();
+
+        glm::vec2 t = previous_translation[node] + (translation[node] - previous_translation[node]) * alpha;
+        Affine2D local{t, scale[node]};
+        world[node] = parent[node] == NO_NODE ? local : world[parent[node]] * local;
+        dirty[node] = 0;
+
+        for(NodeId child = first_child[node]; child != NO_NODE; child = next_sibling[child]){
+            compose_stack.push_back(child);
+        }
+    }
+}
+
+}
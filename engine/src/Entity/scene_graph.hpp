@@ -0,0 +1,195 @@
+/**
+ * @file scene_graph.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Hierarchy of transforms entities can be attached to, so a whole group of
+ * entities can be moved or flipped by changing one node
+ *
+ */
+
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace hop {
+
+using NodeId = uint32_t;
+static constexpr NodeId NO_NODE = 0xFFFFFFFF;
+
+/**
+ * @brief 2D transform made of a per axis scale and a translation
+ *
+ * Maps a point p to translation + scale * p. A negative scale mirrors along
+ * that axis.
+ *
+ */
+struct Affine2D {
+    glm::vec2 translation = glm::vec2(0.0f);
+    glm::vec2 scale = glm::vec2(1.0f);
+
+    glm::vec2 apply(glm::vec2 p) const { return translation + scale * p; }
+
+    /**
+     * @brief Composes two transforms
+     * @param child Transform applied first
+     * @return Transform equal to applying child, then this
+     */
+    Affine2D operator*(const Affine2D& child) const {
+        return { apply(child.translation), scale * child.scale };
+    }
+
+    Affine2D inverse() const {
+        return { -translation / scale, 1.0f / scale };
+    }
+};
+
+/**
+ * @brief Tree of transform nodes
+ *
+ * Every node has a local transform relative to its parent. World transforms
+ * are only composed when they are asked for, and cached until a node changes,
+ * so moving a node is O(1) no matter how much is attached to it. Only the
+ * subtrees of nodes that changed are composed again.
+ *
+ * Released nodes are reused by create_node, so ids stay small however many
+ * nodes come and go.
+ *
+ * NOTE: Scales must never be zero, they have to be invertible
+ */
+class SceneGraph {
+public:
+    /**
+     * @brief Creates a node with an identity transform and no parent
+     * @return Id of the new node
+     */
+    NodeId create_node();
+
+    /**
+     * @brief Frees a node so create_node can reuse it
+     *
+     * Children of the node are given to its parent, they stay where they are
+     * in the world.
+     *
+     * NOTE: Nothing may still be attached to the node, see
+     *       EntityStore::release_node
+     *
+     * @param node Node to free
+     * @return void
+     */
+    void release_node(NodeId node);
+
+    /**
+     * @brief Changes the parent of a node
+     *
+     * The node's local transform is adjusted so it stays where it is in the
+     * world.
+     *
+     * @param node Node to reparent
+     * @param parent New parent, NO_NODE makes node a root
+     * @return false if this would create a cycle, true otherwise
+     */
+    bool set_parent(NodeId node, NodeId parent);
+
+    /**
+     * @brief Moves a node
+     * @param node Node to move
+     * @param delta Distance to move in world space
+     * @return void
+     */
+    void move(NodeId node, glm::vec2 delta);
+
+    /**
+     * @brief Mirrors a node horizontally
+     *
+     * @param node Node to flip
+     * @param pivot_x x coordinate, in the node's own space, to mirror around
+     * @return void
+     */
+    void flip_x(NodeId node, float pivot_x);
+
+    /**
+     * @brief Current world transform of a node
+     *
+     * Walks up to the root, use this for one off queries. Rendering uses
+     * get_world_transforms.
+     *
+     * @param node Node to get the transform of
+     * @return The world transform, identity for NO_NODE
+     */
+    Affine2D world_transform(NodeId node) const;
+
+    /**
+     * @brief Copies every translation into the previous translation
+     *
+     * See Engine::store_previous_transforms
+     *
+     * @return void
+     */
+    void store_previous_translations();
+
+    /**
+     * @brief World transforms of every node, indexed by NodeId
+     *
+     * Translations are blended between the previous and current state. The
+     * result is cached, only the subtrees of nodes that changed are composed
+     * again. A different alpha than the last call only composes the subtrees
+     * of nodes that moved since store_previous_translations.
+     *
+     * NOTE: Entries of released nodes are meaningless
+     *
+     * @param alpha 0 gives the previous state, 1 the current one
+     * @return World transforms
+     */
+    const std::vector<Affine2D>& get_world_transforms(float alpha);
+
+    /* Highest node id plus one, includes released nodes */
+    size_t size() const { return parent.size(); }
+
+    /**
+     * @brief Counter that changes whenever any node changes
+     * @return The version
+     */
+    uint64_t get_version() const { return version; }
+
+    /**
+     * @brief Checks if any node moved since the last store_previous_translations
+     * @return true if drawing with a different alpha gives a different result
+     */
+    bool is_interpolating() const { return interpolating; }
+
+private:
+    void mark_dirty(NodeId node);
+    void mark_moving(NodeId node);
+    void link(NodeId node, NodeId new_parent);
+    void unlink(NodeId node);
+    void compose_subtree(NodeId root, float alpha);
+
+    std::vector<glm::vec2> translation;
+    std::vector<glm::vec2> previous_translation;
+    std::vector<glm::vec2> scale;
+    std::vector<NodeId> parent;
+    std::vector<NodeId> first_child;
+    std::vector<NodeId> next_sibling;
+    std::vector<NodeId> free_nodes;
+
+    /* Nodes whose world transform, and their children's, must be composed again */
+    std::vector<NodeId> dirty_nodes;
+    std::vector<uint8_t> dirty;
+    /* Nodes whose translation differs from their previous translation */
+    std::vector<NodeId> moving_nodes;
+    std::vector<uint8_t> moving;
+
+    std::vector<Affine2D> world;
+    std::vector<NodeId> compose_stack;
+    float world_alpha = -1.0f;
+    uint64_t version = 0;
+    bool interpolating = false;
+};
+
+}
@@ -1,16 +1,20 @@
 #include "../hop.hpp"
 #include <Engine/engine.hpp>
-#include <chrono>
-#include <thread>
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include <ctype.h>
 #include <stdexcept>
+#include <string>
 using namespace hop;
 
-Game::Game(const char* window_name){
-    graphics_engine = std::make_shared<Engine>(window_name);
+Game::Game(const char* window_name) : graphics_engine{std::make_shared<Engine>(window_name)}, asset_loader{graphics_engine->get_jobs()} {
     Image::set_game(this);
+
+    /* Here rather than in run, sounds can be created and loaded before the game runs */
+    if(!audio_engine.init()){
+        console_warning("Game::Game()", "Audio could not be initialized, no sounds can be created.");
+    }
 }
 
 bool Game::set_window_size(int width, int height){
@@ -36,7 +40,6 @@ void Game::run(){
     graphics_engine->run(fullscreen);
     keyboard = std::make_shared<Keyboard>(graphics_engine->get_glfw_window());
     initialize_valid_keys();
-    audio_engine.init();
 }
 
 int Game::get_resolution_width(){
@@ -57,13 +60,283 @@ void Game::update(){
         return;
     }
 
-    std::chrono::steady_clock::time_point beginning = std::chrono::steady_clock::now();
-    std::chrono::steady_clock::time_point end = beginning + std::chrono::milliseconds(20);
+    graphics_engine->get_jobs().run_main_thread_jobs();
+
+    /* Only input the game has already had a chance to react to counts */
+    std::optional<std::chrono::steady_clock::time_point> input_time;
+    if(keyboard){
+        input_time = keyboard->get_pending_input_time();
+    }
+    if(input_time){
+        /* The game may react to the input in ways the engine can't see */
+        graphics_engine->request_redraw();
+    }
+
+    physics_time = 0.0f;
+    physics_steps = 0;
+    if(fixed_update){
+        run_fixed_updates();
+    } else {
+        /* Without a fixed step physics follows the frame, capped so a stall can't blow it up */
+        step_physics(std::min(frame_limiter.delta_time(), MAX_PHYSICS_STEP));
+    }
     graphics_engine->update();
-    std::chrono::steady_clock:: time_point intermediate = std::chrono::steady_clock::now();
-    std::chrono::duration<double> wait_time = std::chrono::duration_cast<std::chrono::duration<double>>(end - intermediate);  
-    std::this_thread::sleep_for(wait_time);
+    measure_input_latency(input_time);
+    frame_limiter.wait();
+}
+
+void Game::measure_input_latency(std::optional<std::chrono::steady_clock::time_point> input_time){
+    std::chrono::steady_clock::time_point present_time = graphics_engine->get_last_present_time();
+    if(!input_time || present_time < *input_time){
+        return;
+    }
+
+    input_latency = std::chrono::duration<float>(present_time - *input_time).count();
+    if(average_input_latency == 0.0f){
+        average_input_latency = input_latency;
+    } else {
+        average_input_latency = 0.9f * average_input_latency + 0.1f * input_latency;
+    }
+    keyboard->clear_pending_input_time();
+}
+
+void Game::set_latency_mode(LatencyMode mode){
+    graphics_engine->set_latency_mode(mode);
+}
+
+LatencyMode Game::get_latency_mode(){
+    return graphics_engine->get_latency_mode();
+}
+
+bool Game::set_frames_in_flight(int frames){
+    if(!graphics_engine->set_frames_in_flight(frames)){
+        std::string message = "Frames in flight must be between 1 and " + std::to_string(SwapChain::MAX_FRAMES_IN_FLIGHT) + ".";
+        console_warning("Game::set_frames_in_flight()", message.c_str());
+        return false;
+    }
+    return true;
+}
+
+int Game::get_frames_in_flight(){
+    return graphics_engine->get_frames_in_flight();
+}
+
+bool Game::set_fixed_update(std::function<void(float)> callback, int updates_per_second){
+    if(updates_per_second<1){
+        console_warning("Game::set_fixed_update()", "Updates per second must be at least 1.");
+        return false;
+    }
+    fixed_update = callback;
+    fixed_step = 1.0f / updates_per_second;
+    fixed_accumulator = 0.0f;
+    if(!fixed_update){
+        graphics_engine->set_interpolation_alpha(1.0f);
+    }
+    return true;
+}
+
+void Game::run_fixed_updates(){
+    /* Cap the backlog so a long stall doesn't lock the game up catching up */
+    fixed_accumulator += frame_limiter.delta_time();
+    if(fixed_accumulator > fixed_step * MAX_FIXED_STEPS){
+        fixed_accumulator = fixed_step * MAX_FIXED_STEPS;
+    }
+
+    while(fixed_accumulator >= fixed_step){
+        graphics_engine->store_previous_transforms();
+        step_physics(fixed_step);
+        fixed_update(fixed_step);
+        fixed_accumulator -= fixed_step;
+    }
+
+    /* Draw the leftover fraction of a step between the last two states */
+    graphics_engine->set_interpolation_alpha(fixed_accumulator / fixed_step);
+}
+
+void Game::set_target_fps(int fps){
+    if(fps<0){
+        console_warning("Game::set_target_fps()", "Target FPS can not be negative. Use 0 for an unlimited frame rate.");
+        return;
+    }
+    frame_limiter.set_target_fps(fps);
+}
+
+int Game::get_target_fps(){
+    return frame_limiter.get_target_fps();
+}
+
+float Game::delta_time(){
+    return frame_limiter.delta_time();
+}
+
+FrameStats Game::get_frame_stats(){
+    FrameStats stats = frame_limiter.get_stats();
+    stats.input_latency = input_latency;
+    stats.average_input_latency = average_input_latency;
+
+    stats.render = graphics_engine->get_render_stats();
+    stats.skipped_frames = graphics_engine->get_skipped_frames();
+    stats.gpu_time = graphics_engine->get_gpu_time();
+    stats.render_scale = graphics_engine->get_render_scale();
+    if(ParticleSystem* particles = graphics_engine->get_particles()){
+        stats.particles = particles->get_stats();
+    }
+    stats.plugin_time = graphics_engine->get_plugin_time();
+    stats.plugin_times = graphics_engine->get_plugin_times();
+    stats.physics_time = physics_time;
+    stats.physics_steps = physics_steps;
+    stats.physics = graphics_engine->get_physics().get_stats();
+    stats.physics.bodies = static_cast<uint32_t>(graphics_engine->get_physics().size());
+    return stats;
+}
+
+bool Game::set_static_promotion_frames(int frames){
+    if(frames < 0){
+        console_warning("Game::set_static_promotion_frames()", "Frame count is negative.");
+        return false;
+    }
+    graphics_engine->set_static_promotion_frames(frames);
+    return true;
+}
+
+bool Game::set_render_on_demand(bool enabled, float max_idle_seconds){
+    if(max_idle_seconds < 0.0f){
+        console_warning("Game::set_render_on_demand()", "Idle time is negative.");
+        return false;
+    }
+    graphics_engine->set_render_on_demand(enabled, max_idle_seconds);
+    return true;
+}
+
+void Game::request_redraw(){
+    graphics_engine->request_redraw();
+}
+
+void Game::set_partial_redraw(bool enabled){
+    graphics_engine->set_partial_redraw(enabled);
+}
+
+void Game::set_front_to_back(bool enabled){
+    graphics_engine->set_front_to_back(enabled);
+}
+
+bool Game::set_gpu_culling(bool enabled){
+    if(!graphics_engine->set_gpu_culling(enabled)){
+        console_warning("Game::set_gpu_culling()", "GPU culling is not supported, culling on the CPU.");
+        return false;
+    }
+    return true;
+}
+
+bool Game::set_dynamic_resolution(bool enabled, int target_fps){
+    if(target_fps<=0){
+        console_warning("Game::set_dynamic_resolution()", "Target FPS must be greater than 0.");
+        return false;
+    }
+    if(!graphics_engine->set_dynamic_resolution(enabled, 1.0f / target_fps)){
+        console_warning("Game::set_dynamic_resolution()", "Dynamic resolution is not supported, drawing at full resolution.");
+        return false;
+    }
+    return true;
+}
+
+void Game::set_camera_position(float x, float y){
+    graphics_engine->get_camera().set_position(glm::vec2(x, y));
+}
+
+void Game::move_camera(float x, float y){
+    graphics_engine->get_camera().move(glm::vec2(x, y));
+}
+
+bool Game::set_camera_zoom(float zoom){
+    if(zoom <= 0.0f){
+        console_warning("Game::set_camera_zoom()", "Zoom must be greater than 0");
+        return false;
+    }
+    graphics_engine->get_camera().set_zoom(zoom);
+    return true;
+}
+
+void Game::set_camera_rotation(float degrees){
+    graphics_engine->get_camera().set_rotation(degrees);
+}
+
+void Game::reset_camera(){
+    graphics_engine->get_camera().reset();
+}
+
+bool Game::draw_rect(int x, int y, int width, int height, Color color){
+    if(width<1 || height<1){
+        console_warning("Game::draw_rect()", "Width or height is less than 1");
+        return false;
+    }
+    graphics_engine->draw_rect(x, y, width, height, color);
+    return true;
+}
+
+bool Game::draw_line(int x1, int y1, int x2, int y2, Color color, float thickness){
+    if(thickness <= 0.0f){
+        console_warning("Game::draw_line()", "Thickness must be greater than 0");
+        return false;
+    }
+    graphics_engine->draw_line(x1, y1, x2, y2, color, thickness);
+    return true;
+}
+
+bool Game::draw_circle(int x, int y, float radius, Color color){
+    if(radius <= 0.0f){
+        console_warning("Game::draw_circle()", "Radius must be greater than 0");
+        return false;
+    }
+    graphics_engine->draw_circle(x, y, radius, color);
+    return true;
+}
+
+bool Game::draw_rounded_rect(int x, int y, int width, int height, float corner_radius, Color color){
+    if(width<1 || height<1){
+        console_warning("Game::draw_rounded_rect()", "Width or height is less than 1");
+        return false;
+    }
+    if(corner_radius < 0.0f){
+        console_warning("Game::draw_rounded_rect()", "Corner radius is negative");
+        return false;
+    }
+    graphics_engine->draw_rounded_rect(x, y, width, height, corner_radius, color);
+    return true;
+}
+
+bool Game::draw_ring(int x, int y, float radius, float thickness, Color color){
+    if(radius <= 0.0f || thickness <= 0.0f){
+        console_warning("Game::draw_ring()", "Radius and thickness must be greater than 0");
+        return false;
+    }
+    graphics_engine->draw_ring(x, y, radius, thickness, color);
+    return true;
+}
+
+bool Game::draw_capsule(int x1, int y1, int x2, int y2, float radius, Color color){
+    if(radius <= 0.0f){
+        console_warning("Game::draw_capsule()", "Radius must be greater than 0");
+        return false;
+    }
+    graphics_engine->draw_capsule(x1, y1, x2, y2, radius, color);
+    return true;
+}
 
+Emitter Game::create_emitter(int x, int y, const EmitterDesc& desc){
+    if(desc.max_particles < 1){
+        console_warning("Game::create_emitter()", "Max particles is less than 1.");
+        return nullptr;
+    }
+    if(desc.rate < 0.0f){
+        console_warning("Game::create_emitter()", "Rate is negative.");
+        return nullptr;
+    }
+    if(desc.lifetime_min <= 0.0f || desc.lifetime_max < desc.lifetime_min){
+        console_warning("Game::create_emitter()", "Lifetime must be more than 0 and max at least min.");
+        return nullptr;
+    }
+    return graphics_engine->create_emitter(x, y, desc);
 }
 
 void Game::set_fullscreen(){
@@ -232,6 +505,66 @@ Triangle Game::create_triangle(int v1x, int v1y, int v2x, int v2y, int v3x, int
     return graphics_engine->create_triangle(v1x,v1y,v2x,v2y,v3x,v3y,color);
 }
 
+std::vector<Rectangle> Game::create_rectangles(const std::vector<RectDesc>& rects){
+    /* Invalid rectangles are left out of the batch and returned as nullptr */
+    std::vector<RectDesc> valid;
+    valid.reserve(rects.size());
+    for(const RectDesc& r : rects){
+        if((r.width>=1)&&(r.height>=1)){
+            valid.push_back(r);
+        }
+    }
+    if(valid.size() != rects.size()){
+        console_warning("Game::create_rectangles()", "Some rectangles have a width or height less than 1, they were not created.");
+    }
+
+    std::vector<Rectangle> created = graphics_engine->create_rectangles(valid);
+    if(valid.size() == rects.size()){
+        return created;
+    }
+
+    std::vector<Rectangle> result(rects.size(), nullptr);
+    size_t next = 0;
+    for(size_t i = 0; i < rects.size(); i++){
+        if((rects[i].width>=1)&&(rects[i].height>=1)){
+            result[i] = created[next++];
+        }
+    }
+    return result;
+}
+
+std::vector<Circle> Game::create_circles(const std::vector<CircleDesc>& circles){
+    /* Invalid circles are left out of the batch and returned as nullptr */
+    std::vector<CircleDesc> valid;
+    valid.reserve(circles.size());
+    for(const CircleDesc& c : circles){
+        if(c.radius>=1){
+            valid.push_back(c);
+        }
+    }
+    if(valid.size() != circles.size()){
+        console_warning("Game::create_circles()", "Some circles have a radius less than 1, they were not created.");
+    }
+
+    std::vector<Circle> created = graphics_engine->create_circles(valid);
+    if(valid.size() == circles.size()){
+        return created;
+    }
+
+    std::vector<Circle> result(circles.size(), nullptr);
+    size_t next = 0;
+    for(size_t i = 0; i < circles.size(); i++){
+        if(circles[i].radius>=1){
+            result[i] = created[next++];
+        }
+    }
+    return result;
+}
+
+std::vector<Triangle> Game::create_triangles(const std::vector<TriangleDesc>& triangles){
+    return graphics_engine->create_triangles(triangles);
+}
+
 Sound Game:: create_sound(const char* file_name, bool loop_sound){
     
     Sound return_sound = audio_engine.create_sound(file_name, loop_sound);
@@ -242,6 +575,128 @@ Sound Game:: create_sound(const char* file_name, bool loop_sound){
     return return_sound;
 }
 
+std::shared_future<Sound> Game::load_sound(const char* file_name, bool loop_sound, std::function<void(const Sound&)> on_loaded){
+    std::string name = file_name;
+    return asset_loader.load<Sound>([this, name, loop_sound](){
+        /* Decoding the whole file here means playing it later costs nothing */
+        Sound sound = audio_engine.create_sound(name.c_str(), loop_sound, true);
+        if(sound == NULL){
+            console_warning("Game::load_sound()", 
+            "Sound could not be intialized. Verify that file is correctly named and located in project/sounds.");
+        }
+        return sound;
+    }, on_loaded);
+}
+
+size_t Game::assets_loading(){
+    return asset_loader.pending();
+}
+
+bool Game::set_worker_threads(int count, bool pin_threads){
+    if(count<0){
+        console_warning("Game::set_worker_threads()", "Thread count can not be negative. Use 0 for the default.");
+        return false;
+    }
+    graphics_engine->get_jobs().configure(count, pin_threads);
+    return true;
+}
+
+JobSystem& Game::get_job_system(){
+    return graphics_engine->get_jobs();
+}
+
+void Game::step_physics(float step){
+    PhysicsWorld& physics = graphics_engine->get_physics();
+    if(physics.size() == 0){
+        return;
+    }
+    physics.step(step);
+    physics_time += physics.get_stats().step_time;
+    physics_steps++;
+}
+
+/*
+ * A body only holds a weak reference to its object, a destroyed object or one
+ * the game let go of doesn't stay alive through its body. The object keeps
+ * its place relative to the body, offset is from the body's center to the
+ * object's top left corner.
+ */
+
+/* Moves an object by however many whole pixels its body moved */
+static PhysicsWorld::SyncCallback follow_body(std::weak_ptr<EngineGameObject> object, glm::vec2 offset){
+    return [object, offset](glm::vec2 position){
+        std::shared_ptr<EngineGameObject> target = object.lock();
+        if(target == nullptr || !target->is_alive()){
+            return;
+        }
+        int x = static_cast<int>(std::lround(position.x + offset.x));
+        int y = static_cast<int>(std::lround(position.y + offset.y));
+        if(x != target->x || y != target->y){
+            target->move(x - target->x, y - target->y);
+        }
+    };
+}
+
+/* Drops the body once its object is gone, and puts it back under an object the game moved itself */
+static PhysicsWorld::PullCallback track_object(std::weak_ptr<EngineGameObject> object, glm::vec2 offset){
+    return [object, offset](glm::vec2& position){
+        std::shared_ptr<EngineGameObject> target = object.lock();
+        if(target == nullptr || !target->is_alive()){
+            return false;
+        }
+        int x = static_cast<int>(std::lround(position.x + offset.x));
+        int y = static_cast<int>(std::lround(position.y + offset.y));
+        if(x != target->x || y != target->y){
+            position = glm::vec2(target->x, target->y) - offset;
+        }
+        return true;
+    };
+}
+
+Body Game::add_body(const Rectangle& rectangle, BodyType type, const BodyDesc& desc){
+    if(rectangle == nullptr || !rectangle->is_alive()){
+        console_warning("Game::add_body()", "Rectangle does not exist.");
+        return Body{};
+    }
+    if(type == BodyType::DYNAMIC && desc.mass <= 0.0f){
+        console_warning("Game::add_body()", "Mass of a dynamic body must be more than 0.");
+        return Body{};
+    }
+    PhysicsWorld& physics = graphics_engine->get_physics();
+    glm::vec2 half_size(rectangle->width / 2.0f, rectangle->height / 2.0f);
+    glm::vec2 center = glm::vec2(rectangle->x, rectangle->y) + half_size;
+    Body body = physics.add_box(center, half_size, type, desc);
+    glm::vec2 offset = -half_size;
+    physics.attach(body, follow_body(rectangle, offset), track_object(rectangle, offset));
+    return body;
+}
+
+Body Game::add_body(const Circle& circle, BodyType type, const BodyDesc& desc){
+    if(circle == nullptr || !circle->is_alive()){
+        console_warning("Game::add_body()", "Circle does not exist.");
+        return Body{};
+    }
+    if(type == BodyType::DYNAMIC && desc.mass <= 0.0f){
+        console_warning("Game::add_body()", "Mass of a dynamic body must be more than 0.");
+        return Body{};
+    }
+    PhysicsWorld& physics = graphics_engine->get_physics();
+    float radius = circle->width / 2.0f;
+    glm::vec2 center(circle->x + radius, circle->y + radius);
+    Body body = physics.add_circle(center, radius, type, desc);
+    glm::vec2 offset(-radius, -radius);
+    physics.attach(body, follow_body(circle, offset), track_object(circle, offset));
+    return body;
+}
+
+void Game::remove_body(Body body){
+    graphics_engine->get_physics().remove(body);
+}
+
+PhysicsWorld& Game::get_physics(){
+    return graphics_engine->get_physics();
+}
+
 void Game::console_warning(const char* function, const char* error_msg){
     std::cout << "WARNING: Error in " << function << "." << std::endl;
     std::cout << "\t" << error_msg << std::endl << std::endl;
@@ -262,6 +717,27 @@ Image::Image(int x, int y,int width, int height){
     this->y = y;
     this->width = width;
     this->height = height;
+    this->origin_x = x;
+    this->node = game->graphics_engine->get_entities().scene.create_node();
+    this->node_owner = std::shared_ptr<NodeOwner>(new NodeOwner{node, game->graphics_engine});
+}
+
+Image::NodeOwner::~NodeOwner(){
+    /* Objects attached to the node may outlive the image, they stay where they are */
+    if(auto e = engine.lock()){
+        e->get_entities().release_node(node);
+    }
+}
+
+bool Image::attach(const GameObject& object){
+    if(object == nullptr){
+        return false;
+    }
+    unbake();
+    unbake_parents();
+    game->graphics_engine->get_entities().attach(object->get_entity(), node);
+    game_objects.push_back(object);
+    return true;
 }
 
 bool Image::create_rectangle(int x, int y, int width, int height, Color color){
@@ -283,8 +759,7 @@ bool Image::create_rectangle(int x, int y, int width, int height, Color color){
         return false;
     }
     else{
-        game_objects.push_back(game->create_rectangle(x + this->x,y + this->y,width,height,color));
-        return true;
+        return attach(game->create_rectangle(x + this->x,y + this->y,width,height,color));
     }
 }
 
@@ -300,8 +775,7 @@ bool Image::create_circle(int x, int y, int radius, Color color){
         return false;
     }
     else{
-        game_objects.push_back(game->create_circle(x + this->x,y + this->y,radius,color));
-        return true;
+        return attach(game->create_circle(x + this->x,y + this->y,radius,color));
     }
 }
 
@@ -325,8 +799,7 @@ bool Image::create_triangle(int v1x, int v1y, int v2x, int v2y, int v3x, int v3y
     }
 
     else{
-        game_objects.push_back(game->create_triangle(v1x+x,v1y+y,v2x+x,v2y+y,v3x+x,v3y+y,color));
-        return true;
+        return attach(game->create_triangle(v1x+x,v1y+y,v2x+x,v2y+y,v3x+x,v3y+y,color));
     }
 }
 
@@ -335,6 +808,8 @@ void Image::set_game(Game* g){
 }
 
 void Image::set_color_all(hop::Color color){
+    unbake();
+    unbake_parents();
     for(auto obj: game_objects){
         obj->set_color(color);
     }
@@ -344,14 +819,11 @@ void Image::set_color_all(hop::Color color){
 }
 
 void Image::move(int x, int y){
-    for(auto o:game_objects){
-        o->move(x,y);
-    }
-    for(auto i:images){
-        for(auto o:i.game_objects){
-            o->move(x,y);
-        }
-    }
+    /* Objects and child images are attached to the node, moving it moves them all */
+    float f_x = (2.0f * x) / EngineGameObject::resolution_width;
+    float f_y = (-2.0f * y) / EngineGameObject::resolution_height;
+    game->graphics_engine->get_entities().scene.move(node, {f_x, f_y});
+    unbake_parents();
     this->x = this->x + x;
     this->y = this->y + y;
 }
@@ -364,6 +836,13 @@ bool Image::add_image(int x, int y, Image image){
     }
     else{
         image.move((this->x - image.x + x), (this->y - image.y + y));
+        if(!game->graphics_engine->get_entities().scene.set_parent(image.node, node)){
+            console_warning("Image::add_image()","Image can't be added to itself or one of its children.");
+            return false;
+        }
+        unbake();
+        unbake_parents();
+        image.bake_state->parent = bake_state;
         images.push_back(image);
         return true;
     }
@@ -371,10 +850,51 @@ bool Image::add_image(int x, int y, Image image){
 }
 
 void Image::flip(){
+    /* Mirror around the center of the image, in the space its objects were created in */
+    float pivot_x = (2.0f * origin_x + width) / EngineGameObject::resolution_width;
+    game->graphics_engine->get_entities().scene.flip_x(node, pivot_x);
+    unbake_parents();
+}
 
-    for(auto obj:game_objects){
-        int new_x = this->width - obj->x +this->x - obj->width;
-        obj->move((new_x - obj->x) +this->x,0);
+bool Image::bake(){
+    unbake();
+
+    std::vector<Entity> parts;
+    collect_entities(parts);
+    if(parts.empty()){
+        console_warning("Image::bake()", "Image has no shapes to bake.");
+        return false;
+    }
+
+    bake_state->merged = game->graphics_engine->bake(parts, node);
+    return is_baked();
+}
+
+void Image::unbake(){
+    game->graphics_engine->get_entities().unmerge(bake_state->merged);
+    bake_state->merged = Entity{};
+}
+
+bool Image::is_baked(){
+    return game->graphics_engine->get_entities().alive(bake_state->merged);
+}
+
+void Image::collect_entities(std::vector<Entity>& parts){
+    for(const auto& obj : game_objects){
+        parts.push_back(obj->get_entity());
+    }
+    for(auto& i : images){
+        /* A baked child would keep drawing its own merged mesh */
+        i.unbake();
+        i.collect_entities(parts);
+    }
+}
+
+void Image::unbake_parents(){
+    /* Parents baked this image's shapes where they were, that's no longer true */
+    for(auto p = bake_state->parent.lock(); p != nullptr; p = p->parent.lock()){
+        game->graphics_engine->get_entities().unmerge(p->merged);
+        p->merged = Entity{};
     }
 }
 int Image::get_x(){
@@ -389,6 +909,9 @@ int Image::get_width(){
 int Image::get_height(){
     return this->height;
 }
+const std::vector<GameObject>& Image::get_objects(){
+    return this->game_objects;
+}
 
 void Image::console_warning(const char* function, const char* error_msg){
     std::cout << "WARNING: Error in " << function << "." << std::endl;
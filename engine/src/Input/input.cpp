@@ -41,6 +41,10 @@ void Keyboard::key_callback(GLFWwindow* window, int key, int scancode, int actio
         return;
     }
 
+    if(!pending_input_time){
+        pending_input_time = std::chrono::steady_clock::now();
+    }
+
     if(action == GLFW_PRESS){
         keys_pressed.push_back(key);
     }
@@ -116,6 +120,14 @@ std::vector<int> Keyboard::get_released_keys(){
     keys_released.clear();
     return tmp;
 }
+
+std::optional<std::chrono::steady_clock::time_point> Keyboard::get_pending_input_time(){
+    return pending_input_time;
+}
+
+void Keyboard::clear_pending_input_time(){
+    pending_input_time.reset();
+}
 }
 
 
@@ -14,6 +14,8 @@
 #include <hop.hpp>
 #include <GLFW/glfw3.h>
 #include <vector>
+#include <chrono>
+#include <optional>
 namespace hop{
 class Game;
 
@@ -32,6 +34,10 @@ class Keyboard{
     std::vector<int> get_held_keys();
     std::vector<int> get_released_keys();
 
+    // Time of the oldest key event that has not made it to the screen yet
+    std::optional<std::chrono::steady_clock::time_point> get_pending_input_time();
+    void clear_pending_input_time();
+
 
     private:
     GLFWwindow* window; 
@@ -41,6 +47,7 @@ class Keyboard{
     inline static std::vector<int> keys_pressed;
     inline static std::vector<int> keys_held;
     inline static std::vector<int> keys_released;
+    inline static std::optional<std::chrono::steady_clock::time_point> pending_input_time;
 
 };
 
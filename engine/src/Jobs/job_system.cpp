@@ -0,0 +1,305 @@
+#include "job_system.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hop {
+
+struct Job {
+    std::function<void()> work;
+    bool on_main_thread = false;
+
+    /* Dependencies left, plus one held by submit until every dependency is added */
+    std::atomic<int> unfinished{1};
+    std::atomic<bool> done{false};
+    std::mutex mutex;
+    std::vector<JobHandle> continuations;
+};
+
+/* Which worker of which system the current thread is, if any */
+thread_local const JobSystem* current_system = nullptr;
+thread_local size_t current_worker = 0;
+
+JobSystem::JobSystem(unsigned int thread_count, bool pin_threads) : main_thread{std::this_thread::get_id()} {
+    start(thread_count, pin_threads);
+}
+
+JobSystem::~JobSystem(){
+    stop();
+}
+
+JobHandle JobSystem::submit(std::function<void()> work, const std::vector<JobHandle>& dependencies){
+    JobHandle job = create(std::move(work), false);
+    add_dependencies(job, dependencies);
+    return job;
+}
+
+JobHandle JobSystem::submit_main(std::function<void()> work, const std::vector<JobHandle>& dependencies){
+    JobHandle job = create(std::move(work), true);
+    add_dependencies(job, dependencies);
+    return job;
+}
+
+JobHandle JobSystem::create(std::function<void()> work, bool on_main_thread){
+    JobHandle job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->on_main_thread = on_main_thread;
+    return job;
+}
+
+void JobSystem::add_dependencies(const JobHandle& job, const std::vector<JobHandle>& dependencies){
+    for(const JobHandle& dependency : dependencies){
+        if(dependency == nullptr){
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if(!dependency->done){
+            job->unfinished++;
+            dependency->continuations.push_back(job);
+        }
+    }
+    release(job);
+}
+
+void JobSystem::release(const JobHandle& job){
+    if(--job->unfinished == 0){
+        schedule(job);
+    }
+}
+
+void JobSystem::schedule(const JobHandle& job){
+    if(job->on_main_thread){
+        std::lock_guard<std::mutex> lock(main_mutex);
+        main_jobs.push_back(job);
+        return;
+    }
+
+    /* Workers keep their own jobs, anyone else spreads them around */
+    size_t index = current_system == this ? current_worker : next_queue++ % queues.size();
+    active++;
+    queued++;
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(job);
+    }
+
+    /* Taking the lock means a worker about to sleep can't miss this */
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::try_run_one(){
+    size_t count = queues.size();
+    size_t own = current_system == this ? current_worker : next_queue.load() % count;
+
+    JobHandle job;
+    for(size_t i = 0; i < count && job == nullptr; i++){
+        WorkerQueue& queue = *queues[(own + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.jobs.empty()){
+            continue;
+        }
+
+        /* Newest from our own queue, oldest when stealing */
+        if(i == 0 && current_system == this){
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        } else {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+    }
+
+    if(job == nullptr){
+        return false;
+    }
+    queued--;
+    execute(job);
+    active--;
+    return true;
+}
+
+void JobSystem::execute(const JobHandle& job){
+    try {
+        job->work();
+    } catch(const std::exception& e){
+        WARNING("JOB SYSTEM", e.what());
+    } catch(...){
+        WARNING("JOB SYSTEM", "job threw an unknown exception");
+    }
+    job->work = nullptr;
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done = true;
+        continuations.swap(job->continuations);
+    }
+    for(const JobHandle& continuation : continuations){
+        release(continuation);
+    }
+}
+
+void JobSystem::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body){
+    if(count == 0){
+        return;
+    }
+
+    size_t threads = workers.size() + 1;
+    if(grain == 0){
+        grain = std::max<size_t>(1, count / (threads * 4));
+    }
+    size_t chunks = (count + grain - 1) / grain;
+    if(chunks == 1){
+        body(0, count);
+        return;
+    }
+
+    /* Helpers that start after every chunk was taken just return, so the state has to outlive this call */
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+    };
+    auto state = std::make_shared<State>();
+    const std::function<void(size_t, size_t)>* function = &body;
+    auto run_chunks = [state, function, count, grain, chunks](){
+        for(size_t chunk = state->next++; chunk < chunks; chunk = state->next++){
+            size_t begin = chunk * grain;
+            (*function)(begin, std::min(count, begin + grain));
+            state->finished++;
+        }
+    };
+
+    size_t helpers = std::min(chunks - 1, workers.size());
+    for(size_t i = 0; i < helpers; i++){
+        submit(run_chunks);
+    }
+    run_chunks();
+
+    while(state->finished < chunks){
+        if(!try_run_one()){
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::wait(const JobHandle& job){
+    while(!is_done(job)){
+        if(try_run_one()){
+            continue;
+        }
+        if(is_main_thread() && run_main_thread_jobs() > 0){
+            continue;
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool JobSystem::is_done(const JobHandle& job) const {
+    return job == nullptr || job->done;
+}
+
+size_t JobSystem::run_main_thread_jobs(){
+    /* Swap the queue out so jobs can submit more main thread jobs without deadlocking */
+    std::deque<JobHandle> ready;
+    {
+        std::lock_guard<std::mutex> lock(main_mutex);
+        ready.swap(main_jobs);
+    }
+
+    for(const JobHandle& job : ready){
+        execute(job);
+    }
+    return ready.size();
+}
+
+void JobSystem::configure(unsigned int thread_count, bool pin_threads){
+    while(active > 0){
+        if(!try_run_one()){
+            std::this_thread::yield();
+        }
+    }
+    stop();
+    start(thread_count, pin_threads);
+}
+
+void JobSystem::start(unsigned int thread_count, bool pin_threads){
+    if(thread_count == 0){
+        unsigned int hardware_threads = std::thread::hardware_concurrency();
+        thread_count = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+
+    stopping = false;
+    pinned = pin_threads;
+#if !defined(__linux__)
+    if(pinned){
+        WARNING("JOB SYSTEM", "pinning threads is not supported on this platform");
+        pinned = false;
+    }
+#endif
+
+    queues.clear();
+    for(unsigned int i = 0; i < thread_count; i++){
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for(unsigned int i = 0; i < thread_count; i++){
+        workers.emplace_back(&JobSystem::worker_loop, this, i);
+    }
+    INFO("JOB SYSTEM", "started " << thread_count << " worker threads" << (pinned ? " pinned to cores" : ""));
+}
+
+void JobSystem::stop(){
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(auto& worker : workers){
+        worker.join();
+    }
+    workers.clear();
+
+    /* Dropping queued jobs would leave whoever waits on them or their dependents hanging, finish them here */
+    while(try_run_one()){}
+}
+
+void JobSystem::worker_loop(size_t index){
+    current_system = this;
+    current_worker = index;
+
+#if defined(__linux__)
+    if(pinned){
+        unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((index + 1) % cores, &set);
+        if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0){
+            WARNING("JOB SYSTEM", "failed to pin worker " << index);
+        }
+    }
+#endif
+
+    while(true){
+        if(try_run_one()){
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this](){ return stopping || queued > 0; });
+        if(stopping){
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,190 @@
+/**
+ * @file job_system.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Work stealing thread pool that runs small jobs for the engine and the game
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hop {
+
+struct Job;
+
+/**
+ * @brief Handle to a submitted job
+ *
+ * Used to wait on a job or to make other jobs depend on it.
+ */
+using JobHandle = std::shared_ptr<Job>;
+
+/**
+ * @brief Runs jobs on a pool of worker threads
+ *
+ * Every worker has its own queue. Jobs submitted from a worker go on that
+ * worker's queue and are taken from the back, so related work stays on the
+ * same core while it's still in cache. A worker with nothing to do steals from
+ * the front of another worker's queue. Idle workers sleep until a job is
+ * submitted.
+ *
+ * A job can depend on other jobs, it's only queued once all of them finished.
+ * Jobs submitted with submit_main run on the main thread during
+ * run_main_thread_jobs(), which is where anything touching the engine or
+ * Vulkan has to happen.
+ *
+ * NOTE: Jobs that throw are reported and count as finished
+ * NOTE: Jobs still queued when the workers stop, on configure or when the
+ *       system is destroyed, are run by the thread stopping them
+ */
+class JobSystem {
+public:
+    /**
+     * @brief Constructor
+     *
+     * Starts the worker threads. The thread constructing the system is taken
+     * as the main thread.
+     *
+     * @param thread_count Amount of worker threads, 0 picks one less than the
+     *                     amount of hardware threads (at least 1)
+     * @param pin_threads Pins each worker to its own core, see configure
+     */
+    JobSystem(unsigned int thread_count = 0, bool pin_threads = false);
+
+    /**
+     * @brief Deconstructor
+     *
+     * Running jobs are finished before the workers are joined, jobs that
+     * have not started are then run on the destroying thread.
+     */
+    ~JobSystem();
+
+    // Prevents copying of this object
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Runs work on a worker thread
+     *
+     * @param work Function to run
+     * @param dependencies Jobs that must finish before work starts
+     * @return Handle to the job
+     */
+    JobHandle submit(std::function<void()> work, const std::vector<JobHandle>& dependencies = {});
+
+    /**
+     * @brief Runs work on the main thread
+     *
+     * The work runs during the first run_main_thread_jobs() after all of its
+     * dependencies finished. Used to continue on the main thread once work on
+     * the workers is done.
+     *
+     * @param work Function to run
+     * @param dependencies Jobs that must finish before work starts
+     * @return Handle to the job
+     */
+    JobHandle submit_main(std::function<void()> work, const std::vector<JobHandle>& dependencies = {});
+
+    /**
+     * @brief Runs body over a range split into chunks, on every worker
+     *
+     * The calling thread works on chunks too, and returns once all of them
+     * are done. Can be called from inside a job.
+     *
+     * @param count Size of the range
+     * @param grain Amount of indices handed out at a time, 0 picks one so
+     *              every thread gets a few chunks
+     * @param body Called with [begin, end) of each chunk, from several threads at once
+     * @return void
+     */
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief Waits until a job finished
+     *
+     * The waiting thread runs other jobs meanwhile. On the main thread this
+     * includes main thread jobs.
+     *
+     * @param job Job to wait on, nothing happens for nullptr
+     * @return void
+     */
+    void wait(const JobHandle& job);
+
+    /**
+     * @brief Checks if a job finished
+     * @param job Job to check
+     * @return true if it ran, or is nullptr
+     */
+    bool is_done(const JobHandle& job) const;
+
+    /**
+     * @brief Runs the main thread jobs that are ready
+     *
+     * This should be called once per frame on the main thread. Jobs that
+     * become ready while this runs wait for the next call.
+     *
+     * @return Amount of jobs that were run
+     */
+    size_t run_main_thread_jobs();
+
+    /**
+     * @brief Restarts the workers with a new thread count
+     *
+     * Waits for every queued job to finish first.
+     *
+     * NOTE: Only call from the main thread while nothing else submits jobs
+     * NOTE: Pinning is only supported on Linux, it's ignored elsewhere
+     *
+     * @param thread_count Amount of worker threads, 0 picks the default
+     * @param pin_threads Pins worker n to core n + 1, leaving core 0 to the main thread
+     * @return void
+     */
+    void configure(unsigned int thread_count, bool pin_threads);
+
+    size_t thread_count() const { return workers.size(); }
+    bool is_pinned() const { return pinned; }
+    bool is_main_thread() const { return std::this_thread::get_id() == main_thread; }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    JobHandle create(std::function<void()> work, bool on_main_thread);
+    void add_dependencies(const JobHandle& job, const std::vector<JobHandle>& dependencies);
+    void release(const JobHandle& job);
+    void schedule(const JobHandle& job);
+    bool try_run_one();
+    void execute(const JobHandle& job);
+    void start(unsigned int thread_count, bool pin_threads);
+    void stop();
+    void worker_loop(size_t index);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<size_t> next_queue{0};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> active{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool pinned = false;
+
+    std::deque<JobHandle> main_jobs;
+    std::mutex main_mutex;
+    std::thread::id main_thread;
+};
+
+}
@@ -0,0 +1,59 @@
+#include "circle_meshes.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace hop {
+
+CircleMeshes::CircleMeshes(Device& device){
+    std::vector<std::vector<ObjectModel::Vertex>> meshes(LEVELS);
+    for(int level = 0; level < LEVELS; level++){
+        int sides = get_sides(level);
+        std::vector<ObjectModel::Vertex>& vertices = meshes[level];
+        vertices.reserve(sides * 3);
+
+        /* y is flipped like the rest of the engine's shapes, so circles keep their winding */
+        glm::vec2 first(1.0f, 0.0f);
+        glm::vec2 previous = first;
+        for(int i = 1; i <= sides; i++){
+            float theta = glm::two_pi<float>() * i / sides;
+            glm::vec2 next = i == sides ? first : glm::vec2(glm::cos(theta), -glm::sin(theta));
+            vertices.push_back({previous});
+            vertices.push_back({next});
+            vertices.push_back({glm::vec2(0.0f)});
+            previous = next;
+        }
+
+        /* An edge spanning 2pi/sides dips r(1 - cos(pi/sides)) inside the circle */
+        max_radius[level] = MAX_ERROR / (1.0f - glm::cos(glm::pi<float>() / sides));
+    }
+
+    auto batch = ObjectModel::create_batch(device, meshes);
+    for(int level = 0; level < LEVELS; level++){
+        models[level] = std::move(batch[level]);
+    }
+}
+
+const std::shared_ptr<ObjectModel>& CircleMeshes::select(float radius, float node_scale) const {
+    float on_screen = radius * std::abs(node_scale) * zoom;
+    for(int level = 0; level < LEVELS - 1; level++){
+        if(on_screen <= max_radius[level]){
+            return models[level];
+        }
+    }
+    return models[LEVELS - 1];
+}
+
+int CircleMeshes::get_level(const ObjectModel* model) const {
+    for(int level = 0; level < LEVELS; level++){
+        if(models[level].get() == model){
+            return level;
+        }
+    }
+    return -1;
+}
+
+}
@@ -0,0 +1,88 @@
+/**
+ * @file circle_meshes.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Unit circle meshes at a few levels of detail, shared by every circle
+ *
+ */
+
+#pragma once
+
+#include "object.hpp"
+
+#include <memory>
+
+namespace hop {
+
+/**
+ * @brief Precomputed unit circles, from coarse to fine
+ *
+ * Every level is a triangle fan around (0, 0) with radius 1, all of them in
+ * one vertex buffer. Circles don't get a mesh of their own, they use the
+ * level that fits their size on screen and are scaled to their radius.
+ *
+ * The size on screen is the radius times the scale of the circle's node
+ * times the camera zoom, the engine picks every circle's level again when
+ * the zoom changes.
+ *
+ * A level is good enough for a radius while the middle of its edges is at
+ * most MAX_ERROR pixels inside the real circle, so small circles get few
+ * triangles and big ones stay round.
+ */
+class CircleMeshes {
+public:
+    static constexpr int LEVELS = 6;
+    static constexpr int MIN_SIDES = 8;
+    static constexpr float MAX_ERROR = 0.5f;
+
+    /**
+     * @brief Constructor
+     *
+     * Builds and uploads every level.
+     *
+     * @param device
+     */
+    CircleMeshes(Device& device);
+
+    // Prevents copying of this object
+    CircleMeshes(const CircleMeshes&) = delete;
+    CircleMeshes& operator=(const CircleMeshes&) = delete;
+
+    /**
+     * @brief Picks the level for a circle
+     * @param radius Radius of the circle, in pixels
+     * @param node_scale Scale of the node the circle is attached to
+     * @return The coarsest level that is round enough at the current zoom,
+     *         the finest if none is
+     */
+    const std::shared_ptr<ObjectModel>& select(float radius, float node_scale = 1.0f) const;
+
+    /**
+     * @brief Finds which level a mesh is
+     * @param model The mesh
+     * @return The level, -1 if the mesh isn't one of the circles
+     */
+    int get_level(const ObjectModel* model) const;
+
+    /**
+     * @brief Sets the camera zoom circles are seen at
+     * @param new_zoom The zoom, see Camera::set_zoom
+     */
+    void set_zoom(float new_zoom){ zoom = new_zoom; }
+    float get_zoom() const { return zoom; }
+
+    /**
+     * @brief Amount of sides a level has
+     * @param level From 0, the coarsest, to LEVELS - 1
+     * @return The sides
+     */
+    static int get_sides(int level){ return MIN_SIDES << level; }
+
+private:
+    std::shared_ptr<ObjectModel> models[LEVELS];
+    float max_radius[LEVELS];
+    float zoom = 1.0f;
+};
+
+}
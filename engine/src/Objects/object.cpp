@@ -1,6 +1,6 @@
 #include "object.hpp"
 
-#include <cstring>
+#include <cassert>
 
 namespace hop {
 
@@ -16,7 +16,7 @@ std::vector<VkVertexInputAttributeDescription> ObjectModel::Vertex::get_attribut
     std::vector<VkVertexInputAttributeDescription> attribute_descriptions(2);
     attribute_descriptions[0].binding = 0;
     attribute_descriptions[0].location = 0;
-    attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attribute_descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
     attribute_descriptions[0].offset = offsetof(Vertex, position);
 
     attribute_descriptions[1].binding = 0;
@@ -26,43 +26,79 @@ std::vector<VkVertexInputAttributeDescription> ObjectModel::Vertex::get_attribut
     return attribute_descriptions;
 }
 
-ObjectModel::ObjectModel(Device& device, const std::vector<Vertex>& vertices) : device{device} {
-    create_vertex_buffers(vertices);
+VertexBuffer::VertexBuffer(Device& device, const void* data, VkDeviceSize size) : device{device} {
+    create(size);
+    device.upload_buffer_async(data, size, buffer);
 }
 
-ObjectModel::~ObjectModel(){
-    vkDestroyBuffer(device.get_device(), vertex_buffer, nullptr);
-    vkFreeMemory(device.get_device(), vertex_buffer_memory, nullptr);
+VertexBuffer::VertexBuffer(Device& device, VkDeviceSize size) : device{device} {
+    create(size);
 }
 
-void ObjectModel::bind(VkCommandBuffer command_buffer){
-    VkBuffer buffer[] = { vertex_buffer };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(command_buffer, 0, 1, buffer, offsets);
+void VertexBuffer::create(VkDeviceSize size){
+    /* Device local memory is fastest for the GPU to read, it's filled through a staging buffer */
+    device.create_buffer(
+        size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        buffer,
+        memory
+    );
 }
 
-void ObjectModel::draw(VkCommandBuffer command_buffer){
-    vkCmdDraw(command_buffer, vertex_count, 1, 0, 0);
+void VertexBuffer::write(const void* data, VkDeviceSize size, VkDeviceSize offset){
+    device.upload_buffer_async(data, size, buffer, offset);
 }
 
-void ObjectModel::create_vertex_buffers(const std::vector<Vertex>& vertices){
+VertexBuffer::~VertexBuffer(){
+    vkDestroyBuffer(device.get_device(), buffer, nullptr);
+    vkFreeMemory(device.get_device(), memory, nullptr);
+}
+
+ObjectModel::ObjectModel(Device& device, const std::vector<Vertex>& vertices) : vertices{vertices} {
     vertex_count = static_cast<uint32_t>(vertices.size());
     assert(vertex_count >= 3);
-    
-    VkDeviceSize buffer_size = sizeof(vertices[0]) * vertex_count;
-    
-    device.create_buffer(
-        buffer_size,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        vertex_buffer,
-        vertex_buffer_memory
-    );
+    vertex_buffer = std::make_shared<VertexBuffer>(device, vertices.data(), sizeof(vertices[0]) * vertex_count);
+    compute_bounds();
+}
+
+std::vector<std::shared_ptr<ObjectModel>> ObjectModel::create_batch(Device& device, const std::vector<std::vector<Vertex>>& meshes){
+    std::vector<std::shared_ptr<ObjectModel>> models;
+    if(meshes.empty()){
+        return models;
+    }
 
-    void* data;
-    vkMapMemory(device.get_device(), vertex_buffer_memory, 0, buffer_size, 0, &data);
-    memcpy(data, vertices.data(), static_cast<size_t>(buffer_size));
-    vkUnmapMemory(device.get_device(), vertex_buffer_memory);
+    size_t total = 0;
+    for(const auto& mesh : meshes){
+        total += mesh.size();
+    }
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(total);
+    for(const auto& mesh : meshes){
+        vertices.insert(vertices.end(), mesh.begin(), mesh.end());
+    }
+
+    auto buffer = std::make_shared<VertexBuffer>(device, vertices.data(), sizeof(Vertex) * vertices.size());
+
+    models.reserve(meshes.size());
+    uint32_t first = 0;
+    for(const auto& mesh : meshes){
+        uint32_t count = static_cast<uint32_t>(mesh.size());
+        models.push_back(std::make_shared<ObjectModel>(buffer, first, mesh));
+        first += count;
+    }
+    return models;
+}
+
+void ObjectModel::bind(VkCommandBuffer command_buffer){
+    VkBuffer buffer[] = { vertex_buffer->get_buffer() };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, buffer, offsets);
+}
+
+void ObjectModel::draw(VkCommandBuffer command_buffer){
+    vkCmdDraw(command_buffer, vertex_count, 1, first_vertex, 0);
 }
 
 }
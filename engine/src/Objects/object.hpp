@@ -18,10 +18,71 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cassert>
 #include <memory>
+#include <vector>
 
 namespace hop {
 
+/**
+ * @brief Device local vertex buffer
+ *
+ * Owns the vulkan buffer and memory vertices are stored in. A single vertex
+ * buffer can hold the vertices of many models, see ObjectModel::create_batch.
+ *
+ */
+class VertexBuffer {
+public:
+    /**
+     * @brief Constructor
+     *
+     * Creates the buffer and starts uploading data into it. The buffer can be
+     * drawn from straight away, see Device::upload_buffer_async.
+     *
+     * @param device
+     * @param data Vertex data to upload
+     * @param size Size of data in bytes
+     */
+    VertexBuffer(Device& device, const void* data, VkDeviceSize size);
+
+    /**
+     * @brief Constructor for an empty buffer, filled later with write
+     * @param device
+     * @param size Size of the buffer in bytes
+     */
+    VertexBuffer(Device& device, VkDeviceSize size);
+
+    /**
+     * @brief Default Deconstructor
+     */
+    ~VertexBuffer();
+
+    // Prevents copying of this object
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+    /**
+     * @brief Starts uploading data into part of the buffer
+     *
+     * NOTE: No frame in flight may be drawing from that part
+     *
+     * @param data Vertex data to upload
+     * @param size Size of data in bytes
+     * @param offset Where in the buffer to put it, in bytes
+     * @return void
+     */
+    void write(const void* data, VkDeviceSize size, VkDeviceSize offset);
+
+    VkBuffer get_buffer() const { return buffer; }
+
+private:
+    void create(VkDeviceSize size);
+
+    Device& device;
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+};
+
 /**
  * @brief Model for an object
  *
@@ -39,7 +100,7 @@ public:
      */
     struct Vertex {
         glm::vec2 position = {};
-        glm::vec3 color = {};
+        glm::vec3 color = { 1.0f, 1.0f, 1.0f };
 
         static std::vector<VkVertexInputBindingDescription> get_binding_descriptions();
         static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
@@ -55,11 +116,30 @@ public:
      * @param vertices
      */
     ObjectModel(Device& device, const std::vector<Vertex>& vertices);
-    
+
     /**
-     * @brief Default Deconstructor
+     * @brief Constructor for a model inside a shared vertex buffer
+     * @param buffer Buffer holding the vertices
+     * @param first_vertex Index of the model's first vertex in the buffer
+     * @param vertices The model's vertices, as they are stored in the buffer
+     *
+     * NOTE: Doesn't touch the device, buffer can be nullptr for a model that
+     *       is only looked at on the CPU
      */
-    ~ObjectModel();
+    ObjectModel(std::shared_ptr<VertexBuffer> buffer, uint32_t first_vertex, std::vector<Vertex> vertices);
+
+    /**
+     * @brief Creates many models at once
+     *
+     * All the meshes are packed into one vertex buffer, so creating them costs
+     * a single allocation and a single upload no matter how many there are.
+     * The buffer is freed once every model using it is gone.
+     *
+     * @param device
+     * @param meshes Vertices of each model
+     * @return One model per mesh, in the same order
+     */
+    static std::vector<std::shared_ptr<ObjectModel>> create_batch(Device& device, const std::vector<std::vector<Vertex>>& meshes);
 
     // Prevents copying of this object
     ObjectModel(const ObjectModel&) = delete;
@@ -87,57 +167,51 @@ public:
      */
     void draw(VkCommandBuffer command_buffer);
 
-private:
-    void create_vertex_buffers(const std::vector<Vertex>& vertices);
-
-    Device& device;
-    VkBuffer vertex_buffer;
-    VkDeviceMemory vertex_buffer_memory;
-    uint32_t vertex_count;
-};
+    VkBuffer get_buffer() const { return vertex_buffer->get_buffer(); }
+    uint32_t get_first_vertex() const { return first_vertex; }
+    uint32_t get_vertex_count() const { return vertex_count; }
 
-/**
- * @brief Transform struct
- *
- * Struct definition of a object that holds the transform data of an object.
- * This can store where an object should be stored and how big it is
- *
- */
-struct Transform {
-    glm::vec2 translation = {};
-    glm::vec2 scale = { 1.0f, 1.0f };
-
-    glm::mat2 mat2(){
-        return {
-            { scale.x, 0.0f },
-            { 0.0f, scale.y }
-        };
-    }
-};
-
-/**
- * @brief Class for objects 
- *
- * Holds the data of a object's model and where it should be on the screen.
- * This class is an abstraction from ObjectModel
- *
- */
-class Object {
-public:
     /**
-     * @brief Default Constructor
+     * @brief CPU copy of the model's vertices
+     *
+     * Kept so models can be merged into new meshes, see Engine::bake
+     *
+     * @return The vertices of this model
      */
-    Object(){}
+    const std::vector<Vertex>& get_vertices() const { return vertices; }
 
-    // Prevents copying and moving of this object
-    Object(const Object&) = delete;
-    Object& operator=(Object&) = delete;
-    Object(Object&&) = default;
-    Object& operator=(Object&&) = default;    
+    /**
+     * @brief Corners of the box around every vertex
+     * @return Smallest and largest vertex position
+     */
+    glm::vec2 get_bounds_min() const { return bounds_min; }
+    glm::vec2 get_bounds_max() const { return bounds_max; }
 
-    std::shared_ptr<ObjectModel> model = {};
-    glm::vec3 color = {};
-    Transform transform = {};
+private:
+    void compute_bounds();
+
+    std::shared_ptr<VertexBuffer> vertex_buffer;
+    std::vector<Vertex> vertices;
+    uint32_t first_vertex = 0;
+    uint32_t vertex_count = 0;
+    glm::vec2 bounds_min = glm::vec2(0.0f);
+    glm::vec2 bounds_max = glm::vec2(0.0f);
 };
 
+/* Defined here so models can be made without linking the Vulkan side of the engine */
+inline ObjectModel::ObjectModel(std::shared_ptr<VertexBuffer> buffer, uint32_t first_vertex, std::vector<Vertex> vertices) : vertex_buffer{buffer}, vertices{std::move(vertices)}, first_vertex{first_vertex} {
+    vertex_count = static_cast<uint32_t>(this->vertices.size());
+    assert(vertex_count >= 3);
+    compute_bounds();
+}
+
+inline void ObjectModel::compute_bounds(){
+    bounds_min = vertices[0].position;
+    bounds_max = vertices[0].position;
+    for(const auto& v : vertices){
+        bounds_min = glm::min(bounds_min, v.position);
+        bounds_max = glm::max(bounds_max, v.position);
+    }
+}
+
 }
@@ -0,0 +1,527 @@
+#include "physics_world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace hop {
+
+/* Slower approaches than this don't bounce, so resting bodies settle */
+static constexpr float BOUNCE_THRESHOLD = 30.0f;
+/* Overlap left alone so touching bodies keep touching from step to step */
+static constexpr float PENETRATION_SLOP = 0.5f;
+/* Fraction of the remaining overlap removed each round */
+static constexpr float CORRECTION_PERCENT = 0.6f;
+/* Overlap is cheaper to get rid of than velocity, it needs fewer rounds */
+static constexpr int POSITION_ITERATIONS = 3;
+
+Body PhysicsWorld::add_box(glm::vec2 center, glm::vec2 half_size, BodyType type, const BodyDesc& desc){
+    return add(center, glm::abs(half_size), BodyShape::BOX, type, desc);
+}
+
+Body PhysicsWorld::add_circle(glm::vec2 center, float radius, BodyType type, const BodyDesc& desc){
+    return add(center, glm::vec2(std::abs(radius)), BodyShape::CIRCLE, type, desc);
+}
+
+Body PhysicsWorld::add(glm::vec2 center, glm::vec2 half_size, BodyShape body_shape, BodyType type, const BodyDesc& desc){
+    uint32_t i;
+    if(!free_slots.empty()){
+        i = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        i = static_cast<uint32_t>(live.size());
+        position_x.push_back(0.0f);
+        position_y.push_back(0.0f);
+        velocity_x.push_back(0.0f);
+        velocity_y.push_back(0.0f);
+        force_x.push_back(0.0f);
+        force_y.push_back(0.0f);
+        inverse_mass.push_back(0.0f);
+        gravity_scale.push_back(0.0f);
+        half_x.push_back(0.0f);
+        half_y.push_back(0.0f);
+        restitution.push_back(0.0f);
+        friction.push_back(0.0f);
+        shape.push_back(BodyShape::BOX);
+        sync.emplace_back();
+        pull.emplace_back();
+        sweep_index.push_back(0);
+        generation.push_back(0);
+        live.push_back(0);
+    }
+
+    bool dynamic = type == BodyType::DYNAMIC && desc.mass > 0.0f;
+    position_x[i] = center.x;
+    position_y[i] = center.y;
+    velocity_x[i] = 0.0f;
+    velocity_y[i] = 0.0f;
+    force_x[i] = 0.0f;
+    force_y[i] = 0.0f;
+    inverse_mass[i] = dynamic ? 1.0f / desc.mass : 0.0f;
+    gravity_scale[i] = dynamic ? desc.gravity_scale : 0.0f;
+    half_x[i] = half_size.x;
+    half_y[i] = half_size.y;
+    restitution[i] = desc.restitution;
+    friction[i] = desc.friction;
+    shape[i] = body_shape;
+    live[i] = 1;
+    body_count++;
+    sweep_index[i] = static_cast<uint32_t>(sweep.size());
+    sweep.push_back({0.0f, 0.0f, 0.0f, 0.0f, i, false});
+    resort = true;
+
+    return Body{i | (generation[i] << Body::INDEX_BITS)};
+}
+
+void PhysicsWorld::remove(Body body){
+    uint32_t i = slot(body);
+    if(i == Body::INVALID){
+        return;
+    }
+
+    /* A dead slot has no mass and no velocity, so integrating it does nothing */
+    live[i] = 0;
+    generation[i] = (generation[i] + 1) & Body::GENERATION_MASK;
+    velocity_x[i] = 0.0f;
+    velocity_y[i] = 0.0f;
+    force_x[i] = 0.0f;
+    force_y[i] = 0.0f;
+    inverse_mass[i] = 0.0f;
+    gravity_scale[i] = 0.0f;
+    sync[i] = nullptr;
+    pull[i] = nullptr;
+    free_slots.push_back(i);
+    body_count--;
+
+    /* The last entry fills the gap, the insertion sort of the next step puts it back in place */
+    uint32_t k = sweep_index[i];
+    sweep[k] = sweep.back();
+    sweep_index[sweep[k].body] = k;
+    sweep.pop_back();
+}
+
+bool PhysicsWorld::alive(Body body) const {
+    return slot(body) != Body::INVALID;
+}
+
+uint32_t PhysicsWorld::slot(Body body) const {
+    uint32_t i = body.index();
+    if(body.id == Body::INVALID || i >= live.size() || !live[i] || generation[i] != body.generation()){
+        return Body::INVALID;
+    }
+    return i;
+}
+
+void PhysicsWorld::attach(Body body, SyncCallback sync_callback, PullCallback pull_callback){
+    uint32_t i = slot(body);
+    if(i != Body::INVALID){
+        sync[i] = std::move(sync_callback);
+        pull[i] = std::move(pull_callback);
+    }
+}
+
+void PhysicsWorld::set_position(Body body, glm::vec2 position){
+    uint32_t i = slot(body);
+    if(i != Body::INVALID){
+        position_x[i] = position.x;
+        position_y[i] = position.y;
+    }
+}
+
+glm::vec2 PhysicsWorld::get_position(Body body) const {
+    uint32_t i = slot(body);
+    return i == Body::INVALID ? glm::vec2(0.0f) : glm::vec2(position_x[i], position_y[i]);
+}
+
+void PhysicsWorld::set_velocity(Body body, glm::vec2 velocity){
+    uint32_t i = slot(body);
+    if(i != Body::INVALID && inverse_mass[i] > 0.0f){
+        velocity_x[i] = velocity.x;
+        velocity_y[i] = velocity.y;
+    }
+}
+
+glm::vec2 PhysicsWorld::get_velocity(Body body) const {
+    uint32_t i = slot(body);
+    return i == Body::INVALID ? glm::vec2(0.0f) : glm::vec2(velocity_x[i], velocity_y[i]);
+}
+
+void PhysicsWorld::apply_impulse(Body body, glm::vec2 impulse){
+    uint32_t i = slot(body);
+    if(i != Body::INVALID){
+        velocity_x[i] += impulse.x * inverse_mass[i];
+        velocity_y[i] += impulse.y * inverse_mass[i];
+    }
+}
+
+void PhysicsWorld::apply_force(Body body, glm::vec2 force){
+    uint32_t i = slot(body);
+    if(i != Body::INVALID){
+        force_x[i] += force.x;
+        force_y[i] += force.y;
+    }
+}
+
+void PhysicsWorld::step(float delta_time){
+    auto start = std::chrono::steady_clock::now();
+    pull_bodies();
+    stats = PhysicsStats{};
+    stats.bodies = static_cast<uint32_t>(body_count);
+    constraints.clear();
+    contacts.clear();
+
+    if(delta_time > 0.0f){
+        integrate_velocities(delta_time);
+        find_pairs();
+        solve();
+        integrate_positions(delta_time);
+        correct_positions();
+        sync_bodies();
+    }
+
+    stats.contacts = static_cast<uint32_t>(contacts.size());
+    stats.step_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PhysicsWorld::integrate_velocities(float delta_time){
+    size_t count = live.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128 dt = _mm_set1_ps(delta_time);
+    __m128 gx = _mm_set1_ps(gravity.x);
+    __m128 gy = _mm_set1_ps(gravity.y);
+    for(; i + 4 <= count; i += 4){
+        __m128 scale = _mm_loadu_ps(&gravity_scale[i]);
+        __m128 mass = _mm_loadu_ps(&inverse_mass[i]);
+        __m128 ax = _mm_add_ps(_mm_mul_ps(gx, scale), _mm_mul_ps(_mm_loadu_ps(&force_x[i]), mass));
+        __m128 ay = _mm_add_ps(_mm_mul_ps(gy, scale), _mm_mul_ps(_mm_loadu_ps(&force_y[i]), mass));
+        _mm_storeu_ps(&velocity_x[i], _mm_add_ps(_mm_loadu_ps(&velocity_x[i]), _mm_mul_ps(ax, dt)));
+        _mm_storeu_ps(&velocity_y[i], _mm_add_ps(_mm_loadu_ps(&velocity_y[i]), _mm_mul_ps(ay, dt)));
+    }
+#endif
+    for(; i < count; i++){
+        velocity_x[i] += (gravity.x * gravity_scale[i] + force_x[i] * inverse_mass[i]) * delta_time;
+        velocity_y[i] += (gravity.y * gravity_scale[i] + force_y[i] * inverse_mass[i]) * delta_time;
+    }
+
+    std::fill(force_x.begin(), force_x.end(), 0.0f);
+    std::fill(force_y.begin(), force_y.end(), 0.0f);
+}
+
+void PhysicsWorld::integrate_positions(float delta_time){
+    size_t count = live.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128 dt = _mm_set1_ps(delta_time);
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_ps(&position_x[i], _mm_add_ps(_mm_loadu_ps(&position_x[i]), _mm_mul_ps(_mm_loadu_ps(&velocity_x[i]), dt)));
+        _mm_storeu_ps(&position_y[i], _mm_add_ps(_mm_loadu_ps(&position_y[i]), _mm_mul_ps(_mm_loadu_ps(&velocity_y[i]), dt)));
+    }
+#endif
+    for(; i < count; i++){
+        position_x[i] += velocity_x[i] * delta_time;
+        position_y[i] += velocity_y[i] * delta_time;
+    }
+}
+
+void PhysicsWorld::find_pairs(){
+    if(sweep.empty()){
+        return;
+    }
+
+    /* Sweep along whichever axis the bodies are more spread out on, fewer bounds overlap there */
+    float mean_x = 0.0f, mean_y = 0.0f;
+    for(const SweepEntry& e : sweep){
+        mean_x += position_x[e.body];
+        mean_y += position_y[e.body];
+    }
+    mean_x /= sweep.size();
+    mean_y /= sweep.size();
+    float spread_x = 0.0f, spread_y = 0.0f;
+    for(const SweepEntry& e : sweep){
+        spread_x += (position_x[e.body] - mean_x) * (position_x[e.body] - mean_x);
+        spread_y += (position_y[e.body] - mean_y) * (position_y[e.body] - mean_y);
+    }
+    int axis = spread_x >= spread_y ? 0 : 1;
+
+    const std::vector<float>& position = axis == 0 ? position_x : position_y;
+    const std::vector<float>& half = axis == 0 ? half_x : half_y;
+    const std::vector<float>& other_position = axis == 0 ? position_y : position_x;
+    const std::vector<float>& other_half = axis == 0 ? half_y : half_x;
+
+    /* Bounds are copied next to each other in sweep order, so the sweep below reads memory in order */
+    auto copy_bounds = [&](size_t begin, size_t end){
+        for(size_t k = begin; k < end; k++){
+            SweepEntry& e = sweep[k];
+            e.min = position[e.body] - half[e.body];
+            e.max = position[e.body] + half[e.body];
+            e.other_min = other_position[e.body] - other_half[e.body];
+            e.other_max = other_position[e.body] + other_half[e.body];
+            e.dynamic = inverse_mass[e.body] > 0.0f;
+        }
+    };
+    if(jobs != nullptr){
+        jobs->parallel_for(sweep.size(), PAIR_GRAIN, copy_bounds);
+    } else {
+        copy_bounds(0, sweep.size());
+    }
+
+    /* Last step's order is nearly sorted already, unless bodies were added or the axis changed */
+    if(sweep_axis != axis || resort){
+        std::sort(sweep.begin(), sweep.end(), [](const SweepEntry& a, const SweepEntry& b){ return a.min < b.min; });
+        sweep_axis = axis;
+        resort = false;
+    }
+    for(size_t i = 1; i < sweep.size(); i++){
+        SweepEntry entry = sweep[i];
+        size_t j = i;
+        while(j > 0 && sweep[j - 1].min > entry.min){
+            sweep[j] = sweep[j - 1];
+            j--;
+        }
+        sweep[j] = entry;
+    }
+    for(size_t i = 0; i < sweep.size(); i++){
+        sweep_index[sweep[i].body] = static_cast<uint32_t>(i);
+    }
+
+    /* Chunks only write their own contacts, joining them in chunk order keeps the solver deterministic */
+    size_t chunk_count = (sweep.size() + PAIR_GRAIN - 1) / PAIR_GRAIN;
+    if(pair_chunks.size() < chunk_count){
+        pair_chunks.resize(chunk_count);
+    }
+    auto sweep_chunk = [this](size_t begin, size_t end){
+        sweep_pairs(begin, end, pair_chunks[begin / PAIR_GRAIN]);
+    };
+    if(jobs != nullptr){
+        jobs->parallel_for(sweep.size(), PAIR_GRAIN, sweep_chunk);
+    } else {
+        for(size_t begin = 0; begin < sweep.size(); begin += PAIR_GRAIN){
+            sweep_chunk(begin, std::min(sweep.size(), begin + PAIR_GRAIN));
+        }
+    }
+
+    for(size_t c = 0; c < chunk_count; c++){
+        PairChunk& chunk = pair_chunks[c];
+        stats.candidate_pairs += chunk.candidate_pairs;
+        for(const Constraint& constraint : chunk.constraints){
+            constraints.push_back(constraint);
+            contacts.push_back({
+                Body{constraint.a | (generation[constraint.a] << Body::INDEX_BITS)},
+                Body{constraint.b | (generation[constraint.b] << Body::INDEX_BITS)},
+                constraint.normal,
+                constraint.depth
+            });
+        }
+    }
+}
+
+void PhysicsWorld::sweep_pairs(size_t begin, size_t end, PairChunk& chunk) const {
+    chunk.constraints.clear();
+    chunk.candidate_pairs = 0;
+
+    /* Bodies of later chunks are still read, a pair belongs to the chunk of its lower body */
+    Constraint c;
+    for(size_t i = begin; i < end; i++){
+        const SweepEntry& a = sweep[i];
+        for(size_t j = i + 1; j < sweep.size(); j++){
+            const SweepEntry& b = sweep[j];
+            if(b.min > a.max){
+                break;
+            }
+            if(!(a.dynamic || b.dynamic) || b.other_min > a.other_max || a.other_min > b.other_max){
+                continue;
+            }
+            chunk.candidate_pairs++;
+            if(collide(a.body, b.body, c)){
+                chunk.constraints.push_back(c);
+            }
+        }
+    }
+}
+
+/* Box at the origin against a circle, normal points from the box to the circle */
+static bool box_circle(glm::vec2 half, glm::vec2 center, float radius, glm::vec2& normal, float& depth){
+    glm::vec2 closest = glm::clamp(center, -half, half);
+    if(closest == center){
+        /* The center is inside the box, push out through the nearest side */
+        glm::vec2 inside = half - glm::abs(center);
+        if(inside.x < inside.y){
+            normal = glm::vec2(center.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            depth = inside.x + radius;
+        } else {
+            normal = glm::vec2(0.0f, center.y < 0.0f ? -1.0f : 1.0f);
+            depth = inside.y + radius;
+        }
+        return true;
+    }
+
+    glm::vec2 d = center - closest;
+    float distance_squared = glm::dot(d, d);
+    if(distance_squared >= radius * radius){
+        return false;
+    }
+    float distance = std::sqrt(distance_squared);
+    normal = d / distance;
+    depth = radius - distance;
+    return true;
+}
+
+bool PhysicsWorld::collide(uint32_t a, uint32_t b, Constraint& c) const {
+    glm::vec2 d(position_x[b] - position_x[a], position_y[b] - position_y[a]);
+    glm::vec2 normal;
+    float depth;
+
+    if(shape[a] == BodyShape::BOX && shape[b] == BodyShape::BOX){
+        float overlap_x = half_x[a] + half_x[b] - std::abs(d.x);
+        float overlap_y = half_y[a] + half_y[b] - std::abs(d.y);
+        if(overlap_x <= 0.0f || overlap_y <= 0.0f){
+            return false;
+        }
+        if(overlap_x < overlap_y){
+            normal = glm::vec2(d.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            depth = overlap_x;
+        } else {
+            normal = glm::vec2(0.0f, d.y < 0.0f ? -1.0f : 1.0f);
+            depth = overlap_y;
+        }
+    } else if(shape[a] == BodyShape::CIRCLE && shape[b] == BodyShape::CIRCLE){
+        float radius = half_x[a] + half_x[b];
+        float distance_squared = glm::dot(d, d);
+        if(distance_squared >= radius * radius){
+            return false;
+        }
+        float distance = std::sqrt(distance_squared);
+        normal = distance > 0.0f ? d / distance : glm::vec2(0.0f, 1.0f);
+        depth = radius - distance;
+    } else if(shape[a] == BodyShape::BOX){
+        if(!box_circle(glm::vec2(half_x[a], half_y[a]), d, half_x[b], normal, depth)){
+            return false;
+        }
+    } else {
+        if(!box_circle(glm::vec2(half_x[b], half_y[b]), -d, half_x[a], normal, depth)){
+            return false;
+        }
+        normal = -normal;
+    }
+
+    c.a = a;
+    c.b = b;
+    c.normal = normal;
+    c.depth = depth;
+    c.separation = glm::dot(d, normal);
+    c.inverse_mass_a = inverse_mass[a];
+    c.inverse_mass_b = inverse_mass[b];
+    c.mass = 1.0f / (inverse_mass[a] + inverse_mass[b]);
+    c.friction = std::sqrt(friction[a] * friction[b]);
+    c.normal_impulse = 0.0f;
+    c.tangent_impulse = 0.0f;
+
+    /* Aim for the bounce velocity from the approach speed before solving */
+    float approach = (velocity_x[b] - velocity_x[a]) * normal.x + (velocity_y[b] - velocity_y[a]) * normal.y;
+    c.bounce = approach < -BOUNCE_THRESHOLD ? -std::max(restitution[a], restitution[b]) * approach : 0.0f;
+    return true;
+}
+
+void PhysicsWorld::solve(){
+    /* Contacts jump between bodies, keep both components of a velocity on one cache line */
+    solver_velocity.resize(live.size());
+    for(const SweepEntry& e : sweep){
+        uint32_t i = e.body;
+        solver_velocity[i] = glm::vec2(velocity_x[i], velocity_y[i]);
+    }
+
+    for(int round = 0; round < iterations; round++){
+        for(Constraint& c : constraints){
+            glm::vec2& va = solver_velocity[c.a];
+            glm::vec2& vb = solver_velocity[c.b];
+            glm::vec2 tangent(-c.normal.y, c.normal.x);
+
+            /* Total impulse can only push, never pull the bodies together */
+            float impulse = c.mass * (c.bounce - glm::dot(vb - va, c.normal));
+            float total = std::max(c.normal_impulse + impulse, 0.0f);
+            impulse = total - c.normal_impulse;
+            c.normal_impulse = total;
+            va -= c.normal * (impulse * c.inverse_mass_a);
+            vb += c.normal * (impulse * c.inverse_mass_b);
+
+            /* Friction is limited by how hard the bodies press together */
+            float tangent_impulse = -c.mass * glm::dot(vb - va, tangent);
+            float limit = c.friction * c.normal_impulse;
+            float tangent_total = glm::clamp(c.tangent_impulse + tangent_impulse, -limit, limit);
+            tangent_impulse = tangent_total - c.tangent_impulse;
+            c.tangent_impulse = tangent_total;
+            va -= tangent * (tangent_impulse * c.inverse_mass_a);
+            vb += tangent * (tangent_impulse * c.inverse_mass_b);
+        }
+    }
+
+    for(const SweepEntry& e : sweep){
+        uint32_t i = e.body;
+        velocity_x[i] = solver_velocity[i].x;
+        velocity_y[i] = solver_velocity[i].y;
+    }
+}
+
+void PhysicsWorld::correct_positions(){
+    solver_position.resize(live.size());
+    for(const SweepEntry& e : sweep){
+        uint32_t i = e.body;
+        solver_position[i] = glm::vec2(position_x[i], position_y[i]);
+    }
+
+    /*
+     * Pushing one pair apart can push a body into another, so this runs a few
+     * rounds too. The overlap left is what the contact started with minus how
+     * far the bodies have moved apart along the normal since.
+     */
+    for(int round = 0; round < POSITION_ITERATIONS; round++){
+        for(const Constraint& c : constraints){
+            glm::vec2& pa = solver_position[c.a];
+            glm::vec2& pb = solver_position[c.b];
+            float depth = c.depth - (glm::dot(pb - pa, c.normal) - c.separation);
+            if(depth <= PENETRATION_SLOP){
+                continue;
+            }
+
+            glm::vec2 correction = c.normal * ((depth - PENETRATION_SLOP) * CORRECTION_PERCENT * c.mass);
+            pa -= correction * c.inverse_mass_a;
+            pb += correction * c.inverse_mass_b;
+        }
+    }
+
+    for(const SweepEntry& e : sweep){
+        uint32_t i = e.body;
+        position_x[i] = solver_position[i].x;
+        position_y[i] = solver_position[i].y;
+    }
+}
+
+void PhysicsWorld::pull_bodies(){
+    for(uint32_t i = 0; i < live.size(); i++){
+        if(!live[i] || pull[i] == nullptr){
+            continue;
+        }
+        glm::vec2 position(position_x[i], position_y[i]);
+        if(!pull[i](position)){
+            remove(Body{i | (generation[i] << Body::INDEX_BITS)});
+            continue;
+        }
+        position_x[i] = position.x;
+        position_y[i] = position.y;
+    }
+}
+
+void PhysicsWorld::sync_bodies(){
+    for(size_t i = 0; i < live.size(); i++){
+        if(sync[i] != nullptr && inverse_mass[i] > 0.0f){
+            sync[i](glm::vec2(position_x[i], position_y[i]));
+        }
+    }
+}
+
+}
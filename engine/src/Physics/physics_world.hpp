@@ -0,0 +1,339 @@
+/**
+ * @file physics_world.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * 2D rigid body physics for boxes and circles that tells whatever follows a
+ * body where it moved
+ *
+ */
+
+#pragma once
+
+#include "Jobs/job_system.hpp"
+#include "Timing/frame_stats.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Handle to a body in a PhysicsWorld
+ *
+ * Same layout as Entity, a slot index in the low 20 bits and the generation
+ * of that slot in the high 12 bits, so handles to removed bodies stop being
+ * alive.
+ */
+struct Body {
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    uint32_t id = INVALID;
+
+    uint32_t index() const { return id & INDEX_MASK; }
+    uint32_t generation() const { return id >> INDEX_BITS; }
+
+    bool operator==(const Body& b) const { return id == b.id; }
+    bool operator!=(const Body& b) const { return id != b.id; }
+};
+
+enum class BodyShape : uint8_t {
+    BOX,
+    CIRCLE
+};
+
+/**
+ * @brief How a body reacts to the world
+ *
+ * STATIC bodies never move, they are walls and floors. DYNAMIC bodies fall,
+ * collide and get pushed around.
+ */
+enum class BodyType : uint8_t {
+    STATIC,
+    DYNAMIC
+};
+
+/**
+ * @brief Material of a body
+ *
+ * Restitution is how bouncy a body is, 0 doesn't bounce and 1 bounces back
+ * at full speed. Two bodies touching use the larger restitution of the two.
+ * Friction slows bodies sliding along each other.
+ */
+struct BodyDesc {
+    float mass = 1.0f;
+    float restitution = 0.2f;
+    float friction = 0.3f;
+    float gravity_scale = 1.0f;
+};
+
+/**
+ * @brief Two bodies that touched in the last step
+ *
+ * The normal points from a to b.
+ */
+struct Contact {
+    Body a;
+    Body b;
+    glm::vec2 normal;
+    float depth;
+};
+
+/**
+ * @brief Simulates boxes and circles in pixel space
+ *
+ * Bodies are axis aligned and don't rotate. Every property is its own
+ * column indexed by Body::index(), so integrating velocities and positions
+ * walks plain float arrays four bodies at a time with SSE where available.
+ * Slots of removed bodies stay in the columns with no mass and no velocity,
+ * which integrates to nothing, so the loops don't need to skip them.
+ *
+ * The world knows nothing about game objects, whatever follows a body is
+ * told where it went through a sync callback and asked where it is through
+ * a pull callback, see attach.
+ *
+ * A step:
+ *  0. Calls the pull callback of every body, removing the ones whose
+ *     follower is gone
+ *  1. Adds gravity and the forces applied since the last step to velocities
+ *  2. Sorts bodies by their bounds along the axis they are most spread out
+ *     on and sweeps the sorted list, only bodies whose bounds overlap on
+ *     both axes are tested for contact. The order barely changes between
+ *     steps, so the insertion sort is close to linear. The sweep and the
+ *     contact tests are split over the job system, each chunk of the sorted
+ *     list keeps its contacts and they are joined in list order, so the
+ *     result doesn't depend on the thread count.
+ *  3. Solves the contacts with a few rounds of impulses
+ *  4. Moves bodies by their velocities and pushes overlapping bodies apart
+ *  5. Calls the sync callback of every dynamic body
+ *
+ * Positions are in the same pixels as game objects, with y going up.
+ */
+class PhysicsWorld {
+public:
+    static constexpr int DEFAULT_ITERATIONS = 6;
+
+    /* Sorted bodies handed to a job at a time when looking for contacts */
+    static constexpr size_t PAIR_GRAIN = 256;
+
+    /**
+     * @brief Tells something following a body where the body is
+     *
+     * Called with the center of the body in pixels after every step.
+     */
+    using SyncCallback = std::function<void(glm::vec2 position)>;
+
+    /**
+     * @brief Asks something following a body where it is
+     *
+     * Called with the center of the body in pixels before every step. The
+     * follower moves position to where it was put since it was last synced,
+     * if it was moved by something else.
+     *
+     * Returns false once the follower is gone, the body is then removed.
+     */
+    using PullCallback = std::function<bool(glm::vec2& position)>;
+
+    /**
+     * @brief Constructor
+     * @param jobs Job system contacts are found on, nullptr finds them on
+     *             the calling thread
+     */
+    explicit PhysicsWorld(JobSystem* jobs = nullptr) : jobs{jobs} {}
+
+    /**
+     * @brief Adds a box
+     *
+     * @param center Center of the box in pixels
+     * @param half_size Half the width and height of the box
+     * @param type Whether the box moves
+     * @param desc Material of the box, mass is ignored for static boxes
+     * @return Handle to the body
+     */
+    Body add_box(glm::vec2 center, glm::vec2 half_size, BodyType type, const BodyDesc& desc = {});
+
+    /**
+     * @brief Adds a circle
+     *
+     * @param center Center of the circle in pixels
+     * @param radius Radius of the circle
+     * @param type Whether the circle moves
+     * @param desc Material of the circle, mass is ignored for static circles
+     * @return Handle to the body
+     */
+    Body add_circle(glm::vec2 center, float radius, BodyType type, const BodyDesc& desc = {});
+
+    /**
+     * @brief Removes a body
+     *
+     * Whatever followed it stays where it is. The body's slot is reused by
+     * the next body added.
+     *
+     * @param body Body to remove, nothing happens if it's not alive
+     * @return void
+     */
+    void remove(Body body);
+    bool alive(Body body) const;
+
+    /**
+     * @brief Sets what follows a body
+     *
+     * Only dynamic bodies are synced, static ones never move. Every body is
+     * pulled, so moving what follows a static body moves the body too.
+     *
+     * @param body Body to follow
+     * @param sync Called after every step, kept until the body is removed
+     * @param pull Called before every step, nullptr if the follower only
+     *             ever moves with the body
+     * @return void
+     */
+    void attach(Body body, SyncCallback sync, PullCallback pull = nullptr);
+
+    void set_position(Body body, glm::vec2 position);
+    glm::vec2 get_position(Body body) const;
+    void set_velocity(Body body, glm::vec2 velocity);
+    glm::vec2 get_velocity(Body body) const;
+
+    /**
+     * @brief Changes a body's velocity right away
+     *
+     * @param body Body to push
+     * @param impulse Mass times the change in velocity
+     * @return void
+     */
+    void apply_impulse(Body body, glm::vec2 impulse);
+
+    /**
+     * @brief Pushes a body during the next step
+     *
+     * Forces are cleared after every step.
+     *
+     * @param body Body to push
+     * @param force Force in pixels per second squared times mass
+     * @return void
+     */
+    void apply_force(Body body, glm::vec2 force);
+
+    /**
+     * @brief Advances the simulation
+     *
+     * Use a fixed delta time, see Game::set_fixed_update, large or changing
+     * steps make stacks jitter.
+     *
+     * @param delta_time Seconds to advance by
+     * @return void
+     */
+    void step(float delta_time);
+
+    /**
+     * @brief Gets the bodies that touched in the last step
+     * @return Contacts of the last step
+     */
+    const std::vector<Contact>& get_contacts() const { return contacts; }
+
+    void set_gravity(glm::vec2 new_gravity){ gravity = new_gravity; }
+    glm::vec2 get_gravity() const { return gravity; }
+    void set_iterations(int count){ iterations = count > 0 ? count : 1; }
+    int get_iterations() const { return iterations; }
+    const PhysicsStats& get_stats() const { return stats; }
+    size_t size() const { return body_count; }
+
+private:
+    /* A contact being solved, the impulses add up over the solver rounds */
+    struct Constraint {
+        uint32_t a;
+        uint32_t b;
+        glm::vec2 normal;
+        float depth;
+        /* Distance between the centers along the normal when the overlap was found */
+        float separation;
+        float inverse_mass_a;
+        float inverse_mass_b;
+        float mass;
+        float bounce;
+        float friction;
+        float normal_impulse;
+        float tangent_impulse;
+    };
+
+    /* Contacts found by one chunk of the sweep */
+    struct PairChunk {
+        std::vector<Constraint> constraints;
+        uint32_t candidate_pairs = 0;
+    };
+
+    /* Bounds of a body on the sweep axis and the other axis */
+    struct SweepEntry {
+        float min;
+        float max;
+        float other_min;
+        float other_max;
+        uint32_t body;
+        bool dynamic;
+    };
+
+    Body add(glm::vec2 center, glm::vec2 half_size, BodyShape shape, BodyType type, const BodyDesc& desc);
+    uint32_t slot(Body body) const;
+    void integrate_velocities(float delta_time);
+    void integrate_positions(float delta_time);
+    void find_pairs();
+    void sweep_pairs(size_t begin, size_t end, PairChunk& chunk) const;
+    bool collide(uint32_t a, uint32_t b, Constraint& c) const;
+    void solve();
+    void correct_positions();
+    void pull_bodies();
+    void sync_bodies();
+
+    JobSystem* jobs;
+
+    /* Columns, one entry per slot */
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> force_x;
+    std::vector<float> force_y;
+    std::vector<float> inverse_mass;
+    std::vector<float> gravity_scale;
+    std::vector<float> half_x;
+    std::vector<float> half_y;
+    std::vector<float> restitution;
+    std::vector<float> friction;
+    std::vector<BodyShape> shape;
+    std::vector<SyncCallback> sync;
+    std::vector<PullCallback> pull;
+
+    std::vector<uint32_t> generation;
+    std::vector<uint8_t> live;
+    std::vector<uint32_t> free_slots;
+    size_t body_count = 0;
+
+    /* Every live body sorted by its lower bound on the sweep axis */
+    std::vector<SweepEntry> sweep;
+    /* Where each slot's body is in sweep, so removing doesn't search */
+    std::vector<uint32_t> sweep_index;
+    std::vector<PairChunk> pair_chunks;
+    int sweep_axis = 0;
+    bool resort = false;
+
+    /* Interleaved copies of velocity and position for the solver */
+    std::vector<glm::vec2> solver_velocity;
+    std::vector<glm::vec2> solver_position;
+
+    std::vector<Constraint> constraints;
+    std::vector<Contact> contacts;
+    glm::vec2 gravity = glm::vec2(0.0f, -980.0f);
+    int iterations = DEFAULT_ITERATIONS;
+    PhysicsStats stats;
+};
+
+}
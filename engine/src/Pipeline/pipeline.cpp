@@ -18,7 +18,22 @@ Pipeline::Pipeline(
     create_graphics_pipeline(config_info);
 }
 
+Pipeline::Pipeline(Device& device, const std::string& comp_filepath, VkPipelineLayout layout) : device{device} {
+    bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+    create_shader_module(comp_filepath, &comp);
+    create_compute_pipeline(layout);
+}
+
 Pipeline::~Pipeline(){
+    if(bind_point == VK_PIPELINE_BIND_POINT_COMPUTE){
+        vkDestroyShaderModule(device.get_device(), comp, nullptr);
+        VK_INFO("destroyed compute shader module");
+
+        vkDestroyPipeline(device.get_device(), pipeline, nullptr);
+        VK_INFO("destroyed compute pipeline");
+        return;
+    }
+
     vkDestroyShaderModule(device.get_device(), vert, nullptr);
     VK_INFO("destroyed vertex shader module");
 
@@ -30,7 +45,7 @@ Pipeline::~Pipeline(){
 }
 
 void Pipeline::bind(VkCommandBuffer command_buffer){
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindPipeline(command_buffer, bind_point, pipeline);
 }
 
 void Pipeline::default_config(PipelineConfigInfo& config_info){
@@ -108,6 +123,9 @@ void Pipeline::default_config(PipelineConfigInfo& config_info){
     config_info.dynamicStateInfo.pDynamicStates = config_info.dynamicStateEnables.data();
     config_info.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(config_info.dynamicStateEnables.size());
     config_info.dynamicStateInfo.flags = 0;
+
+    config_info.bindingDescriptions = ObjectModel::Vertex::get_binding_descriptions();
+    config_info.attributeDescriptions = ObjectModel::Vertex::get_attribute_descriptions();
 }
 
 std::vector<char> Pipeline::read_file(const std::string& fp){
@@ -169,8 +187,8 @@ void Pipeline::create_graphics_pipeline(const PipelineConfigInfo& config_info){
     };
 
     // Define how vertex data will be passed to the vertex shader in a struct
-    auto binding_descriptions = ObjectModel::Vertex::get_binding_descriptions();
-    auto attribute_descriptions = ObjectModel::Vertex::get_attribute_descriptions();
+    const auto& binding_descriptions = config_info.bindingDescriptions;
+    const auto& attribute_descriptions = config_info.attributeDescriptions;
 
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -205,4 +223,26 @@ void Pipeline::create_graphics_pipeline(const PipelineConfigInfo& config_info){
     VK_INFO("Created graphics pipeline!");
 }
 
+void Pipeline::create_compute_pipeline(VkPipelineLayout layout){
+    assert(layout != VK_NULL_HANDLE);
+
+    VkPipelineShaderStageCreateInfo shader_stage{};
+    shader_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shader_stage.module = comp;
+    shader_stage.pName = "main";
+
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage = shader_stage;
+    pipeline_info.layout = layout;
+    pipeline_info.basePipelineIndex = -1;
+    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+
+    if(vkCreateComputePipelines(device.get_device(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS){
+        VK_ERROR("failed to create compute pipeline");
+    }
+    VK_INFO("Created compute pipeline!");
+}
+
 }
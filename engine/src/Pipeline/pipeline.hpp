@@ -3,7 +3,7 @@
  * @author Caleb Burke
  * @date Nov 6, 2023
  *
- * The files creates the graphics pipeline as defined in the vulkan sdk
+ * The files creates the graphics and compute pipelines as defined in the vulkan sdk
  *
  */
 
@@ -38,6 +38,8 @@ struct PipelineConfigInfo {
     VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
     std::vector<VkDynamicState> dynamicStateEnables;
     VkPipelineDynamicStateCreateInfo dynamicStateInfo;
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
     VkPipelineLayout pipelineLayout = nullptr;
     VkRenderPass renderPass = nullptr;
     uint32_t subpass = 0;
@@ -46,10 +48,11 @@ struct PipelineConfigInfo {
 /**
  * @brief Vulkan Pipeline
  *
- * This class creates the graphics pipeline as defined by the vulkan sdk
+ * This class creates the graphics pipeline as defined by the vulkan sdk, or
+ * a compute pipeline running a single compute shader
  *
  * NOTE: Depends on a device to be created
- * NOTE: Depends on a PiplineConfigInfo struct to be filled out
+ * NOTE: Graphics pipelines depend on a PiplineConfigInfo struct to be filled out
  */
 class Pipeline {
 public:
@@ -71,6 +74,17 @@ public:
         const PipelineConfigInfo& config_info
     );
 
+    /**
+     * @brief Constructor
+     *
+     * This creates a compute pipeline
+     *
+     * @param device Reference to the vulkan device
+     * @param comp_filepath File path to the compute shader spv
+     * @param layout Layout of the descriptor sets and push constants the shader uses
+     */
+    Pipeline(Device& device, const std::string& comp_filepath, VkPipelineLayout layout);
+
     /**
      * @brief Default Deconstructor
      * 
@@ -86,8 +100,8 @@ public:
     /**
      * @brief Binds pipeline to a command buffer
      *
-     * Specifics to the command buffer the graphics pipeline it should use while
-     * rendering
+     * Specifics to the command buffer the pipeline it should use while
+     * rendering or dispatching
      *
      * @param command_buffer
      * @return void
@@ -98,7 +112,8 @@ public:
      * @brief Creates the default config for the pipeline
      *
      * This creates the default configuration of the graphics pipeline, this is 
-     * used while initially creating the pipeline.
+     * used while initially creating the pipeline. Vertices are read as
+     * ObjectModel::Vertex.
      *
      * @param config_info
      * @return void
@@ -109,11 +124,14 @@ private:
     static std::vector<char> read_file(const std::string& filepath);
     void create_shader_module(const std::string& filepath, VkShaderModule* shader_module);
     void create_graphics_pipeline(const PipelineConfigInfo& config_info);
+    void create_compute_pipeline(VkPipelineLayout layout);
 
     Device& device;
     VkPipeline pipeline;
-    VkShaderModule vert;
-    VkShaderModule frag;
+    VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    VkShaderModule vert = VK_NULL_HANDLE;
+    VkShaderModule frag = VK_NULL_HANDLE;
+    VkShaderModule comp = VK_NULL_HANDLE;
 };
 
 }
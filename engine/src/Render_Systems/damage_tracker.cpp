@@ -0,0 +1,173 @@
+#include "damage_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hop {
+
+const std::vector<VkRect2D>& DamageTracker::collect(EntityStore& entities, float alpha, VkExtent2D extent){
+    rects.clear();
+    if(view_changed){
+        rects.push_back({{0, 0}, extent});
+        view_changed = false;
+    }
+    bool moved = alpha != drawn_alpha && entities.is_interpolating();
+    if(!first && entities.get_version() == drawn_version && !moved){
+        return rects;
+    }
+
+    const std::vector<uint32_t>& order = entities.get_draw_order();
+    const std::vector<Affine2D>& world = entities.scene.get_world_transforms(alpha);
+    drawn.resize(entities.translation.size());
+    seen.assign(entities.translation.size(), 0);
+
+    for(uint32_t i : order){
+        const ObjectModel* mesh = entities.mesh[i].get();
+        if(mesh == nullptr){
+            continue;
+        }
+        seen[i] = 1;
+
+        const glm::vec2& previous = entities.previous_translation[i];
+        Affine2D transform{previous + (entities.translation[i] - previous) * alpha, entities.scale[i]};
+        if(entities.node[i] != NO_NODE){
+            transform = world[entities.node[i]] * transform;
+        }
+
+        Drawn& d = drawn[i];
+        if(d.visible
+            && d.mesh == mesh
+            && d.changed_frame == entities.changed_frame[i]
+            && d.transform.translation == transform.translation
+            && d.transform.scale == transform.scale){
+            continue;
+        }
+
+        /* Both where it was and where it is now have to be drawn again */
+        if(d.visible){
+            add(d.min, d.max, extent);
+        }
+        glm::vec2 a = transform.apply(mesh->get_bounds_min());
+        glm::vec2 b = transform.apply(mesh->get_bounds_max());
+        d.min = glm::min(a, b);
+        d.max = glm::max(a, b);
+        d.transform = transform;
+        d.mesh = mesh;
+        d.changed_frame = entities.changed_frame[i];
+        d.visible = true;
+        add(d.min, d.max, extent);
+    }
+
+    /* Destroyed, hidden by a merge, or lost their mesh */
+    for(size_t i = 0; i < drawn.size(); i++){
+        if(drawn[i].visible && !seen[i]){
+            add(drawn[i].min, drawn[i].max, extent);
+            drawn[i].visible = false;
+        }
+    }
+
+    drawn_version = entities.get_version();
+    drawn_alpha = alpha;
+    first = false;
+    return rects;
+}
+
+void DamageTracker::set_view(const glm::mat4& new_view){
+    if(new_view == view){
+        return;
+    }
+    view = new_view;
+    view_changed = true;
+
+    /* Object space to -1 to 1 is a shift by -1 when the camera is where it started */
+    glm::mat4 start(1.0f);
+    start[3] = glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+    identity_view = view == start;
+}
+
+void DamageTracker::add_transient(const ImmediateBatch& batch, VkExtent2D extent){
+    add_transient(immediate, !batch.empty(), batch.get_bounds_min(), batch.get_bounds_max(), extent);
+}
+
+void DamageTracker::add_transient(const ParticleSystem& particles, VkExtent2D extent){
+    add_transient(particle, particles.has_particles(), particles.get_bounds_min(), particles.get_bounds_max(), extent);
+}
+
+void DamageTracker::add_transient(const SdfBatch& shapes, VkExtent2D extent){
+    add_transient(sdf, !shapes.empty(), shapes.get_bounds_min(), shapes.get_bounds_max(), extent);
+}
+
+void DamageTracker::add_transient(Transient& last, bool visible, glm::vec2 min, glm::vec2 max, VkExtent2D extent){
+    if(last.visible){
+        add(last.min, last.max, extent);
+    }
+    last.visible = visible;
+    if(visible){
+        last.min = min;
+        last.max = max;
+        add(min, max, extent);
+    }
+}
+
+void DamageTracker::add(glm::vec2 min, glm::vec2 max, VkExtent2D extent){
+    if(!identity_view){
+        /* Box around the projected box, back in the 0 to 2 space the rest expects */
+        glm::vec2 corners[4] = {min, {max.x, min.y}, max, {min.x, max.y}};
+        glm::vec2 projected_min(std::numeric_limits<float>::max());
+        glm::vec2 projected_max(-std::numeric_limits<float>::max());
+        for(const glm::vec2& corner : corners){
+            glm::vec2 p = glm::vec2(view * glm::vec4(corner, 0.0f, 1.0f)) + glm::vec2(1.0f);
+            projected_min = glm::min(projected_min, p);
+            projected_max = glm::max(projected_max, p);
+        }
+        min = projected_min;
+        max = projected_max;
+    }
+
+    /* Object space spans 0 to 2 across the framebuffer, pad a pixel for rasterization rounding */
+    float w = static_cast<float>(extent.width);
+    float h = static_cast<float>(extent.height);
+    int32_t x0 = std::max(static_cast<int32_t>(std::floor(min.x * 0.5f * w)) - 1, 0);
+    int32_t y0 = std::max(static_cast<int32_t>(std::floor(min.y * 0.5f * h)) - 1, 0);
+    int32_t x1 = std::min(static_cast<int32_t>(std::ceil(max.x * 0.5f * w)) + 1, static_cast<int32_t>(extent.width));
+    int32_t y1 = std::min(static_cast<int32_t>(std::ceil(max.y * 0.5f * h)) + 1, static_cast<int32_t>(extent.height));
+    if(x1 <= x0 || y1 <= y0){
+        return;
+    }
+
+    /* Swallow every rectangle the new one touches, the union may touch more */
+    bool merged = true;
+    while(merged){
+        merged = false;
+        for(size_t i = 0; i < rects.size(); i++){
+            const VkRect2D& r = rects[i];
+            int32_t rx1 = r.offset.x + static_cast<int32_t>(r.extent.width);
+            int32_t ry1 = r.offset.y + static_cast<int32_t>(r.extent.height);
+            if(r.offset.x > x1 || rx1 < x0 || r.offset.y > y1 || ry1 < y0){
+                continue;
+            }
+            x0 = std::min(x0, r.offset.x);
+            y0 = std::min(y0, r.offset.y);
+            x1 = std::max(x1, rx1);
+            y1 = std::max(y1, ry1);
+            rects[i] = rects.back();
+            rects.pop_back();
+            merged = true;
+            break;
+        }
+    }
+    rects.push_back({{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}});
+
+    if(rects.size() > MAX_RECTS){
+        for(const VkRect2D& r : rects){
+            x0 = std::min(x0, r.offset.x);
+            y0 = std::min(y0, r.offset.y);
+            x1 = std::max(x1, r.offset.x + static_cast<int32_t>(r.extent.width));
+            y1 = std::max(y1, r.offset.y + static_cast<int32_t>(r.extent.height));
+        }
+        rects.assign(1, {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}});
+    }
+}
+
+}
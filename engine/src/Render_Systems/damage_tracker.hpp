@@ -0,0 +1,129 @@
+/**
+ * @file damage_tracker.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Finds the parts of the screen that changed since the last frame, so only
+ * those have to be drawn again
+ *
+ */
+
+#pragma once
+
+#include "Entity/entity_store.hpp"
+#include "immediate_batch.hpp"
+#include "particle_system.hpp"
+#include "sdf_batch.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Tracks which pixel rectangles changed between frames
+ *
+ * How every entity was last drawn (its transform, mesh and bounds) is kept.
+ * Each frame the drawn entities are compared with that, an entity that moved,
+ * changed, appeared or disappeared damages both where it was and where it is
+ * now. Overlapping rectangles are merged, and if there are too many they are
+ * collapsed into their bounding box.
+ *
+ * The comparison is skipped when nothing in the store changed, so a still
+ * frame costs nothing.
+ */
+class DamageTracker {
+public:
+    static constexpr size_t MAX_RECTS = 16;
+
+    /**
+     * @brief Finds what changed since the last call
+     *
+     * @param entities Store holding the entities about to be drawn
+     * @param alpha Interpolation alpha the frame is drawn with
+     * @param extent Size of the image being drawn to
+     * @return Damaged rectangles in framebuffer pixels, empty if nothing changed
+     */
+    const std::vector<VkRect2D>& collect(EntityStore& entities, float alpha, VkExtent2D extent);
+
+    /**
+     * @brief Sets the camera projection the frame is drawn with
+     *
+     * Damage is projected with it. When it changes everything on screen
+     * moves, so the next collect damages the whole screen.
+     *
+     * @param new_view Projection from object space to normalized device
+     *                 coordinates, see Camera::get_view
+     * @return void
+     */
+    void set_view(const glm::mat4& new_view);
+
+    /**
+     * @brief Damages shapes that are only drawn for one frame
+     *
+     * Where the last frame's shapes were is damaged too, since they are gone
+     * now. Call after collect, the rectangles are added to what it returned.
+     *
+     * @param batch Shapes drawn this frame
+     * @param extent Size of the image being drawn to
+     * @return void
+     */
+    void add_transient(const ImmediateBatch& batch, VkExtent2D extent);
+
+    /**
+     * @brief Damages particles, see add_transient
+     *
+     * @param particles Particles drawn this frame
+     * @param extent Size of the image being drawn to
+     * @return void
+     */
+    void add_transient(const ParticleSystem& particles, VkExtent2D extent);
+
+    /**
+     * @brief Damages SDF shapes, see add_transient
+     *
+     * @param shapes SDF shapes drawn this frame
+     * @param extent Size of the image being drawn to
+     * @return void
+     */
+    void add_transient(const SdfBatch& shapes, VkExtent2D extent);
+
+private:
+    /* How an entity looked the last time it was drawn */
+    struct Drawn {
+        Affine2D transform;
+        glm::vec2 min = glm::vec2(0.0f);
+        glm::vec2 max = glm::vec2(0.0f);
+        const ObjectModel* mesh = nullptr;
+        uint64_t changed_frame = 0;
+        bool visible = false;
+    };
+
+    /* Box around what a transient source drew last frame */
+    struct Transient {
+        glm::vec2 min = glm::vec2(0.0f);
+        glm::vec2 max = glm::vec2(0.0f);
+        bool visible = false;
+    };
+
+    void add(glm::vec2 min, glm::vec2 max, VkExtent2D extent);
+    void add_transient(Transient& last, bool visible, glm::vec2 min, glm::vec2 max, VkExtent2D extent);
+
+    std::vector<Drawn> drawn;
+    std::vector<uint8_t> seen;
+    std::vector<VkRect2D> rects;
+    uint64_t drawn_version = 0;
+    float drawn_alpha = -1.0f;
+    bool first = true;
+    glm::mat4 view = glm::mat4(1.0f);
+    bool identity_view = true;
+    bool view_changed = false;
+
+    Transient immediate;
+    Transient particle;
+    Transient sdf;
+};
+
+}
@@ -0,0 +1,492 @@
+#include "gpu_culling.hpp"
+#include "object_render_system.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace hop {
+
+struct CullPushConstants {
+    glm::vec2 view_min;
+    glm::vec2 view_max;
+    uint32_t object_count;
+};
+
+bool GpuCulling::is_supported(const Device& device){
+    return device.supports_compute() && device.has_draw_indirect_count();
+}
+
+GpuCulling::GpuCulling(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout) : device{device} {
+    create_descriptors();
+    create_pipeline_layouts(camera_layout);
+    create_pipelines(render_pass);
+}
+
+GpuCulling::~GpuCulling(){
+    for(auto& frame : frames){
+        release(frame);
+    }
+    cull_pipeline.reset();
+    draw_pipeline.reset();
+    vkDestroyPipelineLayout(device.get_device(), cull_pipeline_layout, nullptr);
+    vkDestroyPipelineLayout(device.get_device(), draw_pipeline_layout, nullptr);
+    vkDestroyDescriptorPool(device.get_device(), descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device.get_device(), set_layout, nullptr);
+    VK_INFO("destroyed culling pipeline layouts");
+}
+
+void GpuCulling::cull(VkCommandBuffer command_buffer, int frame_index, EntityStore& entities, StaticBatch& batch, float alpha, glm::vec2 view_min, glm::vec2 view_max){
+    /* Called once per frame, geometry retired RETIRE_SLOTS frames ago is no longer drawn */
+    retire_slot = (retire_slot + 1) % RETIRE_SLOTS;
+    retired_geometry[retire_slot].clear();
+
+    FrameBuffers& frame = frames[frame_index];
+    const auto& segments = batch.get_segments();
+    object_count = static_cast<uint32_t>(segments.size());
+    if(object_count == 0){
+        frame.written = false;
+        return;
+    }
+    if(geometry == nullptr){
+        grow_geometry(0);
+    }
+
+    /* Placing a new mesh can move the geometry buffer, then every object is written again */
+    uint64_t scene_version = entities.scene.get_version();
+    for(;;){
+        Layout layout{entities.get_order_version(), entities.get_static_version(), batch.get_buffer_version(), geometry_version};
+        bool full = !frame.written || !(frame.layout == layout);
+        if(full){
+            build_groups(frame, entities, batch);
+            reserve(frame, object_count, frame.groups.size());
+            frame.layers.clear();
+            frame.layout = layout;
+            frame.written = true;
+        }
+
+        /* Segments are in draw order, so every layer is one run of segments */
+        uint64_t placed_version = geometry_version;
+        size_t start = 0;
+        while(start < segments.size() && geometry_version == placed_version){
+            int l = entities.layer[segments[start].entity];
+            size_t end = start + 1;
+            while(end < segments.size() && entities.layer[segments[end].entity] == l){
+                end++;
+            }
+
+            WrittenLayer& written = frame.layers[l];
+            uint64_t layer_version = entities.get_layer_version(l);
+            bool current = !full && written.layer_version == layer_version
+                && (!written.uses_scene || written.scene_version == scene_version)
+                && (!written.uses_alpha || written.alpha == alpha);
+            if(!current){
+                write_objects(frame, entities, batch, start, end, alpha, written);
+                written.layer_version = layer_version;
+                written.scene_version = scene_version;
+                written.alpha = alpha;
+            }
+            start = end;
+        }
+        if(geometry_version == placed_version){
+            break;
+        }
+    }
+
+    /* The previous use of this frame's buffers finished with its fence, only the counts need clearing */
+    vkCmdFillBuffer(command_buffer, frame.counts, 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr
+    );
+
+    CullPushConstants push{};
+    push.view_min = view_min;
+    push.view_max = view_max;
+    push.object_count = object_count;
+
+    cull_pipeline->bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline_layout, 0, 1, &frame.descriptor_set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push);
+    vkCmdDispatch(command_buffer, (object_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr
+    );
+}
+
+void GpuCulling::build_groups(FrameBuffers& frame, EntityStore& entities, const StaticBatch& batch){
+    const auto& segments = batch.get_segments();
+    const std::shared_ptr<ObjectModel>* mesh = entities.mesh.data();
+
+    /* Every dynamic mesh is in the geometry buffer, each static chunk has its own */
+    frame.groups.clear();
+    frame.object_groups.resize(segments.size());
+    frame.object_ranks.resize(segments.size());
+    group_index.clear();
+    for(size_t s = 0; s < segments.size(); s++){
+        const StaticBatch::Segment& segment = segments[s];
+        VkBuffer buffer = VK_NULL_HANDLE;
+        if(segment.is_static){
+            buffer = batch.get_chunk_buffer(segment.chunk);
+        } else if(mesh[segment.entity] != nullptr){
+            buffer = geometry->get_buffer();
+        }
+
+        auto [it, added] = group_index.try_emplace(buffer, static_cast<uint32_t>(frame.groups.size()));
+        if(added){
+            frame.groups.push_back({buffer, 0, 0});
+        }
+        frame.object_groups[s] = it->second;
+        frame.object_ranks[s] = frame.groups[it->second].count++;
+    }
+
+    uint32_t base = 0;
+    for(Group& group : frame.groups){
+        group.base = base;
+        base += group.count;
+    }
+}
+
+void GpuCulling::write_objects(FrameBuffers& frame, EntityStore& entities, const StaticBatch& batch, size_t first, size_t last, float alpha, WrittenLayer& written){
+    const auto& segments = batch.get_segments();
+    const std::shared_ptr<ObjectModel>* mesh = entities.mesh.data();
+    const glm::vec2* translation = entities.translation.data();
+    const glm::vec2* previous = entities.previous_translation.data();
+    const glm::vec2* scale = entities.scale.data();
+    const glm::vec3* color = entities.color.data();
+    const NodeId* node = entities.node.data();
+    const std::vector<Affine2D>& world = entities.scene.get_world_transforms(alpha);
+
+    written.uses_scene = false;
+    written.uses_alpha = false;
+
+    auto* out = static_cast<GpuObject*>(frame.mapped);
+    for(size_t s = first; s < last; s++){
+        const StaticBatch::Segment& segment = segments[s];
+        const Group& group = frame.groups[frame.object_groups[s]];
+        GpuObject& object = out[s];
+        float depth = ObjectRenderSystem::layer_depth(entities.layer[segment.entity]);
+
+        const std::shared_ptr<ObjectModel>& model = mesh[segment.entity];
+        if(!segment.is_static && model == nullptr){
+            /* Nothing to draw, an empty box is always culled */
+            object = GpuObject{};
+            object.bounds_min = glm::vec2(std::numeric_limits<float>::max());
+            object.bounds_max = glm::vec2(-std::numeric_limits<float>::max());
+            object.group = frame.object_groups[s];
+            object.base = group.base;
+            object.rank = frame.object_ranks[s];
+            continue;
+        }
+
+        object.group = frame.object_groups[s];
+        object.base = group.base;
+        object.rank = frame.object_ranks[s];
+        if(segment.is_static){
+            /* Static vertices are already in world space with their color */
+            object.translation = glm::vec2(0.0f);
+            object.scale = glm::vec2(1.0f);
+            object.bounds_min = glm::vec2(-std::numeric_limits<float>::max());
+            object.bounds_max = glm::vec2(std::numeric_limits<float>::max());
+            object.color = glm::vec4(1.0f, 1.0f, 1.0f, depth);
+            object.first_vertex = segment.first_vertex;
+            object.vertex_count = segment.vertex_count;
+            continue;
+        }
+
+        uint32_t i = segment.entity;
+        Affine2D transform{previous[i] + (translation[i] - previous[i]) * alpha, scale[i]};
+        if(previous[i] != translation[i]){
+            written.uses_alpha = true;
+        }
+        if(node[i] != NO_NODE){
+            transform = world[node[i]] * transform;
+            written.uses_scene = true;
+            written.uses_alpha = true;
+        }
+        object.translation = transform.translation;
+        object.scale = transform.scale;
+        object.bounds_min = model->get_bounds_min();
+        object.bounds_max = model->get_bounds_max();
+        object.color = glm::vec4(color[i], depth);
+        object.first_vertex = place_mesh(model);
+        object.vertex_count = model->get_vertex_count();
+    }
+}
+
+uint32_t GpuCulling::place_mesh(const std::shared_ptr<ObjectModel>& mesh){
+    /* The weak pointer keeps a freed mesh from being mistaken for a new one at the same address */
+    auto it = mesh_slots.find(mesh.get());
+    if(it != mesh_slots.end() && !it->second.mesh.expired()){
+        return it->second.first_vertex;
+    }
+
+    uint32_t count = mesh->get_vertex_count();
+    if(geometry_used + count > geometry_capacity){
+        grow_geometry(count);
+    }
+
+    /* Appended after what frames in flight may be drawing */
+    uint32_t first = geometry_used;
+    geometry->write(mesh->get_vertices().data(), sizeof(ObjectModel::Vertex) * count, sizeof(ObjectModel::Vertex) * first);
+    geometry_used += count;
+    mesh_slots[mesh.get()] = {mesh, first};
+    return first;
+}
+
+void GpuCulling::grow_geometry(uint32_t extra){
+    /* Meshes that are gone are left behind, the rest are packed into a new buffer in one upload */
+    std::vector<ObjectModel::Vertex> vertices;
+    for(auto it = mesh_slots.begin(); it != mesh_slots.end();){
+        std::shared_ptr<ObjectModel> mesh = it->second.mesh.lock();
+        if(mesh == nullptr){
+            it = mesh_slots.erase(it);
+            continue;
+        }
+        it->second.first_vertex = static_cast<uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), mesh->get_vertices().begin(), mesh->get_vertices().end());
+        it++;
+    }
+
+    if(geometry != nullptr){
+        retired_geometry[retire_slot].push_back(std::move(geometry));
+    }
+    geometry_used = static_cast<uint32_t>(vertices.size());
+    geometry_capacity = std::max(MIN_GEOMETRY_VERTICES, 2 * (geometry_used + extra));
+    geometry = std::make_shared<VertexBuffer>(device, sizeof(ObjectModel::Vertex) * geometry_capacity);
+    if(!vertices.empty()){
+        geometry->write(vertices.data(), sizeof(ObjectModel::Vertex) * vertices.size(), 0);
+    }
+    geometry_version++;
+}
+
+uint32_t GpuCulling::draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set){
+    FrameBuffers& frame = frames[frame_index];
+    if(object_count == 0){
+        return 0;
+    }
+
+    draw_pipeline->bind(command_buffer);
+    VkDescriptorSet sets[] = {camera_set, frame.descriptor_set};
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw_pipeline_layout, 0, 2, sets, 0, nullptr);
+
+    uint32_t draw_calls = 0;
+    VkDeviceSize offset = 0;
+    for(size_t g = 0; g < frame.groups.size(); g++){
+        const Group& group = frame.groups[g];
+        if(group.vertex_buffer == VK_NULL_HANDLE){
+            continue;
+        }
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &group.vertex_buffer, &offset);
+        device.draw_indirect_count(
+            command_buffer,
+            frame.commands,
+            sizeof(VkDrawIndirectCommand) * group.base,
+            frame.counts,
+            sizeof(uint32_t) * g,
+            group.count,
+            sizeof(VkDrawIndirectCommand)
+        );
+        draw_calls++;
+    }
+    return draw_calls;
+}
+
+void GpuCulling::create_descriptors(){
+    /* Objects, the draws written for them and the draw count of every group */
+    std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+    for(uint32_t i = 0; i < bindings.size(); i++){
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+    bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info{};
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    set_layout_info.pBindings = bindings.data();
+
+    if(vkCreateDescriptorSetLayout(device.get_device(), &set_layout_info, nullptr, &set_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create culling descriptor set layout");
+    }
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size.descriptorCount = 3 * SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = SwapChain::MAX_FRAMES_IN_FLIGHT;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+
+    if(vkCreateDescriptorPool(device.get_device(), &pool_info, nullptr, &descriptor_pool) != VK_SUCCESS){
+        VK_ERROR("failed to create culling descriptor pool");
+    }
+
+    for(auto& frame : frames){
+        VkDescriptorSetAllocateInfo allocation_info{};
+        allocation_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocation_info.descriptorPool = descriptor_pool;
+        allocation_info.descriptorSetCount = 1;
+        allocation_info.pSetLayouts = &set_layout;
+
+        if(vkAllocateDescriptorSets(device.get_device(), &allocation_info, &frame.descriptor_set) != VK_SUCCESS){
+            VK_ERROR("failed to allocate culling descriptor set");
+        }
+    }
+}
+
+void GpuCulling::create_pipeline_layouts(VkDescriptorSetLayout camera_layout){
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &cull_pipeline_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create culling pipeline layout");
+    }
+
+    /* Everything the vertex shader needs is in the camera and the objects */
+    VkDescriptorSetLayout draw_set_layouts[] = {camera_layout, set_layout};
+    pipeline_layout_info.setLayoutCount = 2;
+    pipeline_layout_info.pSetLayouts = draw_set_layouts;
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &draw_pipeline_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create indirect pipeline layout");
+    }
+}
+
+void GpuCulling::create_pipelines(VkRenderPass render_pass){
+    assert(cull_pipeline_layout != nullptr && draw_pipeline_layout != nullptr);
+
+    cull_pipeline = std::make_unique<Pipeline>(
+        device,
+        "../../engine/build/shaders/cull.comp.spv",
+        cull_pipeline_layout
+    );
+
+    PipelineConfigInfo pipeline_config = {};
+    Pipeline::default_config(pipeline_config);
+    pipeline_config.renderPass = render_pass;
+    pipeline_config.pipelineLayout = draw_pipeline_layout;
+
+    draw_pipeline = std::make_unique<Pipeline>(
+        device,
+        "../../engine/build/shaders/indirect.vert.spv",
+        "../../engine/build/shaders/indirect.frag.spv",
+        pipeline_config
+    );
+}
+
+bool GpuCulling::reserve(FrameBuffers& frame, size_t object_count, size_t group_count){
+    if(object_count <= frame.capacity && group_count <= frame.group_capacity){
+        return false;
+    }
+
+    /* The frame's last use has finished, the old buffers can go right away */
+    size_t capacity = std::max(frame.capacity, std::max(MIN_CAPACITY, object_count + object_count / 2));
+    size_t group_capacity = std::max(frame.group_capacity, std::max(MIN_GROUPS, group_count * 2));
+    release(frame);
+    frame.capacity = capacity;
+    frame.group_capacity = group_capacity;
+
+    VkDeviceSize object_size = sizeof(GpuObject) * capacity;
+    device.create_buffer(
+        object_size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.objects,
+        frame.object_memory
+    );
+    if(vkMapMemory(device.get_device(), frame.object_memory, 0, object_size, 0, &frame.mapped) != VK_SUCCESS){
+        VK_ERROR("failed to map culling object buffer");
+    }
+
+    device.create_buffer(
+        sizeof(VkDrawIndirectCommand) * capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        frame.commands,
+        frame.command_memory
+    );
+    device.create_buffer(
+        sizeof(uint32_t) * group_capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        frame.counts,
+        frame.count_memory
+    );
+
+    VkDescriptorBufferInfo buffer_infos[3] = {
+        {frame.objects, 0, VK_WHOLE_SIZE},
+        {frame.commands, 0, VK_WHOLE_SIZE},
+        {frame.counts, 0, VK_WHOLE_SIZE}
+    };
+    VkWriteDescriptorSet writes[3] = {};
+    for(uint32_t i = 0; i < 3; i++){
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = frame.descriptor_set;
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &buffer_infos[i];
+    }
+    vkUpdateDescriptorSets(device.get_device(), 3, writes, 0, nullptr);
+    return true;
+}
+
+void GpuCulling::release(FrameBuffers& frame){
+    if(frame.objects == VK_NULL_HANDLE){
+        return;
+    }
+    VkDevice vk_device = device.get_device();
+    vkUnmapMemory(vk_device, frame.object_memory);
+    vkDestroyBuffer(vk_device, frame.objects, nullptr);
+    vkFreeMemory(vk_device, frame.object_memory, nullptr);
+    vkDestroyBuffer(vk_device, frame.commands, nullptr);
+    vkFreeMemory(vk_device, frame.command_memory, nullptr);
+    vkDestroyBuffer(vk_device, frame.counts, nullptr);
+    vkFreeMemory(vk_device, frame.count_memory, nullptr);
+
+    /* The descriptor set stays, it's pointed at the new buffers */
+    frame.objects = VK_NULL_HANDLE;
+    frame.object_memory = VK_NULL_HANDLE;
+    frame.mapped = nullptr;
+    frame.commands = VK_NULL_HANDLE;
+    frame.command_memory = VK_NULL_HANDLE;
+    frame.counts = VK_NULL_HANDLE;
+    frame.count_memory = VK_NULL_HANDLE;
+    frame.capacity = 0;
+    frame.group_capacity = 0;
+}
+
+}
@@ -0,0 +1,238 @@
+/**
+ * @file gpu_culling.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Culls objects and generates their draws in a compute shader
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Pipeline/pipeline.hpp"
+#include "Entity/entity_store.hpp"
+#include "Renderer/camera.hpp"
+#include "Swapchain/swapchain.hpp"
+#include "static_batch.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief One object as the culling and vertex shaders read it
+ *
+ * Color holds the depth the object is drawn at in w. Objects whose draws
+ * share a vertex buffer are in the same group, their draws are written from
+ * base onwards, each at its rank within the group.
+ */
+struct GpuObject {
+    glm::vec2 translation;
+    glm::vec2 scale;
+    glm::vec2 bounds_min;
+    glm::vec2 bounds_max;
+    glm::vec4 color;
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+    uint32_t group;
+    uint32_t base;
+    uint32_t rank;
+    uint32_t padding[3];
+};
+
+/**
+ * @brief Draws objects from draws a compute shader wrote
+ *
+ * The object of each segment is written into a host visible storage buffer,
+ * then every frame a compute shader tests each against the render area and
+ * appends a VkDrawIndirectCommand for the visible ones, counting them per
+ * vertex buffer. Each vertex buffer is then one vkCmdDrawIndirectCountKHR,
+ * so recording costs the same no matter how many objects there are.
+ *
+ * Objects are only written again when they change. Like the layer command
+ * buffers of ObjectRenderSystem, a layer's objects are kept until its layer
+ * version changes, or the scene or alpha changes for layers that use them.
+ * Everything is written again when the segments change.
+ *
+ * The mesh of every dynamic object is copied once into one shared geometry
+ * buffer, so every dynamic object is drawn by a single draw call and the
+ * static chunks add one each. The geometry buffer only grows, meshes that
+ * are gone are left behind when it does.
+ *
+ * Objects are drawn at the depth of their layer, see
+ * ObjectRenderSystem::layer_depth. Every object has its own draw in its
+ * group, in draw order, so within a layer the first drawn stays on top like
+ * without GPU culling. A culled object's draw is left empty and only the
+ * empty draws after the last visible one are skipped.
+ *
+ * NOTE: Needs compute and Device::has_draw_indirect_count()
+ */
+class GpuCulling {
+public:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    /**
+     * @brief Checks if a device can cull on the GPU
+     * @param device
+     * @return true if it can
+     */
+    static bool is_supported(const Device& device);
+
+    /**
+     * @brief Constructor
+     *
+     * Creates the culling and drawing pipelines.
+     *
+     * @param device
+     * @param render_pass Render pass the objects are drawn in
+     * @param camera_layout Layout of the camera's descriptor set, see CameraBuffer
+     */
+    GpuCulling(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the buffers may still be in flight
+     */
+    ~GpuCulling();
+
+    // Prevents copying of this object
+    GpuCulling(const GpuCulling&) = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+
+    /**
+     * @brief Writes the objects and records the culling pass
+     *
+     * NOTE: Must be recorded outside of a render pass, after the frame's
+     *       fence was waited on
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @param frame_index Frame in flight being recorded
+     * @param entities Store holding the entities to draw
+     * @param batch Segments to draw, in draw order
+     * @param alpha How far between the previous and current translation to draw
+     * @param view_min Smallest corner of the box the camera shows, in the 0
+     *                 to 2 space of object vertices, objects outside it are culled
+     * @param view_max Largest corner of that box
+     * @return void
+     */
+    void cull(VkCommandBuffer command_buffer, int frame_index, EntityStore& entities, StaticBatch& batch, float alpha, glm::vec2 view_min, glm::vec2 view_max);
+
+    /**
+     * @brief Draws what the last cull of a frame found visible
+     *
+     * Binds its own pipeline, the viewport and scissor must already be set.
+     *
+     * @param command_buffer Command buffer to record the draws into
+     * @param frame_index Same frame as the last cull
+     * @param camera_set Camera descriptor set of the frame
+     * @return Amount of draw calls recorded
+     */
+    uint32_t draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set);
+
+    /**
+     * @brief Amount of objects the last cull tested
+     * @return The count
+     */
+    uint32_t get_object_count() const { return object_count; }
+
+private:
+    /* Draws of objects sharing a vertex buffer */
+    struct Group {
+        VkBuffer vertex_buffer;
+        uint32_t base;
+        uint32_t count;
+    };
+
+    /* What a layer's objects were written with */
+    struct WrittenLayer {
+        uint64_t layer_version = 0;
+        uint64_t scene_version = 0;
+        float alpha = 0.0f;
+        bool uses_scene = false;
+        bool uses_alpha = false;
+    };
+
+    /* Everything the place of objects in the buffer and their draws depend on */
+    struct Layout {
+        uint64_t order_version = 0;
+        uint64_t static_version = 0;
+        uint64_t buffer_version = 0;
+        uint64_t geometry_version = 0;
+
+        bool operator==(const Layout& l) const {
+            return order_version == l.order_version && static_version == l.static_version
+                && buffer_version == l.buffer_version && geometry_version == l.geometry_version;
+        }
+    };
+
+    /* Where a mesh's vertices are in the geometry buffer */
+    struct MeshSlot {
+        std::weak_ptr<ObjectModel> mesh;
+        uint32_t first_vertex;
+    };
+
+    struct FrameBuffers {
+        VkBuffer objects = VK_NULL_HANDLE;
+        VkDeviceMemory object_memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkBuffer commands = VK_NULL_HANDLE;
+        VkDeviceMemory command_memory = VK_NULL_HANDLE;
+        VkBuffer counts = VK_NULL_HANDLE;
+        VkDeviceMemory count_memory = VK_NULL_HANDLE;
+        size_t capacity = 0;
+        size_t group_capacity = 0;
+        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+        std::vector<Group> groups;
+        std::vector<uint32_t> object_groups;
+        std::vector<uint32_t> object_ranks;
+        std::unordered_map<int, WrittenLayer> layers;
+        Layout layout;
+        bool written = false;
+    };
+
+    static constexpr size_t MIN_CAPACITY = 1024;
+    static constexpr size_t MIN_GROUPS = 16;
+    static constexpr uint32_t MIN_GEOMETRY_VERTICES = 1 << 16;
+
+    void create_descriptors();
+    void create_pipeline_layouts(VkDescriptorSetLayout camera_layout);
+    void create_pipelines(VkRenderPass render_pass);
+    bool reserve(FrameBuffers& frame, size_t objects, size_t groups);
+    void release(FrameBuffers& frame);
+    void build_groups(FrameBuffers& frame, EntityStore& entities, const StaticBatch& batch);
+    void write_objects(FrameBuffers& frame, EntityStore& entities, const StaticBatch& batch, size_t first, size_t last, float alpha, WrittenLayer& written);
+    uint32_t place_mesh(const std::shared_ptr<ObjectModel>& mesh);
+    void grow_geometry(uint32_t extra);
+
+    Device& device;
+    std::unique_ptr<Pipeline> cull_pipeline;
+    std::unique_ptr<Pipeline> draw_pipeline;
+    VkPipelineLayout cull_pipeline_layout = VK_NULL_HANDLE;
+    VkPipelineLayout draw_pipeline_layout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+
+    FrameBuffers frames[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    std::unordered_map<VkBuffer, uint32_t> group_index;
+    uint32_t object_count = 0;
+
+    std::shared_ptr<VertexBuffer> geometry;
+    uint32_t geometry_capacity = 0;
+    uint32_t geometry_used = 0;
+    uint64_t geometry_version = 0;
+    std::unordered_map<const ObjectModel*, MeshSlot> mesh_slots;
+
+    /* Geometry buffers replaced by bigger ones, kept until no frame in flight can use them */
+    static constexpr size_t RETIRE_SLOTS = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+    std::vector<std::shared_ptr<VertexBuffer>> retired_geometry[RETIRE_SLOTS];
+    size_t retire_slot = 0;
+};
+
+}
@@ -0,0 +1,101 @@
+#include "immediate_batch.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hop {
+
+ImmediateBatch::ImmediateBatch(Device& device) : device{device} {}
+
+ImmediateBatch::~ImmediateBatch(){
+    for(auto& frame : frames){
+        release(frame);
+    }
+}
+
+void ImmediateBatch::add_quad(const glm::vec2 (&corners)[4], const glm::vec3& color){
+    if(vertices.empty()){
+        bounds_min = corners[0];
+        bounds_max = corners[0];
+    }
+    for(const auto& c : corners){
+        bounds_min = glm::min(bounds_min, c);
+        bounds_max = glm::max(bounds_max, c);
+    }
+
+    vertices.push_back({corners[0], color});
+    vertices.push_back({corners[1], color});
+    vertices.push_back({corners[2], color});
+    vertices.push_back({corners[0], color});
+    vertices.push_back({corners[2], color});
+    vertices.push_back({corners[3], color});
+}
+
+bool ImmediateBatch::upload(int frame_index){
+    FrameBuffer& frame = frames[frame_index];
+    frame.vertex_count = static_cast<uint32_t>(vertices.size());
+    if(vertices.empty()){
+        return false;
+    }
+    reserve(frame, vertices.size());
+
+    /* The first shape drawn wins the depth test, so the last one added goes first */
+    auto* out = static_cast<ObjectModel::Vertex*>(frame.mapped);
+    for(size_t shape = vertices.size(); shape > 0; shape -= VERTICES_PER_SHAPE){
+        std::memcpy(out, &vertices[shape - VERTICES_PER_SHAPE], sizeof(ObjectModel::Vertex) * VERTICES_PER_SHAPE);
+        out += VERTICES_PER_SHAPE;
+    }
+    return true;
+}
+
+void ImmediateBatch::draw(VkCommandBuffer command_buffer, int frame_index){
+    FrameBuffer& frame = frames[frame_index];
+    if(frame.vertex_count == 0){
+        return;
+    }
+
+    VkBuffer buffers[] = {frame.buffer};
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, buffers, offsets);
+    vkCmdDraw(command_buffer, frame.vertex_count, 1, 0, 0);
+}
+
+void ImmediateBatch::clear(){
+    vertices.clear();
+}
+
+void ImmediateBatch::reserve(FrameBuffer& frame, size_t count){
+    if(count <= frame.capacity){
+        return;
+    }
+
+    /* The frame's last use has finished, the old buffer can go right away */
+    release(frame);
+    frame.capacity = std::max(MIN_CAPACITY, count + count / 2);
+
+    VkDeviceSize size = sizeof(ObjectModel::Vertex) * frame.capacity;
+    device.create_buffer(
+        size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.buffer,
+        frame.memory
+    );
+    if(vkMapMemory(device.get_device(), frame.memory, 0, size, 0, &frame.mapped) != VK_SUCCESS){
+        VK_ERROR("failed to map immediate vertex buffer");
+    }
+}
+
+void ImmediateBatch::release(FrameBuffer& frame){
+    if(frame.buffer == VK_NULL_HANDLE){
+        return;
+    }
+    vkUnmapMemory(device.get_device(), frame.memory);
+    vkDestroyBuffer(device.get_device(), frame.buffer, nullptr);
+    vkFreeMemory(device.get_device(), frame.memory, nullptr);
+    frame = FrameBuffer{};
+}
+
+}
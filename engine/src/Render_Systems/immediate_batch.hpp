@@ -0,0 +1,124 @@
+/**
+ * @file immediate_batch.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Shapes that are only drawn for one frame, written into a buffer that is
+ * reused every frame
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Objects/object.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Batch of shapes drawn for a single frame
+ *
+ * Shapes are collected on the CPU while the game updates. When the frame is
+ * recorded they are copied into a host visible vertex buffer owned by the
+ * frame in flight and drawn with one draw call, then forgotten. Each frame in
+ * flight has its own buffer so the CPU never writes to one the GPU is reading.
+ * A buffer only grows, so after the first few frames nothing is allocated.
+ *
+ * Vertices are in world space with their color baked in, the same as the
+ * static chunks, see StaticBatch.
+ *
+ * NOTE: Shapes added later are drawn on top of earlier ones
+ */
+class ImmediateBatch {
+public:
+    /**
+     * @brief Constructor
+     * @param device
+     */
+    ImmediateBatch(Device& device);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the buffers may still be in flight
+     */
+    ~ImmediateBatch();
+
+    // Prevents copying of this object
+    ImmediateBatch(const ImmediateBatch&) = delete;
+    ImmediateBatch& operator=(const ImmediateBatch&) = delete;
+
+    /**
+     * @brief Adds a quad
+     * @param corners The four corners, in order around the quad
+     * @param color Color of the quad
+     * @return void
+     */
+    void add_quad(const glm::vec2 (&corners)[4], const glm::vec3& color);
+
+    /**
+     * @brief Copies the shapes into the buffer of a frame in flight
+     *
+     * NOTE: The GPU must be done with the frame's previous use of the buffer
+     *
+     * @param frame_index Frame in flight the shapes are drawn in
+     * @return false if there is nothing to draw
+     */
+    bool upload(int frame_index);
+
+    /**
+     * @brief Binds the buffer of a frame in flight and draws every shape
+     * @param command_buffer Command buffer to record the draw into
+     * @param frame_index Same frame as the last upload
+     * @return void
+     */
+    void draw(VkCommandBuffer command_buffer, int frame_index);
+
+    /**
+     * @brief Forgets every shape, called once the frame was recorded
+     * @return void
+     */
+    void clear();
+
+    bool empty() const { return vertices.empty(); }
+    uint32_t get_shape_count() const { return static_cast<uint32_t>(vertices.size() / VERTICES_PER_SHAPE); }
+
+    /**
+     * @brief Corners of the box around every shape
+     *
+     * NOTE: Only valid while not empty
+     *
+     * @return Smallest and largest vertex position
+     */
+    glm::vec2 get_bounds_min() const { return bounds_min; }
+    glm::vec2 get_bounds_max() const { return bounds_max; }
+
+private:
+    static constexpr size_t VERTICES_PER_SHAPE = 6;
+    static constexpr size_t MIN_CAPACITY = 1024;
+
+    struct FrameBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        size_t capacity = 0;
+        uint32_t vertex_count = 0;
+    };
+
+    void reserve(FrameBuffer& frame, size_t count);
+    void release(FrameBuffer& frame);
+
+    Device& device;
+    FrameBuffer frames[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    std::vector<ObjectModel::Vertex> vertices;
+    glm::vec2 bounds_min = glm::vec2(0.0f);
+    glm::vec2 bounds_max = glm::vec2(0.0f);
+};
+
+}
@@ -2,34 +2,411 @@
 
 #include "Utilities/status_print.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <exception>
+#include <mutex>
 
 namespace hop {
 
 struct PushConstantData {
     glm::mat2 transform{1.f};
     glm::vec2 offset;
+    float depth = 0.0f;
     alignas(16) glm::vec3 color;
 };
 
-ObjectRenderSystem::ObjectRenderSystem(Device& device, VkRenderPass render_pass) : device{device} {
-    create_pipline_layout();
+ObjectRenderSystem::ObjectRenderSystem(Device& device, VkRenderPass render_pass, CameraBuffer& camera, JobSystem* jobs) : device{device}, jobs{jobs}, static_batch{device}, camera{camera}, render_pass{render_pass} {
+    graphics_family = device.find_physical_que_families().graphics_family.value();
+    create_pipline_layout(camera.get_set_layout());
     create_pipeline(render_pass);
 }
 
 ObjectRenderSystem::~ObjectRenderSystem(){
+    for(auto& frame_layers : layers){
+        for(auto& [l, layer] : frame_layers){
+            destroy_layer(layer);
+        }
+    }
+    for(VkCommandBuffer immediate : immediate_commands){
+        if(immediate != VK_NULL_HANDLE){
+            vkFreeCommandBuffers(device.get_device(), device.get_command_pool(), 1, &immediate);
+        }
+    }
+    for(VkCommandBuffer particle : particle_commands){
+        if(particle != VK_NULL_HANDLE){
+            vkFreeCommandBuffers(device.get_device(), device.get_command_pool(), 1, &particle);
+        }
+    }
+    for(VkCommandBuffer shape : shape_commands){
+        if(shape != VK_NULL_HANDLE){
+            vkFreeCommandBuffers(device.get_device(), device.get_command_pool(), 1, &shape);
+        }
+    }
+    for(VkCommandBuffer culled : culled_commands){
+        if(culled != VK_NULL_HANDLE){
+            vkFreeCommandBuffers(device.get_device(), device.get_command_pool(), 1, &culled);
+        }
+    }
     vkDestroyPipelineLayout(device.get_device(), pipeline_layout, nullptr);
     VK_INFO("destroyed pipeline layout");
 }
 
-void ObjectRenderSystem::render_objects(VkCommandBuffer command_buffer, std::vector<std::shared_ptr<Object>>& objects){
+bool ObjectRenderSystem::set_gpu_culling(bool enabled){
+    if(enabled && !GpuCulling::is_supported(device)){
+        gpu_culling_enabled = false;
+        return false;
+    }
+    if(enabled && gpu_culling == nullptr){
+        gpu_culling = std::make_unique<GpuCulling>(device, render_pass, camera.get_set_layout());
+    }
+    gpu_culling_enabled = enabled;
+    return true;
+}
+
+float ObjectRenderSystem::layer_depth(int layer){
+    /* Steps well above the precision of a 24 bit depth buffer around 0.5 */
+    constexpr float step = 0.25f / LAYER_DEPTH_RANGE;
+    return 0.5f - std::clamp(layer, -LAYER_DEPTH_RANGE, LAYER_DEPTH_RANGE) * step;
+}
+
+void ObjectRenderSystem::prepare(VkCommandBuffer command_buffer, const Renderer& renderer, EntityStore& entities, float alpha){
+    static_batch.update(entities);
+    if(gpu_culling_enabled){
+        glm::vec2 view_min, view_max;
+        camera.get_visible_bounds(renderer.get_render_area(), renderer.get_render_extent(), view_min, view_max);
+        gpu_culling->cull(command_buffer, renderer.get_frame_index(), entities, static_batch, alpha, view_min, view_max);
+    }
+}
+
+void ObjectRenderSystem::render_objects(VkCommandBuffer command_buffer, const Renderer& renderer, EntityStore& entities, float alpha, ImmediateBatch* immediate, ParticleSystem* particles, SdfBatch* shapes){
+    stats = {};
+    stats.static_objects = static_batch.get_static_count();
+    stats.dynamic_objects = static_batch.get_dynamic_count();
+    stats.draw_calls = gpu_culling_enabled ? 0 : static_cast<uint32_t>(static_batch.get_segments().size());
+    stats.redrawn_fraction = renderer.get_redrawn_fraction();
+    stats.gpu_culling = gpu_culling_enabled;
+
+    auto& frame_layers = layers[renderer.get_frame_index()];
+    for(auto& [l, layer] : frame_layers){
+        layer.used = false;
+    }
+
+    uint64_t swapchain_version = renderer.get_swapchain_version();
+    uint64_t scene_version = entities.scene.get_version();
+    VkRect2D scissor = renderer.get_render_area();
+    std::vector<VkCommandBuffer> secondaries;
+
+    /* In front of every layer, drawn first so its pixels are never shaded twice */
+    if(immediate != nullptr && immediate->upload(renderer.get_frame_index())){
+        record_immediate(*immediate, renderer);
+        secondaries.push_back(immediate_commands[renderer.get_frame_index()]);
+        stats.draw_calls++;
+        stats.immediate_shapes = immediate->get_shape_count();
+    }
+
+    /* Every object in one secondary, the layers below are all left unused and freed */
+    if(gpu_culling_enabled){
+        stats.draw_calls += record_culled(renderer);
+        secondaries.push_back(culled_commands[renderer.get_frame_index()]);
+        stats.recorded_command_buffers++;
+    }
+
+    /* Segments are in draw order, so every layer is one run of segments, front to back */
+    struct LayerRun {
+        LayerCommands* layer;
+        size_t start;
+        size_t end;
+    };
+    std::vector<LayerCommands*> drawn;
+    std::vector<LayerRun> stale;
+    const auto& segments = static_batch.get_segments();
+    size_t start = gpu_culling_enabled ? segments.size() : 0;
+    while(start < segments.size()){
+        int l = entities.layer[segments[start].entity];
+        size_t end = start + 1;
+        while(end < segments.size() && entities.layer[segments[end].entity] == l){
+            end++;
+        }
+
+        LayerCommands& layer = frame_layers[l];
+        layer.used = true;
+        if(is_current(layer, entities.get_layer_version(l), swapchain_version, scene_version, alpha, scissor)){
+            stats.reused_command_buffers++;
+        } else {
+            stale.push_back({&layer, start, end});
+        }
+        drawn.push_back(&layer);
+        start = end;
+    }
+
+    if(!stale.empty()){
+        /* Filled in once up front, the scene's cache isn't safe to fill from several threads */
+        const std::vector<Affine2D>& world = entities.scene.get_world_transforms(alpha);
+
+        /* What the camera shows of the scissor, in the 0 to 2 space of object vertices */
+        glm::vec2 view_min, view_max;
+        camera.get_visible_bounds(scissor, renderer.get_render_extent(), view_min, view_max);
+
+        /* Layers only touch their own command pool and counters, so any thread can record any of them */
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto record = [&](size_t begin, size_t end){
+            for(size_t i = begin; i < end; i++){
+                const LayerRun& run = stale[i];
+                try {
+                    record_layer(*run.layer, renderer, entities, segments.data() + run.start, segments.data() + run.end, alpha, world, view_min, view_max);
+                } catch(...){
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if(error == nullptr){
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+        if(jobs != nullptr){
+            jobs->parallel_for(stale.size(), 1, record);
+        } else {
+            record(0, stale.size());
+        }
+        if(error != nullptr){
+            std::rethrow_exception(error);
+        }
+        stats.recorded_command_buffers += static_cast<uint32_t>(stale.size());
+    }
+
+    size_t first_layer = secondaries.size();
+    for(LayerCommands* layer : drawn){
+        stats.culled_objects += layer->culled;
+        secondaries.push_back(layer->command_buffer);
+    }
+    if(!front_to_back){
+        std::reverse(secondaries.begin() + first_layer, secondaries.end());
+    }
+
+    /* Blended without depth, so after every layer to end up over them */
+    if(shapes != nullptr && shapes->upload(renderer.get_frame_index())){
+        record_shapes(*shapes, renderer);
+        secondaries.push_back(shape_commands[renderer.get_frame_index()]);
+        stats.draw_calls++;
+        stats.sdf_shapes = shapes->get_shape_count();
+    }
+
+    /* Blended without depth, so last to end up over every layer */
+    if(particles != nullptr && particles->upload(renderer.get_frame_index())){
+        stats.draw_calls += record_particles(*particles, renderer);
+        secondaries.push_back(particle_commands[renderer.get_frame_index()]);
+    }
+
+    /* The GPU is done with this frame index, layers that are gone can be freed */
+    for(auto it = frame_layers.begin(); it != frame_layers.end();){
+        if(!it->second.used){
+            destroy_layer(it->second);
+            it = frame_layers.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    if(!secondaries.empty()){
+        vkCmdExecuteCommands(command_buffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    }
+}
+
+bool ObjectRenderSystem::is_current(const LayerCommands& layer, uint64_t layer_version, uint64_t swapchain_version, uint64_t scene_version, float alpha, const VkRect2D& scissor) const {
+    if(layer.command_buffer == VK_NULL_HANDLE
+        || layer.layer_version != layer_version
+        || layer.swapchain_version != swapchain_version
+        || layer.scissor.offset.x != scissor.offset.x
+        || layer.scissor.offset.y != scissor.offset.y
+        || layer.scissor.extent.width != scissor.extent.width
+        || layer.scissor.extent.height != scissor.extent.height){
+        return false;
+    }
+    if(layer.uses_static_buffer && layer.buffer_version != static_batch.get_buffer_version()){
+        return false;
+    }
+    if(layer.uses_scene && layer.scene_version != scene_version){
+        return false;
+    }
+    if(layer.uses_camera && layer.camera_version != camera.get_version()){
+        return false;
+    }
+    return !layer.uses_alpha || layer.alpha == alpha;
+}
+
+void ObjectRenderSystem::begin_secondary(VkCommandBuffer& command_buffer, const Renderer& renderer, VkCommandPool command_pool){
+    if(command_buffer == VK_NULL_HANDLE){
+        VkCommandBufferAllocateInfo allocation_info{};
+        allocation_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocation_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocation_info.commandPool = command_pool;
+        allocation_info.commandBufferCount = 1;
+
+        if(vkAllocateCommandBuffers(device.get_device(), &allocation_info, &command_buffer) != VK_SUCCESS){
+            VK_ERROR("failed to allocate secondary command buffer");
+        }
+    }
+
+    /* No framebuffer is given so the recording works with every swapchain image */
+    VkCommandBufferInheritanceInfo inheritance_info{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.renderPass = renderer.get_swapchain_render_pass();
+    inheritance_info.subpass = 0;
+    inheritance_info.framebuffer = VK_NULL_HANDLE;
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    if(vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS){
+        VK_ERROR("failed to begin recording secondary command buffer");
+    }
+
+    VkExtent2D extent = renderer.get_render_extent();
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor = renderer.get_render_area();
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+    /* The descriptor set never changes, so the recording doesn't depend on the camera */
+    VkDescriptorSet camera_set = camera.get_descriptor_set(renderer.get_frame_index());
     pipeline->bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &camera_set, 0, nullptr);
+}
+
+void ObjectRenderSystem::record_immediate(ImmediateBatch& immediate, const Renderer& renderer){
+    VkCommandBuffer& command_buffer = immediate_commands[renderer.get_frame_index()];
+    begin_secondary(command_buffer, renderer, device.get_command_pool());
+
+    /* Immediate vertices are already in world space with their color */
+    PushConstantData push{};
+    push.offset = glm::vec2(0.0f);
+    push.depth = 0.0f;
+    push.color = glm::vec3(1.0f);
+    vkCmdPushConstants(
+        command_buffer,
+        pipeline_layout,
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0,
+        sizeof(PushConstantData),
+        &push
+    );
+    immediate.draw(command_buffer, renderer.get_frame_index());
+
+    if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record secondary command buffer");
+    }
+}
+
+uint32_t ObjectRenderSystem::record_particles(ParticleSystem& particles, const Renderer& renderer){
+    VkCommandBuffer& command_buffer = particle_commands[renderer.get_frame_index()];
+    begin_secondary(command_buffer, renderer, device.get_command_pool());
+
+    /* Binds its own pipeline over the object pipeline */
+    uint32_t draw_calls = particles.draw(command_buffer, renderer.get_frame_index(), camera.get_descriptor_set(renderer.get_frame_index()));
+
+    if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record secondary command buffer");
+    }
+    return draw_calls;
+}
+
+void ObjectRenderSystem::record_shapes(SdfBatch& shapes, const Renderer& renderer){
+    VkCommandBuffer& command_buffer = shape_commands[renderer.get_frame_index()];
+    begin_secondary(command_buffer, renderer, device.get_command_pool());
+
+    /* Binds its own pipeline over the object pipeline */
+    shapes.draw(command_buffer, renderer.get_frame_index(), camera.get_descriptor_set(renderer.get_frame_index()));
+
+    if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record secondary command buffer");
+    }
+}
+
+uint32_t ObjectRenderSystem::record_culled(const Renderer& renderer){
+    VkCommandBuffer& command_buffer = culled_commands[renderer.get_frame_index()];
+    begin_secondary(command_buffer, renderer, device.get_command_pool());
+
+    /* Binds its own pipeline over the object pipeline */
+    uint32_t draw_calls = gpu_culling->draw(command_buffer, renderer.get_frame_index(), camera.get_descriptor_set(renderer.get_frame_index()));
+
+    if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record secondary command buffer");
+    }
+    return draw_calls;
+}
+
+void ObjectRenderSystem::record_layer(LayerCommands& layer, const Renderer& renderer, const EntityStore& entities, const StaticBatch::Segment* first, const StaticBatch::Segment* last, float alpha, const std::vector<Affine2D>& world, glm::vec2 view_min, glm::vec2 view_max){
+    if(layer.command_pool == VK_NULL_HANDLE){
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.queueFamilyIndex = graphics_family;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if(vkCreateCommandPool(device.get_device(), &pool_info, nullptr, &layer.command_pool) != VK_SUCCESS){
+            VK_ERROR("failed to create layer command pool");
+        }
+    }
+    begin_secondary(layer.command_buffer, renderer, layer.command_pool);
+    VkCommandBuffer command_buffer = layer.command_buffer;
+    VkRect2D scissor = renderer.get_render_area();
+
+    const glm::vec2* translation = entities.translation.data();
+    const glm::vec2* previous = entities.previous_translation.data();
+    const glm::vec2* scale = entities.scale.data();
+    const glm::vec3* color = entities.color.data();
+    const std::shared_ptr<ObjectModel>* mesh = entities.mesh.data();
+    const NodeId* node = entities.node.data();
+
+    layer.uses_static_buffer = false;
+    layer.uses_scene = false;
+    layer.uses_alpha = false;
+    layer.culled = 0;
+    float depth = layer_depth(entities.layer[first->entity]);
+
+    /* Models created together share a vertex buffer, only rebind when it changes */
+    VkBuffer bound_buffer = VK_NULL_HANDLE;
+    for(const StaticBatch::Segment* segment = first; segment != last; segment++){
+        ObjectModel* model = segment->is_static ? nullptr : mesh[segment->entity].get();
+        if(!segment->is_static && model == nullptr){
+            continue;
+        }
 
-    for(auto& obj : objects){
         PushConstantData push{};
-        push.offset = obj->transform.translation - glm::vec2(1.0f);
-        push.color = obj->color;
-        push.transform = obj->transform.mat2();
+        push.depth = depth;
+        if(segment->is_static){
+            /* Static vertices are already in world space with their color */
+            push.offset = glm::vec2(0.0f);
+            push.color = glm::vec3(1.0f);
+            layer.uses_static_buffer = true;
+        } else {
+            uint32_t i = segment->entity;
+            Affine2D transform{previous[i] + (translation[i] - previous[i]) * alpha, scale[i]};
+            if(previous[i] != translation[i]){
+                layer.uses_alpha = true;
+            }
+            if(node[i] != NO_NODE){
+                transform = world[node[i]] * transform;
+                layer.uses_scene = true;
+                layer.uses_alpha = true;
+            }
+
+            glm::vec2 a = transform.apply(model->get_bounds_min());
+            glm::vec2 b = transform.apply(model->get_bounds_max());
+            if(glm::any(glm::lessThan(glm::max(a, b), view_min)) || glm::any(glm::greaterThan(glm::min(a, b), view_max))){
+                layer.culled++;
+                continue;
+            }
+            push.offset = transform.translation;
+            push.color = color[i];
+            push.transform = glm::mat2{{transform.scale.x, 0.0f}, {0.0f, transform.scale.y}};
+        }
 
         vkCmdPushConstants(
             command_buffer,
@@ -39,12 +416,50 @@ void ObjectRenderSystem::render_objects(VkCommandBuffer command_buffer, std::vec
             sizeof(PushConstantData),
             &push
         );
-        obj->model->bind(command_buffer);
-        obj->model->draw(command_buffer);
+        if(segment->is_static){
+            VkBuffer buffer = static_batch.get_chunk_buffer(segment->chunk);
+            if(buffer != bound_buffer){
+                VkDeviceSize offset = 0;
+                vkCmdBindVertexBuffers(command_buffer, 0, 1, &buffer, &offset);
+                bound_buffer = buffer;
+            }
+            vkCmdDraw(command_buffer, segment->vertex_count, 1, segment->first_vertex, 0);
+            continue;
+        }
+
+        if(model->get_buffer() != bound_buffer){
+            model->bind(command_buffer);
+            bound_buffer = model->get_buffer();
+        }
+        model->draw(command_buffer);
+    }
+
+    if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
+        VK_ERROR("failed to record secondary command buffer");
+    }
+
+    layer.layer_version = entities.get_layer_version(entities.layer[first->entity]);
+    layer.swapchain_version = renderer.get_swapchain_version();
+    layer.buffer_version = static_batch.get_buffer_version();
+    layer.scene_version = entities.scene.get_version();
+    layer.alpha = alpha;
+    layer.scissor = scissor;
+
+    /* A camera change can bring what was left out into view, only then */
+    layer.uses_camera = layer.culled > 0;
+    layer.camera_version = camera.get_version();
+}
+
+void ObjectRenderSystem::destroy_layer(LayerCommands& layer){
+    /* Destroying the pool frees the command buffer with it */
+    if(layer.command_pool != VK_NULL_HANDLE){
+        vkDestroyCommandPool(device.get_device(), layer.command_pool, nullptr);
     }
+    layer.command_pool = VK_NULL_HANDLE;
+    layer.command_buffer = VK_NULL_HANDLE;
 }
 
-void ObjectRenderSystem::create_pipline_layout(){
+void ObjectRenderSystem::create_pipline_layout(VkDescriptorSetLayout camera_layout){
     VkPushConstantRange push_constant_range = {};
     push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     push_constant_range.offset = 0;
@@ -52,8 +467,8 @@ void ObjectRenderSystem::create_pipline_layout(){
 
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 0;
-    pipeline_layout_info.pSetLayouts = nullptr;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &camera_layout;
     pipeline_layout_info.pushConstantRangeCount = 1;
     pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
@@ -12,7 +12,17 @@
 #include "Device/device.hpp"
 #include "Pipeline/pipeline.hpp"
 #include "Objects/object.hpp"
+#include "Entity/entity_store.hpp"
+#include "static_batch.hpp"
+#include "immediate_batch.hpp"
+#include "sdf_batch.hpp"
+#include "particle_system.hpp"
+#include "gpu_culling.hpp"
+#include "Timing/frame_stats.hpp"
+#include "Jobs/job_system.hpp"
+#include "Renderer/renderer.hpp"
 
+#include <map>
 #include <memory>
 
 namespace hop {
@@ -34,8 +44,13 @@ public:
      *
      * Constructor is resonsible for creating the graphics pipeline object.
      *
+     * @param device
+     * @param render_pass Render pass objects are drawn in
+     * @param camera Camera every object is projected with
+     * @param jobs Job system layers are culled and recorded on, nullptr
+     *             records them on the calling thread
      */
-    ObjectRenderSystem(Device& device, VkRenderPass render_pass);
+    ObjectRenderSystem(Device& device, VkRenderPass render_pass, CameraBuffer& camera, JobSystem* jobs = nullptr);
     
     /**
      * @brief Default deconstructor
@@ -46,27 +61,170 @@ public:
     ObjectRenderSystem(const ObjectRenderSystem&) = delete;
     ObjectRenderSystem& operator=(const ObjectRenderSystem&) = delete;
 
+    /**
+     * @brief Prepares the frame's objects before the render pass starts
+     *
+     * Promotes and demotes static entities, see StaticBatch, and with GPU
+     * culling records the culling pass.
+     *
+     * NOTE: Must be called once per drawn frame, before render_objects and
+     *       outside of a render pass
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @param renderer The renderer recording the frame
+     * @param entities Store holding the entities to draw
+     * @param alpha How far between the previous and current translation to draw
+     * @return void
+     */
+    void prepare(VkCommandBuffer command_buffer, const Renderer& renderer, EntityStore& entities, float alpha = 1.0f);
+
     /**
      * @brief Renders the all the objects
      *
-     * Renders the objects given in the command buffer.
+     * Renders every alive entity in the store, walking the store's columns in
+     * draw order. Entities that stopped changing are drawn from a merged
+     * buffer, see StaticBatch.
+     *
+     * Each layer is recorded into its own secondary command buffer, one per
+     * frame in flight. A layer's command buffer is reused as long as nothing
+     * it draws changed, so an unchanged scene costs one vkCmdExecuteCommands.
+     * Draws are scissored to the renderer's render area, a layer is recorded
+     * again when the area moves. Objects entirely outside what the camera
+     * shows of the area are left out of the recording, a layer that left
+     * objects out is recorded again when the camera changes. Otherwise
+     * moving the camera only changes its uniform buffer, see CameraBuffer.
+     *
+     * Layers that have to be recorded again are culled and recorded at the
+     * same time on the job system. Every layer allocates its command buffers
+     * from its own command pool, so no two threads ever record from the same
+     * pool.
+     *
+     * NOTE: The camera must have been updated for the frame
+     *
+     * With GPU culling every object is drawn from draws the culling pass
+     * wrote instead, see GpuCulling, and nothing is reused.
+     *
+     * Every layer is drawn at its own depth, see layer_depth, and layers are
+     * drawn front to back, so the depth test rejects the hidden fragments of
+     * lower layers before they're shaded. Within a layer objects share the
+     * depth and whatever is drawn first stays on top.
+     *
+     * Shapes in the immediate batch are recorded every frame and drawn before,
+     * and in front of, every object. SDF shapes and particles are recorded every
+     * frame too and drawn after every object, blended over everything, with
+     * particles last.
      *
      * NOTE: The transformation of each object are put in a push constant.
+     * NOTE: The render pass must have been started with
+     *       VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
      *
      * @param command_buffer list of operations vulkan needs to commit
-     * @param objects list of transformations that will be put on objects
+     * @param renderer The renderer recording the frame
+     * @param entities Store holding the entities to draw
+     * @param alpha How far between the previous and current translation to draw
+     * @param immediate Shapes drawn for this frame only, can be nullptr
+     * @param particles Particles to draw, can be nullptr
+     * @param shapes SDF shapes drawn for this frame only, can be nullptr
      * @return void
      */
-    void render_objects(VkCommandBuffer command_buffer, std::vector<std::shared_ptr<Object>>& objects);
+    void render_objects(VkCommandBuffer command_buffer, const Renderer& renderer, EntityStore& entities, float alpha = 1.0f, ImmediateBatch* immediate = nullptr, ParticleSystem* particles = nullptr, SdfBatch* shapes = nullptr);
+
+    /**
+     * @brief Turns GPU culling on or off
+     *
+     * @param enabled true to cull and generate draws in a compute shader
+     * @return false if GPU culling was asked for but isn't supported, objects
+     *         are then culled on the CPU
+     */
+    bool set_gpu_culling(bool enabled);
+    bool is_gpu_culling() const { return gpu_culling_enabled; }
+
+    /**
+     * @brief Draws layers front to back or back to front
+     *
+     * Back to front draws the same picture, the layers still have their own
+     * depth, but the depth test rejects nothing so every covered fragment is
+     * shaded. Only there to measure what front to back saves. Ignored with
+     * GPU culling.
+     *
+     * @param enabled true to draw the top layer first, the default
+     */
+    void set_front_to_back(bool enabled){ front_to_back = enabled; }
+
+    /**
+     * @brief Depth objects of a layer are drawn at
+     *
+     * Higher layers are nearer, all of them behind the immediate shapes at 0.
+     * Layers beyond +-LAYER_DEPTH_RANGE share the depth of the last one in
+     * range, the order the layers are drawn in still keeps them apart.
+     *
+     * @param layer
+     * @return Depth between 0.25 and 0.75
+     */
+    static float layer_depth(int layer);
+
+    StaticBatch& get_static_batch(){ return static_batch; }
+    RenderStats get_stats() const { return stats; }
+
+    static constexpr int LAYER_DEPTH_RANGE = 1 << 19;
 
 private:
-    void create_pipline_layout();
+    /**
+     * @brief Recorded draws of one layer
+     *
+     * What the recording depended on is kept so it's only recorded again when
+     * one of those things changed.
+     */
+    struct LayerCommands {
+        VkCommandPool command_pool = VK_NULL_HANDLE;
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        uint64_t layer_version = 0;
+        uint64_t swapchain_version = 0;
+        uint64_t buffer_version = 0;
+        uint64_t scene_version = 0;
+        float alpha = 0.0f;
+        VkRect2D scissor = {};
+        bool uses_static_buffer = false;
+        bool uses_scene = false;
+        bool uses_alpha = false;
+        bool uses_camera = false;
+        uint64_t camera_version = 0;
+        bool used = false;
+        uint32_t culled = 0;
+    };
+
+    bool is_current(const LayerCommands& layer, uint64_t layer_version, uint64_t swapchain_version, uint64_t scene_version, float alpha, const VkRect2D& scissor) const;
+    void begin_secondary(VkCommandBuffer& command_buffer, const Renderer& renderer, VkCommandPool command_pool);
+    void record_immediate(ImmediateBatch& immediate, const Renderer& renderer);
+    uint32_t record_particles(ParticleSystem& particles, const Renderer& renderer);
+    void record_shapes(SdfBatch& shapes, const Renderer& renderer);
+    uint32_t record_culled(const Renderer& renderer);
+    void record_layer(LayerCommands& layer, const Renderer& renderer, const EntityStore& entities, const StaticBatch::Segment* first, const StaticBatch::Segment* last, float alpha, const std::vector<Affine2D>& world, glm::vec2 view_min, glm::vec2 view_max);
+    void destroy_layer(LayerCommands& layer);
+
+    void create_pipline_layout(VkDescriptorSetLayout camera_layout);
     void create_pipeline(VkRenderPass render_pass);
 
     Device& device;
+    JobSystem* jobs;
+    uint32_t graphics_family = 0;
 
     std::unique_ptr<Pipeline> pipeline;
     VkPipelineLayout pipeline_layout;
+    StaticBatch static_batch;
+    CameraBuffer& camera;
+    RenderStats stats;
+    VkRenderPass render_pass;
+    std::unique_ptr<GpuCulling> gpu_culling;
+    bool gpu_culling_enabled = false;
+    bool front_to_back = true;
+
+    /* Per frame in flight, keyed by layer */
+    std::map<int, LayerCommands> layers[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    VkCommandBuffer immediate_commands[SwapChain::MAX_FRAMES_IN_FLIGHT] = {};
+    VkCommandBuffer particle_commands[SwapChain::MAX_FRAMES_IN_FLIGHT] = {};
+    VkCommandBuffer shape_commands[SwapChain::MAX_FRAMES_IN_FLIGHT] = {};
+    VkCommandBuffer culled_commands[SwapChain::MAX_FRAMES_IN_FLIGHT] = {};
 };
 
 }
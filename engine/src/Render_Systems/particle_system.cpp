@@ -0,0 +1,713 @@
+#include "particle_system.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace hop {
+
+/* Laid out like the push constants of particle.comp */
+struct ParticleComputePushConstants {
+    glm::vec4 color_start;
+    glm::vec4 color_end;
+    glm::vec2 position;
+    glm::vec2 gravity;
+    float delta_time;
+    float lifetime_min;
+    float lifetime_max;
+    float speed_min;
+    float speed_max;
+    float angle;
+    float spread;
+    float radius;
+    float size_start;
+    float size_end;
+    uint32_t spawn_count;
+    uint32_t seed;
+    uint32_t capacity;
+};
+
+std::vector<VkVertexInputBindingDescription> ParticleInstance::get_binding_descriptions(){
+    /* Binding 0 is the shared mesh, binding 1 steps once per particle */
+    std::vector<VkVertexInputBindingDescription> binding_descriptions(2);
+    binding_descriptions[0].binding = 0;
+    binding_descriptions[0].stride = sizeof(glm::vec2);
+    binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    binding_descriptions[1].binding = 1;
+    binding_descriptions[1].stride = sizeof(ParticleInstance);
+    binding_descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return binding_descriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> ParticleInstance::get_attribute_descriptions(){
+    std::vector<VkVertexInputAttributeDescription> attribute_descriptions(4);
+    attribute_descriptions[0].binding = 0;
+    attribute_descriptions[0].location = 0;
+    attribute_descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[0].offset = 0;
+
+    attribute_descriptions[1].binding = 1;
+    attribute_descriptions[1].location = 1;
+    attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[1].offset = offsetof(ParticleInstance, position);
+
+    attribute_descriptions[2].binding = 1;
+    attribute_descriptions[2].location = 2;
+    attribute_descriptions[2].format = VK_FORMAT_R32_SFLOAT;
+    attribute_descriptions[2].offset = offsetof(ParticleInstance, size);
+
+    attribute_descriptions[3].binding = 1;
+    attribute_descriptions[3].location = 3;
+    attribute_descriptions[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute_descriptions[3].offset = offsetof(ParticleInstance, color);
+    return attribute_descriptions;
+}
+
+ParticleEmitter::ParticleEmitter(const EmitterDesc& desc, glm::vec2 position, uint32_t seed)
+    : desc{desc}, position{position}, rng_state{seed == 0 ? 1u : seed} {
+    if(desc.simulate_on_gpu){
+        return;
+    }
+
+    /* Rounded up so the SIMD loops can always work on whole groups of four */
+    size_t capacity = (desc.max_particles + 3) & ~size_t(3);
+    position_x.resize(capacity);
+    position_y.resize(capacity);
+    velocity_x.resize(capacity);
+    velocity_y.resize(capacity);
+    age.resize(capacity);
+    inverse_lifetime.resize(capacity);
+}
+
+float ParticleEmitter::random(){
+    /* xorshift32, plenty for particles and much cheaper than <random> */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleEmitter::emit(uint32_t count){
+    if(destroyed){
+        return;
+    }
+    if(desc.simulate_on_gpu){
+        gpu_spawn = std::min(gpu_spawn + count, desc.max_particles);
+    } else {
+        spawn(count);
+    }
+}
+
+void ParticleEmitter::destroy(bool wait_for_particles){
+    destroyed = true;
+    if(!wait_for_particles){
+        live = 0;
+    }
+    drain_time = wait_for_particles ? desc.lifetime_max : 0.0f;
+}
+
+void ParticleEmitter::spawn(uint32_t count){
+    count = std::min(count, desc.max_particles - live);
+    float angle = glm::radians(desc.angle);
+    float spread = glm::radians(desc.spread);
+    for(uint32_t n = 0; n < count; n++){
+        uint32_t i = live++;
+        float direction = angle + (random() - 0.5f) * spread;
+        float speed = desc.speed_min + (desc.speed_max - desc.speed_min) * random();
+        float lifetime = desc.lifetime_min + (desc.lifetime_max - desc.lifetime_min) * random();
+
+        glm::vec2 start = position;
+        if(desc.radius > 0.0f){
+            float a = glm::two_pi<float>() * random();
+            float r = desc.radius * std::sqrt(random());
+            start += glm::vec2(std::cos(a), std::sin(a)) * r;
+        }
+
+        position_x[i] = start.x;
+        position_y[i] = start.y;
+        velocity_x[i] = std::cos(direction) * speed;
+        velocity_y[i] = std::sin(direction) * speed;
+        age[i] = 0.0f;
+        inverse_lifetime[i] = 1.0f / std::max(lifetime, 0.001f);
+    }
+}
+
+void ParticleEmitter::update(float delta_time){
+    if(desc.simulate_on_gpu){
+        /* The particles themselves are moved by the next dispatch */
+        gpu_time += delta_time;
+        if(destroyed){
+            drain_time -= delta_time;
+        } else if(desc.rate > 0.0f){
+            spawn_carry += desc.rate * delta_time;
+            uint32_t count_to_spawn = static_cast<uint32_t>(spawn_carry);
+            spawn_carry -= count_to_spawn;
+            gpu_spawn = std::min(gpu_spawn + count_to_spawn, desc.max_particles);
+        }
+        return;
+    }
+
+    /* Padding past live is integrated too, it's garbage that is never read */
+    size_t count = (live + 3) & ~size_t(3);
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128 dt = _mm_set1_ps(delta_time);
+    __m128 gx = _mm_set1_ps(desc.gravity.x * delta_time);
+    __m128 gy = _mm_set1_ps(desc.gravity.y * delta_time);
+    for(; i < count; i += 4){
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(&velocity_x[i]), gx);
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(&velocity_y[i]), gy);
+        _mm_storeu_ps(&velocity_x[i], vx);
+        _mm_storeu_ps(&velocity_y[i], vy);
+        _mm_storeu_ps(&position_x[i], _mm_add_ps(_mm_loadu_ps(&position_x[i]), _mm_mul_ps(vx, dt)));
+        _mm_storeu_ps(&position_y[i], _mm_add_ps(_mm_loadu_ps(&position_y[i]), _mm_mul_ps(vy, dt)));
+        _mm_storeu_ps(&age[i], _mm_add_ps(_mm_loadu_ps(&age[i]), dt));
+    }
+#endif
+    for(; i < count; i++){
+        velocity_x[i] += desc.gravity.x * delta_time;
+        velocity_y[i] += desc.gravity.y * delta_time;
+        position_x[i] += velocity_x[i] * delta_time;
+        position_y[i] += velocity_y[i] * delta_time;
+        age[i] += delta_time;
+    }
+
+    /* The last live particle takes the place of a dead one, keeping the pool packed */
+    for(uint32_t p = 0; p < live;){
+        if(age[p] * inverse_lifetime[p] < 1.0f){
+            p++;
+            continue;
+        }
+        live--;
+        position_x[p] = position_x[live];
+        position_y[p] = position_y[live];
+        velocity_x[p] = velocity_x[live];
+        velocity_y[p] = velocity_y[live];
+        age[p] = age[live];
+        inverse_lifetime[p] = inverse_lifetime[live];
+    }
+
+    if(!destroyed && desc.rate > 0.0f){
+        spawn_carry += desc.rate * delta_time;
+        uint32_t count_to_spawn = static_cast<uint32_t>(spawn_carry);
+        spawn_carry -= count_to_spawn;
+        spawn(count_to_spawn);
+    }
+
+    if(live == 0){
+        return;
+    }
+    glm::vec2 min(position_x[0], position_y[0]);
+    glm::vec2 max = min;
+    for(uint32_t p = 1; p < live; p++){
+        min = glm::min(min, glm::vec2(position_x[p], position_y[p]));
+        max = glm::max(max, glm::vec2(position_x[p], position_y[p]));
+    }
+    float size = std::max(std::abs(desc.size_start), std::abs(desc.size_end));
+    bounds_min = min - size;
+    bounds_max = max + size;
+}
+
+void ParticleEmitter::write_instances(ParticleInstance* out) const {
+    glm::vec4 color_start(desc.color_start, desc.alpha_start);
+    glm::vec4 color_change = glm::vec4(desc.color_end, desc.alpha_end) - color_start;
+    float size_change = desc.size_end - desc.size_start;
+
+    for(uint32_t p = 0; p < live; p++){
+        float t = age[p] * inverse_lifetime[p];
+        out[p].position = glm::vec2(position_x[p], position_y[p]);
+        out[p].size = desc.size_start + size_change * t;
+        out[p].padding = 0.0f;
+        out[p].color = color_start + color_change * t;
+    }
+}
+
+ParticleSystem::ParticleSystem(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout) : device{device} {
+    create_meshes();
+    create_pipeline_layout(camera_layout);
+    create_pipeline(render_pass);
+    if(device.supports_compute()){
+        create_compute_pipeline();
+    }
+}
+
+ParticleSystem::~ParticleSystem(){
+    for(auto& frame : frames){
+        release(frame);
+    }
+    for(auto& gpu : gpu_emitters){
+        release(gpu);
+    }
+    for(auto& slot : retired){
+        for(auto& gpu : slot){
+            release(gpu);
+        }
+    }
+    vkDestroyPipelineLayout(device.get_device(), pipeline_layout, nullptr);
+    VK_INFO("destroyed particle pipeline layout");
+
+    if(compute_pipeline != nullptr){
+        compute_pipeline.reset();
+        vkDestroyPipelineLayout(device.get_device(), compute_pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(device.get_device(), compute_set_layout, nullptr);
+        VK_INFO("destroyed particle compute pipeline layout");
+    }
+}
+
+std::shared_ptr<ParticleEmitter> ParticleSystem::create_emitter(glm::vec2 position, const EmitterDesc& desc){
+    EmitterDesc emitter_desc = desc;
+    if(emitter_desc.simulate_on_gpu && !supports_gpu()){
+        WARNING("PARTICLES", "graphics queue can't run compute shaders, simulating emitter on the CPU");
+        emitter_desc.simulate_on_gpu = false;
+    }
+
+    auto emitter = std::make_shared<ParticleEmitter>(emitter_desc, position, next_seed);
+    next_seed = next_seed * 747796405u + 2891336453u;
+    if(emitter_desc.simulate_on_gpu){
+        gpu_emitters.push_back(create_gpu_emitter(emitter));
+    } else {
+        emitters.push_back(emitter);
+    }
+    return emitter;
+}
+
+void ParticleSystem::update(float delta_time){
+    auto start = std::chrono::steady_clock::now();
+    live_count = 0;
+
+    glm::vec2 min(0.0f), max(0.0f);
+    for(auto it = emitters.begin(); it != emitters.end();){
+        ParticleEmitter& emitter = **it;
+        emitter.update(delta_time);
+        if(emitter.destroyed && emitter.live == 0){
+            it = emitters.erase(it);
+            continue;
+        }
+        if(emitter.live > 0){
+            min = live_count == 0 ? emitter.bounds_min : glm::min(min, emitter.bounds_min);
+            max = live_count == 0 ? emitter.bounds_max : glm::max(max, emitter.bounds_max);
+            live_count += emitter.live;
+        }
+        it++;
+    }
+
+    for(auto it = gpu_emitters.begin(); it != gpu_emitters.end();){
+        ParticleEmitter& emitter = *it->emitter;
+        emitter.update(delta_time);
+        if(emitter.destroyed && emitter.drain_time <= 0.0f){
+            retired[retire_slot].push_back(*it);
+            it = gpu_emitters.erase(it);
+            continue;
+        }
+        it++;
+    }
+
+    /* Where GPU particles are isn't known, they may be anywhere on screen */
+    if(!gpu_emitters.empty()){
+        bounds_min = glm::vec2(0.0f);
+        bounds_max = glm::vec2(2.0f);
+        update_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    /* Pixels with y going up to the 0 to 2 space with y going down */
+    bounds_min = glm::vec2(2.0f * min.x / resolution.x, 2.0f - 2.0f * max.y / resolution.y);
+    bounds_max = glm::vec2(2.0f * max.x / resolution.x, 2.0f - 2.0f * min.y / resolution.y);
+    update_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::dispatch(VkCommandBuffer command_buffer){
+    auto start = std::chrono::steady_clock::now();
+
+    /* This frame's fence was waited on, the oldest retired emitters are unused */
+    retire_slot = (retire_slot + 1) % RETIRE_SLOTS;
+    for(auto& gpu : retired[retire_slot]){
+        release(gpu);
+    }
+    retired[retire_slot].clear();
+
+    if(gpu_emitters.empty()){
+        dispatch_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    /*
+    The previous frame's draws must be done reading before anything is
+    written, and its dispatches done writing the particles read here
+    */
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr
+    );
+
+    for(auto& gpu : gpu_emitters){
+        if(!gpu.cleared){
+            /* Zeroed particles have no lifetime, so every slot starts dead */
+            vkCmdFillBuffer(command_buffer, gpu.particles, 0, VK_WHOLE_SIZE, 0);
+            gpu.cleared = true;
+        }
+        GpuDraw draw{};
+        draw.command.vertexCount = gpu.emitter->desc.shape == ParticleShape::CIRCLE ? circle_vertex_count : quad_vertex_count;
+        vkCmdUpdateBuffer(command_buffer, gpu.draw, 0, sizeof(GpuDraw), &draw);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr
+    );
+
+    compute_pipeline->bind(command_buffer);
+    for(auto& gpu : gpu_emitters){
+        ParticleEmitter& emitter = *gpu.emitter;
+        const EmitterDesc& desc = emitter.desc;
+
+        ParticleComputePushConstants push{};
+        push.color_start = glm::vec4(desc.color_start, desc.alpha_start);
+        push.color_end = glm::vec4(desc.color_end, desc.alpha_end);
+        push.position = emitter.position;
+        push.gravity = desc.gravity;
+        push.delta_time = emitter.gpu_time;
+        push.lifetime_min = desc.lifetime_min;
+        push.lifetime_max = desc.lifetime_max;
+        push.speed_min = desc.speed_min;
+        push.speed_max = desc.speed_max;
+        push.angle = glm::radians(desc.angle);
+        push.spread = glm::radians(desc.spread);
+        push.radius = desc.radius;
+        push.size_start = desc.size_start;
+        push.size_end = desc.size_end;
+        push.spawn_count = emitter.gpu_spawn;
+        emitter.random();
+        push.seed = emitter.rng_state;
+        push.capacity = desc.max_particles;
+
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute_pipeline_layout, 0, 1, &gpu.descriptor_set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, compute_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleComputePushConstants), &push);
+        vkCmdDispatch(command_buffer, (desc.max_particles + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        emitter.gpu_spawn = 0;
+        emitter.gpu_time = 0.0f;
+        gpu.dispatched = true;
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr
+    );
+    dispatch_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ParticleSystem::upload(int frame_index){
+    FrameBuffer& frame = frames[frame_index];
+    frame.ranges.clear();
+    if(live_count == 0){
+        return std::any_of(gpu_emitters.begin(), gpu_emitters.end(), [](const GpuEmitter& gpu){ return gpu.dispatched; });
+    }
+    reserve(frame, live_count);
+
+    auto* out = static_cast<ParticleInstance*>(frame.mapped);
+    uint32_t first = 0;
+    for(const auto& emitter : emitters){
+        if(emitter->live == 0){
+            continue;
+        }
+        emitter->write_instances(out + first);
+        frame.ranges.push_back({first, emitter->live, emitter->desc.shape});
+        first += emitter->live;
+    }
+    return true;
+}
+
+uint32_t ParticleSystem::draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set){
+    FrameBuffer& frame = frames[frame_index];
+    bool any_gpu = std::any_of(gpu_emitters.begin(), gpu_emitters.end(), [](const GpuEmitter& gpu){ return gpu.dispatched; });
+    if(frame.ranges.empty() && !any_gpu){
+        return 0;
+    }
+
+    /* Particles are in world pixels, the camera projects them */
+    pipeline->bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &camera_set, 0, nullptr);
+
+    /* One instanced draw per emitter, the mesh only changes between shapes */
+    VkDeviceSize offset = 0;
+    ParticleShape bound = ParticleShape::QUAD;
+    bool any_bound = false;
+    auto bind_mesh = [&](ParticleShape shape){
+        if(!any_bound || shape != bound){
+            VkBuffer mesh = shape == ParticleShape::CIRCLE ? circle_mesh->get_buffer() : quad_mesh->get_buffer();
+            vkCmdBindVertexBuffers(command_buffer, 0, 1, &mesh, &offset);
+            bound = shape;
+            any_bound = true;
+        }
+    };
+
+    uint32_t draw_calls = 0;
+    if(!frame.ranges.empty()){
+        VkBuffer instances = frame.buffer;
+        vkCmdBindVertexBuffers(command_buffer, 1, 1, &instances, &offset);
+        for(const Range& range : frame.ranges){
+            bind_mesh(range.shape);
+            uint32_t vertex_count = range.shape == ParticleShape::CIRCLE ? circle_vertex_count : quad_vertex_count;
+            vkCmdDraw(command_buffer, vertex_count, range.count, 0, range.first);
+            draw_calls++;
+        }
+    }
+
+    /* Instance and vertex counts were written by the compute shader */
+    for(const auto& gpu : gpu_emitters){
+        if(!gpu.dispatched){
+            continue;
+        }
+        bind_mesh(gpu.emitter->desc.shape);
+        vkCmdBindVertexBuffers(command_buffer, 1, 1, &gpu.instances, &offset);
+        vkCmdDrawIndirect(command_buffer, gpu.draw, 0, 1, sizeof(VkDrawIndirectCommand));
+        draw_calls++;
+    }
+    return draw_calls;
+}
+
+void ParticleSystem::set_resolution(int width, int height){
+    resolution = glm::vec2(std::max(width, 1), std::max(height, 1));
+}
+
+void ParticleSystem::create_meshes(){
+    std::vector<glm::vec2> quad = {
+        {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f},
+        {-1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}
+    };
+    quad_vertex_count = static_cast<uint32_t>(quad.size());
+    quad_mesh = std::make_unique<VertexBuffer>(device, quad.data(), sizeof(glm::vec2) * quad.size());
+
+    std::vector<glm::vec2> circle;
+    for(uint32_t i = 0; i < CIRCLE_SEGMENTS; i++){
+        float a0 = glm::two_pi<float>() * i / CIRCLE_SEGMENTS;
+        float a1 = glm::two_pi<float>() * (i + 1) / CIRCLE_SEGMENTS;
+        circle.push_back({0.0f, 0.0f});
+        circle.push_back({std::cos(a0), std::sin(a0)});
+        circle.push_back({std::cos(a1), std::sin(a1)});
+    }
+    circle_vertex_count = static_cast<uint32_t>(circle.size());
+    circle_mesh = std::make_unique<VertexBuffer>(device, circle.data(), sizeof(glm::vec2) * circle.size());
+}
+
+void ParticleSystem::create_pipeline_layout(VkDescriptorSetLayout camera_layout){
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &camera_layout;
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create particle pipeline layout");
+    }
+}
+
+void ParticleSystem::create_pipeline(VkRenderPass render_pass){
+    assert(pipeline_layout != nullptr);
+
+    PipelineConfigInfo pipeline_config = {};
+    Pipeline::default_config(pipeline_config);
+    pipeline_config.renderPass = render_pass;
+    pipeline_config.pipelineLayout = pipeline_layout;
+    pipeline_config.bindingDescriptions = ParticleInstance::get_binding_descriptions();
+    pipeline_config.attributeDescriptions = ParticleInstance::get_attribute_descriptions();
+
+    /* Drawn last and blended over whatever is below, without touching depth */
+    pipeline_config.depthStencilInfo.depthTestEnable = VK_FALSE;
+    pipeline_config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    pipeline_config.colorBlendAttachment.blendEnable = VK_TRUE;
+    pipeline_config.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    pipeline_config.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    pipeline_config.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+    pipeline = std::make_unique<Pipeline>(
+        device,
+        "../../engine/build/shaders/particle.vert.spv",
+        "../../engine/build/shaders/particle.frag.spv",
+        pipeline_config
+    );
+}
+
+void ParticleSystem::create_compute_pipeline(){
+    std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+    for(uint32_t i = 0; i < bindings.size(); i++){
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info{};
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    set_layout_info.pBindings = bindings.data();
+
+    if(vkCreateDescriptorSetLayout(device.get_device(), &set_layout_info, nullptr, &compute_set_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create particle descriptor set layout");
+    }
+
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(ParticleComputePushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &compute_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &compute_pipeline_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create particle compute pipeline layout");
+    }
+
+    compute_pipeline = std::make_unique<Pipeline>(
+        device,
+        "../../engine/build/shaders/particle.comp.spv",
+        compute_pipeline_layout
+    );
+}
+
+ParticleSystem::GpuEmitter ParticleSystem::create_gpu_emitter(std::shared_ptr<ParticleEmitter> emitter){
+    GpuEmitter gpu;
+    gpu.emitter = std::move(emitter);
+    uint32_t capacity = gpu.emitter->desc.max_particles;
+
+    device.create_buffer(
+        sizeof(GpuParticle) * capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        gpu.particles,
+        gpu.particle_memory
+    );
+    device.create_buffer(
+        sizeof(ParticleInstance) * capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        gpu.instances,
+        gpu.instance_memory
+    );
+    device.create_buffer(
+        sizeof(GpuDraw),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        gpu.draw,
+        gpu.draw_memory
+    );
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size.descriptorCount = 3;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+
+    if(vkCreateDescriptorPool(device.get_device(), &pool_info, nullptr, &gpu.descriptor_pool) != VK_SUCCESS){
+        VK_ERROR("failed to create particle descriptor pool");
+    }
+
+    VkDescriptorSetAllocateInfo allocation_info{};
+    allocation_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocation_info.descriptorPool = gpu.descriptor_pool;
+    allocation_info.descriptorSetCount = 1;
+    allocation_info.pSetLayouts = &compute_set_layout;
+
+    if(vkAllocateDescriptorSets(device.get_device(), &allocation_info, &gpu.descriptor_set) != VK_SUCCESS){
+        VK_ERROR("failed to allocate particle descriptor set");
+    }
+
+    VkDescriptorBufferInfo buffer_infos[3] = {
+        {gpu.particles, 0, VK_WHOLE_SIZE},
+        {gpu.instances, 0, VK_WHOLE_SIZE},
+        {gpu.draw, 0, VK_WHOLE_SIZE}
+    };
+    VkWriteDescriptorSet writes[3] = {};
+    for(uint32_t i = 0; i < 3; i++){
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = gpu.descriptor_set;
+        writes[i].dstBinding = i;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &buffer_infos[i];
+    }
+    vkUpdateDescriptorSets(device.get_device(), 3, writes, 0, nullptr);
+    return gpu;
+}
+
+void ParticleSystem::release(GpuEmitter& gpu){
+    VkDevice vk_device = device.get_device();
+    vkDestroyDescriptorPool(vk_device, gpu.descriptor_pool, nullptr);
+    vkDestroyBuffer(vk_device, gpu.particles, nullptr);
+    vkFreeMemory(vk_device, gpu.particle_memory, nullptr);
+    vkDestroyBuffer(vk_device, gpu.instances, nullptr);
+    vkFreeMemory(vk_device, gpu.instance_memory, nullptr);
+    vkDestroyBuffer(vk_device, gpu.draw, nullptr);
+    vkFreeMemory(vk_device, gpu.draw_memory, nullptr);
+    gpu = GpuEmitter{};
+}
+
+void ParticleSystem::reserve(FrameBuffer& frame, size_t count){
+    if(count <= frame.capacity){
+        return;
+    }
+
+    /* The frame's last use has finished, the old buffer can go right away */
+    release(frame);
+    frame.capacity = std::max(MIN_CAPACITY, count + count / 2);
+
+    VkDeviceSize size = sizeof(ParticleInstance) * frame.capacity;
+    device.create_buffer(
+        size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.buffer,
+        frame.memory
+    );
+    if(vkMapMemory(device.get_device(), frame.memory, 0, size, 0, &frame.mapped) != VK_SUCCESS){
+        VK_ERROR("failed to map particle instance buffer");
+    }
+}
+
+void ParticleSystem::release(FrameBuffer& frame){
+    if(frame.buffer == VK_NULL_HANDLE){
+        return;
+    }
+    vkUnmapMemory(device.get_device(), frame.memory);
+    vkDestroyBuffer(device.get_device(), frame.buffer, nullptr);
+    vkFreeMemory(device.get_device(), frame.memory, nullptr);
+    frame = FrameBuffer{};
+}
+
+}
@@ -0,0 +1,391 @@
+/**
+ * @file particle_system.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Emitters of many short lived particles, simulated on the CPU or in a
+ * compute shader and drawn with one instanced draw per emitter
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Objects/object.hpp"
+#include "Pipeline/pipeline.hpp"
+#include "Renderer/camera.hpp"
+#include "Swapchain/swapchain.hpp"
+#include "Timing/frame_stats.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hop {
+
+enum class ParticleShape : uint8_t {
+    QUAD,
+    CIRCLE
+};
+
+/**
+ * @brief How an emitter spawns and draws its particles
+ *
+ * Every particle starts at the emitter, up to radius pixels away, and flies
+ * off at a random speed in a random direction within spread degrees around
+ * angle. Angle 0 is right and 90 is up. Size is the half width of a quad or
+ * the radius of a circle, in pixels. Size and color fade from their start to
+ * their end value over the particle's life.
+ *
+ * An emitter simulated on the GPU never has its particles on the CPU, so
+ * their count and bounds are unknown and the whole screen is redrawn while
+ * the emitter is alive. Use it for effects too large to update on the CPU.
+ */
+struct EmitterDesc {
+    ParticleShape shape = ParticleShape::QUAD;
+    uint32_t max_particles = 1000;
+    float rate = 100.0f;
+    float lifetime_min = 0.5f;
+    float lifetime_max = 1.0f;
+    float speed_min = 50.0f;
+    float speed_max = 200.0f;
+    float angle = 90.0f;
+    float spread = 360.0f;
+    float radius = 0.0f;
+    glm::vec2 gravity = glm::vec2(0.0f, -200.0f);
+    float size_start = 4.0f;
+    float size_end = 0.0f;
+    glm::vec3 color_start = glm::vec3(1.0f);
+    glm::vec3 color_end = glm::vec3(1.0f);
+    float alpha_start = 1.0f;
+    float alpha_end = 0.0f;
+    bool simulate_on_gpu = false;
+};
+
+/**
+ * @brief One particle as the vertex shader reads it
+ */
+struct ParticleInstance {
+    glm::vec2 position;
+    float size;
+    float padding;
+    glm::vec4 color;
+
+    static std::vector<VkVertexInputBindingDescription> get_binding_descriptions();
+    static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
+};
+
+/**
+ * @brief One particle of a GPU emitter, as the compute shader reads it
+ */
+struct GpuParticle {
+    glm::vec2 position;
+    glm::vec2 velocity;
+    float age;
+    float lifetime;
+    glm::vec2 padding;
+};
+
+/**
+ * @brief Indirect draw of a GPU emitter
+ *
+ * The compute shader counts the instances it writes into command and the
+ * particles it spawns into spawned.
+ */
+struct GpuDraw {
+    VkDrawIndirectCommand command;
+    uint32_t spawned;
+    uint32_t padding[3];
+};
+
+/**
+ * @brief Spawns and moves particles
+ *
+ * Particles live in a pool of max_particles slots allocated up front, each
+ * property its own array. Live particles are kept at the front of the arrays,
+ * a particle that dies is overwritten by the last live one, so updating is a
+ * straight walk over floats done four at a time with SSE where available.
+ * Once the pool is full new particles are dropped.
+ *
+ * Positions are in pixels, with y going up like game objects.
+ *
+ * A GPU emitter has no pool on the CPU, it only counts how many particles
+ * to spawn and how much time passed for the next dispatch.
+ */
+class ParticleEmitter {
+public:
+    ParticleEmitter(const EmitterDesc& desc, glm::vec2 position, uint32_t seed);
+
+    // Prevents copying of this object
+    ParticleEmitter(const ParticleEmitter&) = delete;
+    ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+    /**
+     * @brief Spawns particles right away, on top of the ones spawned by rate
+     * @param count Amount of particles
+     * @return void
+     */
+    void emit(uint32_t count);
+
+    /**
+     * @brief Removes the emitter
+     *
+     * @param wait_for_particles Keep drawing the particles already spawned
+     *                           until they died, instead of removing them too
+     * @return void
+     */
+    void destroy(bool wait_for_particles = true);
+
+    void set_position(int x, int y){ position = glm::vec2(x, y); }
+    void move(int x_offset, int y_offset){ position += glm::vec2(x_offset, y_offset); }
+    glm::vec2 get_position() const { return position; }
+    void set_rate(float particles_per_second){ desc.rate = particles_per_second > 0.0f ? particles_per_second : 0.0f; }
+    float get_rate() const { return desc.rate; }
+    /* Always 0 for GPU emitters */
+    uint32_t get_live_count() const { return live; }
+    bool is_destroyed() const { return destroyed; }
+    const EmitterDesc& get_desc() const { return desc; }
+
+private:
+    friend class ParticleSystem;
+
+    void update(float delta_time);
+    void spawn(uint32_t count);
+    void write_instances(ParticleInstance* out) const;
+    float random();
+
+    EmitterDesc desc;
+    glm::vec2 position;
+    uint32_t rng_state;
+    float spawn_carry = 0.0f;
+    bool destroyed = false;
+
+    /* GPU emitters, what the next dispatch spawns and advances by */
+    uint32_t gpu_spawn = 0;
+    float gpu_time = 0.0f;
+    /* Seconds the particles of a destroyed GPU emitter may still be alive */
+    float drain_time = 0.0f;
+
+    /* Pool, the first live entries are alive */
+    uint32_t live = 0;
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> age;
+    std::vector<float> inverse_lifetime;
+
+    /* Box around the live particles in pixels, grown by the largest size */
+    glm::vec2 bounds_min = glm::vec2(0.0f);
+    glm::vec2 bounds_max = glm::vec2(0.0f);
+};
+
+/**
+ * @brief Updates and draws every emitter
+ *
+ * Every frame the particles of every emitter are written into one host
+ * visible instance buffer owned by the frame in flight, the same way as
+ * ImmediateBatch. Each emitter is then drawn with a single instanced draw of
+ * a shared unit quad or circle, so a particle costs 32 bytes and no draw call.
+ *
+ * GPU emitters keep their particles in device local buffers. Each frame,
+ * before the render pass, a compute shader moves them, respawns dead ones and
+ * appends the live ones to an instance buffer, counting them into the
+ * instance count of an indirect draw. The CPU only records a dispatch and a
+ * draw per emitter. Only core features are used (compute, storage buffer
+ * atomics and single indirect draws with first instance 0) so it also runs
+ * on software drivers like lavapipe.
+ *
+ * Particles are blended with their alpha and drawn after, so on top of,
+ * everything else.
+ */
+class ParticleSystem {
+public:
+    static constexpr uint32_t CIRCLE_SEGMENTS = 16;
+
+    /**
+     * @brief Constructor
+     *
+     * Creates the shared meshes and the particle pipeline.
+     *
+     * @param device
+     * @param render_pass Render pass the particles are drawn in
+     * @param camera_layout Layout of the camera's descriptor set, see CameraBuffer
+     */
+    ParticleSystem(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the buffers may still be in flight
+     */
+    ~ParticleSystem();
+
+    // Prevents copying of this object
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    /**
+     * @brief Creates an emitter
+     *
+     * @param position Where particles spawn, in pixels
+     * @param desc How particles spawn and look
+     * @return The emitter, kept by the system until it's destroyed
+     */
+    std::shared_ptr<ParticleEmitter> create_emitter(glm::vec2 position, const EmitterDesc& desc);
+
+    /**
+     * @brief Moves and spawns the particles of every emitter
+     *
+     * Emitters that were destroyed and have no particles left are dropped.
+     *
+     * @param delta_time Seconds since the last update
+     * @return void
+     */
+    void update(float delta_time);
+
+    /**
+     * @brief Records the simulation of every GPU emitter
+     *
+     * Advances each GPU emitter by the time since its last dispatch, with
+     * barriers so the previous frame's draws finish reading first and this
+     * frame's draws wait for the results.
+     *
+     * NOTE: Must be recorded outside of a render pass, once per drawn frame,
+     *       after the frame's fence was waited on
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @return void
+     */
+    void dispatch(VkCommandBuffer command_buffer);
+
+    /**
+     * @brief Writes the particles into the buffer of a frame in flight
+     *
+     * NOTE: The GPU must be done with the frame's previous use of the buffer
+     *
+     * @param frame_index Frame in flight the particles are drawn in
+     * @return false if there is nothing to draw, GPU emitters included
+     */
+    bool upload(int frame_index);
+
+    /**
+     * @brief Draws every emitter's particles
+     *
+     * Binds the particle pipeline, the viewport and scissor must already be
+     * set.
+     *
+     * @param command_buffer Command buffer to record the draws into
+     * @param frame_index Same frame as the last upload
+     * @param camera_set Camera descriptor set of the frame
+     * @return Amount of draw calls recorded
+     */
+    uint32_t draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set);
+
+    /**
+     * @brief Sets the size of the screen in pixels
+     *
+     * Used to give the bounds of particles in the same space as game
+     * objects, the camera projects the particles themselves.
+     *
+     * @param width
+     * @param height
+     * @return void
+     */
+    void set_resolution(int width, int height);
+
+    /* Live particles of CPU emitters */
+    uint32_t get_live_count() const { return live_count; }
+    float get_update_time() const { return update_time; }
+    float get_dispatch_time() const { return dispatch_time; }
+    size_t get_gpu_emitter_count() const { return gpu_emitters.size(); }
+    bool supports_gpu() const { return compute_pipeline != nullptr; }
+
+    ParticleStats get_stats() const {
+        return { live_count, update_time, dispatch_time, static_cast<uint32_t>(gpu_emitters.size()) };
+    }
+
+    /**
+     * @brief Checks if anything may be drawn
+     * @return true if a CPU emitter has live particles or a GPU emitter exists
+     */
+    bool has_particles() const { return live_count > 0 || !gpu_emitters.empty(); }
+
+    /* Box around every particle, in the same 0 to 2 space as object vertices */
+    glm::vec2 get_bounds_min() const { return bounds_min; }
+    glm::vec2 get_bounds_max() const { return bounds_max; }
+
+private:
+    /* Instances of one emitter in a frame's buffer */
+    struct Range {
+        uint32_t first;
+        uint32_t count;
+        ParticleShape shape;
+    };
+
+    struct FrameBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        size_t capacity = 0;
+        std::vector<Range> ranges;
+    };
+
+    /* Buffers of a GPU emitter, every one device local */
+    struct GpuEmitter {
+        std::shared_ptr<ParticleEmitter> emitter;
+        VkBuffer particles = VK_NULL_HANDLE;
+        VkDeviceMemory particle_memory = VK_NULL_HANDLE;
+        VkBuffer instances = VK_NULL_HANDLE;
+        VkDeviceMemory instance_memory = VK_NULL_HANDLE;
+        VkBuffer draw = VK_NULL_HANDLE;
+        VkDeviceMemory draw_memory = VK_NULL_HANDLE;
+        VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+        bool cleared = false;
+        bool dispatched = false;
+    };
+
+    static constexpr size_t MIN_CAPACITY = 1024;
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+    /* A removed GPU emitter is freed once no frame in flight can use it */
+    static constexpr size_t RETIRE_SLOTS = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+
+    void create_meshes();
+    void create_pipeline_layout(VkDescriptorSetLayout camera_layout);
+    void create_pipeline(VkRenderPass render_pass);
+    void create_compute_pipeline();
+    void reserve(FrameBuffer& frame, size_t count);
+    void release(FrameBuffer& frame);
+    GpuEmitter create_gpu_emitter(std::shared_ptr<ParticleEmitter> emitter);
+    void release(GpuEmitter& emitter);
+
+    Device& device;
+    std::unique_ptr<Pipeline> pipeline;
+    VkPipelineLayout pipeline_layout;
+    std::unique_ptr<VertexBuffer> quad_mesh;
+    std::unique_ptr<VertexBuffer> circle_mesh;
+    uint32_t quad_vertex_count = 0;
+    uint32_t circle_vertex_count = 0;
+
+    std::unique_ptr<Pipeline> compute_pipeline;
+    VkPipelineLayout compute_pipeline_layout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout compute_set_layout = VK_NULL_HANDLE;
+
+    std::vector<std::shared_ptr<ParticleEmitter>> emitters;
+    std::vector<GpuEmitter> gpu_emitters;
+    std::vector<GpuEmitter> retired[RETIRE_SLOTS];
+    size_t retire_slot = 0;
+    FrameBuffer frames[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    uint32_t next_seed = 1;
+    uint32_t live_count = 0;
+    float update_time = 0.0f;
+    float dispatch_time = 0.0f;
+    glm::vec2 resolution = glm::vec2(800.0f, 600.0f);
+    glm::vec2 bounds_min = glm::vec2(0.0f);
+    glm::vec2 bounds_max = glm::vec2(0.0f);
+};
+
+}
@@ -0,0 +1,213 @@
+#include "sdf_batch.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace hop {
+
+std::vector<VkVertexInputBindingDescription> SdfInstance::get_binding_descriptions(){
+    /* No vertex buffer, the quad's corners come from gl_VertexIndex */
+    std::vector<VkVertexInputBindingDescription> binding_descriptions(1);
+    binding_descriptions[0].binding = 0;
+    binding_descriptions[0].stride = sizeof(SdfInstance);
+    binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return binding_descriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> SdfInstance::get_attribute_descriptions(){
+    std::vector<VkVertexInputAttributeDescription> attribute_descriptions(6);
+    attribute_descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[0].offset = offsetof(SdfInstance, center);
+    attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[1].offset = offsetof(SdfInstance, half_size);
+    attribute_descriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[2].offset = offsetof(SdfInstance, axis);
+
+    /* Radius and thickness are read together */
+    attribute_descriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
+    attribute_descriptions[3].offset = offsetof(SdfInstance, radius);
+    attribute_descriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attribute_descriptions[4].offset = offsetof(SdfInstance, color);
+    attribute_descriptions[5].format = VK_FORMAT_R32_UINT;
+    attribute_descriptions[5].offset = offsetof(SdfInstance, shape);
+
+    for(uint32_t i = 0; i < attribute_descriptions.size(); i++){
+        attribute_descriptions[i].binding = 0;
+        attribute_descriptions[i].location = i;
+    }
+    return attribute_descriptions;
+}
+
+SdfBatch::SdfBatch(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout) : device{device} {
+    create_pipeline_layout(camera_layout);
+    create_pipeline(render_pass);
+}
+
+SdfBatch::~SdfBatch(){
+    for(auto& frame : frames){
+        release(frame);
+    }
+    vkDestroyPipelineLayout(device.get_device(), pipeline_layout, nullptr);
+    VK_INFO("destroyed sdf pipeline layout");
+}
+
+void SdfBatch::add_circle(glm::vec2 center, float radius, const glm::vec3& color){
+    add({center, glm::vec2(radius), glm::vec2(1.0f, 0.0f), radius, 0.0f, color, SdfShape::CIRCLE});
+}
+
+void SdfBatch::add_rounded_rect(glm::vec2 min, glm::vec2 max, float corner_radius, const glm::vec3& color){
+    glm::vec2 half_size = (max - min) * 0.5f;
+    corner_radius = std::clamp(corner_radius, 0.0f, std::min(half_size.x, half_size.y));
+    add({(min + max) * 0.5f, half_size, glm::vec2(1.0f, 0.0f), corner_radius, 0.0f, color, SdfShape::ROUNDED_RECT});
+}
+
+void SdfBatch::add_ring(glm::vec2 center, float radius, float thickness, const glm::vec3& color){
+    glm::vec2 half_size(radius + thickness * 0.5f);
+    add({center, half_size, glm::vec2(1.0f, 0.0f), radius, thickness, color, SdfShape::RING});
+}
+
+void SdfBatch::add_capsule(glm::vec2 p1, glm::vec2 p2, float radius, const glm::vec3& color){
+    /* The quad runs along the capsule, so it stays tight at any angle */
+    glm::vec2 direction = p2 - p1;
+    float length = glm::length(direction);
+    glm::vec2 axis = length > 0.0f ? direction / length : glm::vec2(1.0f, 0.0f);
+    glm::vec2 half_size(length * 0.5f + radius, radius);
+    add({(p1 + p2) * 0.5f, half_size, axis, radius, 0.0f, color, SdfShape::CAPSULE});
+}
+
+void SdfBatch::add(const SdfInstance& instance){
+    /* Box around the rotated quad, with the pixel of padding the shader adds */
+    glm::vec2 half_size = instance.half_size + glm::vec2(1.0f);
+    glm::vec2 reach(
+        std::abs(instance.axis.x) * half_size.x + std::abs(instance.axis.y) * half_size.y,
+        std::abs(instance.axis.y) * half_size.x + std::abs(instance.axis.x) * half_size.y
+    );
+
+    /* Pixels are measured up from the bottom, object space down from the top */
+    glm::vec2 min = 2.0f * (instance.center - reach) / resolution;
+    glm::vec2 max = 2.0f * (instance.center + reach) / resolution;
+    min.y = 2.0f - min.y;
+    max.y = 2.0f - max.y;
+    std::swap(min.y, max.y);
+
+    if(instances.empty()){
+        bounds_min = min;
+        bounds_max = max;
+    } else {
+        bounds_min = glm::min(bounds_min, min);
+        bounds_max = glm::max(bounds_max, max);
+    }
+    instances.push_back(instance);
+}
+
+bool SdfBatch::upload(int frame_index){
+    FrameBuffer& frame = frames[frame_index];
+    frame.instance_count = static_cast<uint32_t>(instances.size());
+    if(instances.empty()){
+        return false;
+    }
+    reserve(frame, instances.size());
+
+    /* Blended without depth, so unlike ImmediateBatch the order is kept as is */
+    std::memcpy(frame.mapped, instances.data(), sizeof(SdfInstance) * instances.size());
+    return true;
+}
+
+void SdfBatch::draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set){
+    FrameBuffer& frame = frames[frame_index];
+    if(frame.instance_count == 0){
+        return;
+    }
+
+    pipeline->bind(command_buffer);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &camera_set, 0, nullptr);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &frame.buffer, &offset);
+    vkCmdDraw(command_buffer, QUAD_VERTICES, frame.instance_count, 0, 0);
+}
+
+void SdfBatch::clear(){
+    instances.clear();
+}
+
+void SdfBatch::set_resolution(int width, int height){
+    resolution = glm::vec2(std::max(width, 1), std::max(height, 1));
+}
+
+void SdfBatch::create_pipeline_layout(VkDescriptorSetLayout camera_layout){
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &camera_layout;
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create sdf pipeline layout");
+    }
+}
+
+void SdfBatch::create_pipeline(VkRenderPass render_pass){
+    assert(pipeline_layout != nullptr);
+
+    PipelineConfigInfo pipeline_config = {};
+    Pipeline::default_config(pipeline_config);
+    pipeline_config.renderPass = render_pass;
+    pipeline_config.pipelineLayout = pipeline_layout;
+    pipeline_config.bindingDescriptions = SdfInstance::get_binding_descriptions();
+    pipeline_config.attributeDescriptions = SdfInstance::get_attribute_descriptions();
+
+    /* Edges are partly covered pixels, blended over whatever is below */
+    pipeline_config.depthStencilInfo.depthTestEnable = VK_FALSE;
+    pipeline_config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    pipeline_config.colorBlendAttachment.blendEnable = VK_TRUE;
+    pipeline_config.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    pipeline_config.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    pipeline_config.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+    pipeline = std::make_unique<Pipeline>(
+        device,
+        "../../engine/build/shaders/sdf.vert.spv",
+        "../../engine/build/shaders/sdf.frag.spv",
+        pipeline_config
+    );
+}
+
+void SdfBatch::reserve(FrameBuffer& frame, size_t count){
+    if(count <= frame.capacity){
+        return;
+    }
+
+    /* The frame's last use has finished, the old buffer can go right away */
+    release(frame);
+    frame.capacity = std::max(MIN_CAPACITY, count + count / 2);
+
+    VkDeviceSize size = sizeof(SdfInstance) * frame.capacity;
+    device.create_buffer(
+        size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.buffer,
+        frame.memory
+    );
+    if(vkMapMemory(device.get_device(), frame.memory, 0, size, 0, &frame.mapped) != VK_SUCCESS){
+        VK_ERROR("failed to map sdf instance buffer");
+    }
+}
+
+void SdfBatch::release(FrameBuffer& frame){
+    if(frame.buffer == VK_NULL_HANDLE){
+        return;
+    }
+    vkUnmapMemory(device.get_device(), frame.memory);
+    vkDestroyBuffer(device.get_device(), frame.buffer, nullptr);
+    vkFreeMemory(device.get_device(), frame.memory, nullptr);
+    frame = FrameBuffer{};
+}
+
+}
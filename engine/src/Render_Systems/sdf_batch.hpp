@@ -0,0 +1,216 @@
+/**
+ * @file sdf_batch.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Circles, rounded rectangles, rings and capsules drawn for one frame as
+ * quads whose fragment shader evaluates the shape's signed distance field
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Pipeline/pipeline.hpp"
+#include "Renderer/camera.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hop {
+
+/* Same order as the constants in sdf.frag */
+enum class SdfShape : uint32_t {
+    CIRCLE,
+    ROUNDED_RECT,
+    RING,
+    CAPSULE
+};
+
+/**
+ * @brief One shape as the SDF vertex shader reads it
+ *
+ * The quad is centered on center and spans half_size along axis and its
+ * perpendicular, all in pixels. Radius is the circle's radius, the corner
+ * radius of a rounded rectangle, the middle radius of a ring or the radius of
+ * a capsule's ends. Thickness is only used by rings.
+ */
+struct SdfInstance {
+    glm::vec2 center;
+    glm::vec2 half_size;
+    glm::vec2 axis;
+    float radius;
+    float thickness;
+    glm::vec3 color;
+    SdfShape shape;
+
+    static std::vector<VkVertexInputBindingDescription> get_binding_descriptions();
+    static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
+};
+
+/**
+ * @brief Batch of analytic shapes drawn for a single frame
+ *
+ * Like ImmediateBatch, shapes are collected while the game updates, copied
+ * into a host visible buffer of the frame in flight and forgotten once the
+ * frame is recorded. Every shape is one instance of a 6 vertex quad, the
+ * fragment shader works out how much of each pixel the shape covers, so
+ * edges are exact and anti-aliased at any size. The whole batch is a single
+ * instanced draw.
+ *
+ * Edges are blended, so the batch is drawn after every object without
+ * depth, with later shapes on top of earlier ones.
+ *
+ * Positions are in world pixels, measured up from the bottom left, and
+ * projected by the camera.
+ *
+ * NOTE: The batch is immediate mode only, nothing in the entity store is
+ *       drawn with it. Retained shapes stay meshes, see CircleMeshes
+ */
+class SdfBatch {
+public:
+    /**
+     * @brief Constructor
+     * @param device
+     * @param render_pass Render pass the shapes are drawn in
+     * @param camera_layout Layout of the camera's descriptor set, see CameraBuffer
+     */
+    SdfBatch(Device& device, VkRenderPass render_pass, VkDescriptorSetLayout camera_layout);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the buffers may still be in flight
+     */
+    ~SdfBatch();
+
+    // Prevents copying of this object
+    SdfBatch(const SdfBatch&) = delete;
+    SdfBatch& operator=(const SdfBatch&) = delete;
+
+    /**
+     * @brief Adds a circle
+     * @param center Center of the circle
+     * @param radius Radius of the circle
+     * @param color Color of the circle
+     * @return void
+     */
+    void add_circle(glm::vec2 center, float radius, const glm::vec3& color);
+
+    /**
+     * @brief Adds a rectangle with rounded corners
+     * @param min Bottom left corner
+     * @param max Top right corner
+     * @param corner_radius Radius of the corners, limited to half the shorter side
+     * @param color Color of the rectangle
+     * @return void
+     */
+    void add_rounded_rect(glm::vec2 min, glm::vec2 max, float corner_radius, const glm::vec3& color);
+
+    /**
+     * @brief Adds a ring
+     * @param center Center of the ring
+     * @param radius Distance from the center to the middle of the ring
+     * @param thickness Width of the ring
+     * @param color Color of the ring
+     * @return void
+     */
+    void add_ring(glm::vec2 center, float radius, float thickness, const glm::vec3& color);
+
+    /**
+     * @brief Adds a capsule, a line with round ends
+     * @param p1 Center of the first end
+     * @param p2 Center of the second end
+     * @param radius Radius of the ends, half the capsule's width
+     * @param color Color of the capsule
+     * @return void
+     */
+    void add_capsule(glm::vec2 p1, glm::vec2 p2, float radius, const glm::vec3& color);
+
+    /**
+     * @brief Copies the shapes into the buffer of a frame in flight
+     *
+     * NOTE: The GPU must be done with the frame's previous use of the buffer
+     *
+     * @param frame_index Frame in flight the shapes are drawn in
+     * @return false if there is nothing to draw
+     */
+    bool upload(int frame_index);
+
+    /**
+     * @brief Draws every shape of a frame in flight
+     *
+     * Binds its own pipeline, the viewport and scissor must already be set.
+     *
+     * @param command_buffer Command buffer to record the draw into
+     * @param frame_index Same frame as the last upload
+     * @param camera_set Camera descriptor set of the frame
+     * @return void
+     */
+    void draw(VkCommandBuffer command_buffer, int frame_index, VkDescriptorSet camera_set);
+
+    /**
+     * @brief Forgets every shape, called once the frame was recorded
+     * @return void
+     */
+    void clear();
+
+    /**
+     * @brief Sets the size in pixels of the screen shapes are positioned on
+     * @param width
+     * @param height
+     * @return void
+     */
+    void set_resolution(int width, int height);
+
+    bool empty() const { return instances.empty(); }
+    uint32_t get_shape_count() const { return static_cast<uint32_t>(instances.size()); }
+
+    /**
+     * @brief Corners of the box around every shape, in the 0 to 2 space of
+     *        object vertices
+     *
+     * NOTE: Only valid while not empty
+     *
+     * @return Smallest and largest corner
+     */
+    glm::vec2 get_bounds_min() const { return bounds_min; }
+    glm::vec2 get_bounds_max() const { return bounds_max; }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 256;
+    static constexpr uint32_t QUAD_VERTICES = 6;
+
+    struct FrameBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        size_t capacity = 0;
+        uint32_t instance_count = 0;
+    };
+
+    void add(const SdfInstance& instance);
+    void create_pipeline_layout(VkDescriptorSetLayout camera_layout);
+    void create_pipeline(VkRenderPass render_pass);
+    void reserve(FrameBuffer& frame, size_t count);
+    void release(FrameBuffer& frame);
+
+    Device& device;
+    std::unique_ptr<Pipeline> pipeline;
+    VkPipelineLayout pipeline_layout;
+    FrameBuffer frames[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    std::vector<SdfInstance> instances;
+    glm::vec2 resolution = glm::vec2(800.0f, 600.0f);
+    glm::vec2 bounds_min = glm::vec2(0.0f);
+    glm::vec2 bounds_max = glm::vec2(0.0f);
+};
+
+}
@@ -0,0 +1,161 @@
+#include "static_batch.hpp"
+
+#include <algorithm>
+
+namespace hop {
+
+StaticBatch::StaticBatch(Device& device, int promotion_frames) : device{device}, promotion_frames{promotion_frames} {}
+
+void StaticBatch::set_promotion_frames(int frames){
+    promotion_frames = frames < 0 ? 0 : frames;
+}
+
+void StaticBatch::update(EntityStore& entities){
+    /* Called once per frame, chunks retired RETIRE_SLOTS frames ago are no longer drawn */
+    retire_slot = (retire_slot + 1) % RETIRE_SLOTS;
+    retired_chunks[retire_slot].clear();
+
+    const std::vector<uint32_t>& order = entities.get_draw_order();
+    if(promotion_frames == 0 && !chunks.empty()){
+        for(uint32_t i : order){
+            entities.set_static(i, false);
+        }
+        release_chunks();
+    }
+
+    if(order_version != entities.get_order_version() || static_version != entities.get_static_version()){
+        rebuild_segments(entities);
+    }
+
+    if(promotion_frames > 0){
+        promote(entities);
+    }
+
+    /* Demoted entities leave their vertices behind, only lay the chunks out again once most are unused */
+    if(used_vertices > 2 * live_vertices){
+        compact(entities);
+    }
+}
+
+void StaticBatch::promote(EntityStore& entities){
+    /* Only dynamic entities are checked, static ones demote themselves when touched */
+    uint64_t frame = entities.get_frame();
+    promoted.clear();
+    for(const auto& segment : segments){
+        if(segment.is_static){
+            continue;
+        }
+
+        uint32_t i = segment.entity;
+        if(frame - entities.changed_frame[i] < static_cast<uint64_t>(promotion_frames)
+            || entities.node[i] != NO_NODE
+            || entities.mesh[i] == nullptr
+            || entities.mesh[i]->get_vertex_count() > CHUNK_VERTICES){
+            continue;
+        }
+
+        /* Unchanged for a while, there is nothing left to interpolate */
+        entities.previous_translation[i] = entities.translation[i];
+        entities.set_static(i, true);
+        promoted.push_back(i);
+    }
+
+    if(!promoted.empty()){
+        append(entities, promoted);
+        rebuild_segments(entities);
+    }
+}
+
+void StaticBatch::append(EntityStore& entities, const std::vector<uint32_t>& added){
+    static_chunk.resize(entities.translation.size(), 0);
+    static_first.resize(entities.translation.size(), 0);
+    static_size.resize(entities.translation.size(), 0);
+
+    /* Vertices go in one upload per chunk, after what frames in flight may be drawing */
+    auto flush = [this](){
+        if(vertices.empty()){
+            return;
+        }
+        Chunk& chunk = chunks.back();
+        chunk.buffer->write(vertices.data(), sizeof(ObjectModel::Vertex) * vertices.size(), sizeof(ObjectModel::Vertex) * chunk.used);
+        chunk.used += static_cast<uint32_t>(vertices.size());
+        vertices.clear();
+    };
+
+    for(uint32_t i : added){
+        const auto& mesh_vertices = entities.mesh[i]->get_vertices();
+        uint32_t size = static_cast<uint32_t>(mesh_vertices.size());
+        if(chunks.empty() || chunks.back().used + vertices.size() + size > CHUNK_VERTICES){
+            flush();
+            chunks.push_back({std::make_shared<VertexBuffer>(device, sizeof(ObjectModel::Vertex) * CHUNK_VERTICES), 0});
+        }
+
+        static_chunk[i] = static_cast<uint32_t>(chunks.size() - 1);
+        static_first[i] = chunks.back().used + static_cast<uint32_t>(vertices.size());
+        static_size[i] = size;
+        for(const auto& v : mesh_vertices){
+            vertices.push_back({entities.translation[i] + entities.scale[i] * v.position, v.color * entities.color[i]});
+        }
+        used_vertices += size;
+        live_vertices += size;
+    }
+    flush();
+}
+
+void StaticBatch::compact(EntityStore& entities){
+    release_chunks();
+
+    /* Laid out in draw order so neighbouring static entities can share a draw call */
+    promoted.clear();
+    for(uint32_t i : entities.get_draw_order()){
+        if(entities.is_static[i]){
+            promoted.push_back(i);
+        }
+    }
+    append(entities, promoted);
+    rebuild_segments(entities);
+}
+
+void StaticBatch::release_chunks(){
+    for(Chunk& chunk : chunks){
+        retired_chunks[retire_slot].push_back(std::move(chunk.buffer));
+    }
+    chunks.clear();
+    std::fill(static_size.begin(), static_size.end(), 0);
+    used_vertices = 0;
+    live_vertices = 0;
+    buffer_version++;
+}
+
+void StaticBatch::rebuild_segments(EntityStore& entities){
+    segments.clear();
+    static_count = 0;
+    dynamic_count = 0;
+    live_vertices = 0;
+
+    for(uint32_t i : entities.get_draw_order()){
+        bool in_buffer = entities.is_static[i] && i < static_size.size() && static_size[i] > 0;
+        if(!in_buffer){
+            segments.push_back({false, i, 0, 0, 0});
+            dynamic_count++;
+            continue;
+        }
+
+        static_count++;
+        live_vertices += static_size[i];
+        /* A run never crosses layers, each layer is drawn and cached on its own */
+        if(!segments.empty() && segments.back().is_static
+            && entities.layer[segments.back().entity] == entities.layer[i]
+            && segments.back().chunk == static_chunk[i]
+            && segments.back().first_vertex + segments.back().vertex_count == static_first[i]){
+            segments.back().vertex_count += static_size[i];
+        } else {
+            segments.push_back({true, i, static_chunk[i], static_first[i], static_size[i]});
+        }
+    }
+
+    order_version = entities.get_order_version();
+    static_version = entities.get_static_version();
+}
+
+}
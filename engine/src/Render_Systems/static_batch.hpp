@@ -0,0 +1,163 @@
+/**
+ * @file static_batch.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Splits entities into a static set that is merged into one vertex buffer and
+ * a dynamic set that is drawn one entity at a time
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Objects/object.hpp"
+#include "Entity/entity_store.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Merges entities that stopped changing into a few vertex buffers
+ *
+ * Every frame the dynamic entities are checked, the ones that have not changed
+ * for a number of frames are promoted: their vertices are moved into world
+ * space, given their color, and appended to the spare space of a device local
+ * chunk buffer. Only the promoted vertices are uploaded, frames in flight
+ * keep drawing from the part of the chunk that was already filled. Touching a
+ * static entity in any way demotes it, see EntityStore::touch, which leaves
+ * its vertices unused in their chunk. Once more than half the vertices in the
+ * chunks are unused, the chunks are compacted: every static entity is laid
+ * out again in fresh chunks and the old ones are freed once no frame in
+ * flight draws from them.
+ *
+ * The entities are turned into a list of segments: a run of static entities
+ * next to each other in draw order, in the buffer and on the same layer,
+ * becomes one draw call, a dynamic entity is drawn on its own. Runs stop at
+ * layer boundaries so every layer only draws its own entities, see
+ * ObjectRenderSystem. Entities promoted together are appended in draw order,
+ * and compacting lays every chunk out in draw order, so most runs stay one
+ * draw. The segment list is only rebuilt when the draw order or the static
+ * set changes, so per frame cost depends on the amount of dynamic entities.
+ *
+ * NOTE: Entities attached to a scene node are never made static, their world
+ *       transform can change without the entity being touched
+ */
+class StaticBatch {
+public:
+    static constexpr int DEFAULT_PROMOTION_FRAMES = 60;
+
+    /**
+     * @brief A draw in the frame
+     *
+     * Either a range of a static chunk or a single dynamic entity
+     */
+    struct Segment {
+        bool is_static;
+        uint32_t entity;
+        uint32_t chunk;
+        uint32_t first_vertex;
+        uint32_t vertex_count;
+    };
+
+    /* Vertices in one chunk, entities with bigger meshes stay dynamic */
+    static constexpr uint32_t CHUNK_VERTICES = 1 << 16;
+
+    /**
+     * @brief Constructor
+     * @param device
+     * @param promotion_frames Frames an entity has to stay unchanged to be made static
+     */
+    StaticBatch(Device& device, int promotion_frames = DEFAULT_PROMOTION_FRAMES);
+
+    // Prevents copying of this object
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    /**
+     * @brief Promotes entities that stopped changing and rebuilds the segments
+     *
+     * Called once per frame before drawing.
+     *
+     * @param entities Store holding the entities
+     * @return void
+     */
+    void update(EntityStore& entities);
+
+    /**
+     * @brief Draws in draw order
+     * @return List of segments to draw
+     */
+    const std::vector<Segment>& get_segments() const { return segments; }
+
+    /**
+     * @brief Vertex buffer of a chunk
+     * @param chunk Chunk of a static segment
+     * @return The buffer holding the segment's vertices
+     */
+    VkBuffer get_chunk_buffer(uint32_t chunk) const { return chunks[chunk].buffer->get_buffer(); }
+
+    /**
+     * @brief Sets how many frames an entity has to stay unchanged to be made static
+     *
+     * @param frames Frame count, 0 disables promotion and demotes everything
+     * @return void
+     */
+    void set_promotion_frames(int frames);
+    int get_promotion_frames() const { return promotion_frames; }
+
+    /**
+     * @brief Counter that changes whenever the chunks are compacted or freed
+     *
+     * Appending never changes it, what was already in a chunk stays put.
+     *
+     * @return The version
+     */
+    uint64_t get_buffer_version() const { return buffer_version; }
+
+    uint32_t get_static_count() const { return static_count; }
+    uint32_t get_dynamic_count() const { return dynamic_count; }
+
+private:
+    struct Chunk {
+        std::shared_ptr<VertexBuffer> buffer;
+        uint32_t used = 0;
+    };
+
+    void promote(EntityStore& entities);
+    void append(EntityStore& entities, const std::vector<uint32_t>& added);
+    void compact(EntityStore& entities);
+    void release_chunks();
+    void rebuild_segments(EntityStore& entities);
+
+    Device& device;
+    int promotion_frames;
+
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> static_chunk;
+    std::vector<uint32_t> static_first;
+    std::vector<uint32_t> static_size;
+    std::vector<Segment> segments;
+    std::vector<uint32_t> promoted;
+    std::vector<ObjectModel::Vertex> vertices;
+
+    /* Chunks replaced by compacting, kept until no frame in flight can use them */
+    static constexpr size_t RETIRE_SLOTS = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+    std::vector<std::shared_ptr<VertexBuffer>> retired_chunks[RETIRE_SLOTS];
+    size_t retire_slot = 0;
+
+    uint32_t used_vertices = 0;
+    uint32_t live_vertices = 0;
+
+    uint64_t order_version = 0;
+    uint64_t static_version = 0;
+    uint64_t buffer_version = 0;
+    uint32_t static_count = 0;
+    uint32_t dynamic_count = 0;
+};
+
+}
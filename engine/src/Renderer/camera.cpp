@@ -0,0 +1,186 @@
+#include "camera.hpp"
+
+#include "Utilities/status_print.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hop {
+
+/* 2D affine transform p -> linear * p + translation as a 4x4 matrix that leaves z and w alone */
+static glm::mat4 to_mat4(const glm::mat2& linear, glm::vec2 translation){
+    glm::mat4 m(1.0f);
+    m[0] = glm::vec4(linear[0], 0.0f, 0.0f);
+    m[1] = glm::vec4(linear[1], 0.0f, 0.0f);
+    m[3] = glm::vec4(translation, 0.0f, 1.0f);
+    return m;
+}
+
+void Camera::set_resolution(int width, int height){
+    resolution = glm::vec2(std::max(width, 1), std::max(height, 1));
+    version++;
+}
+
+void Camera::set_position(glm::vec2 new_position){
+    if(new_position != position){
+        position = new_position;
+        version++;
+    }
+}
+
+void Camera::set_zoom(float new_zoom){
+    if(new_zoom != zoom){
+        zoom = new_zoom;
+        version++;
+    }
+}
+
+void Camera::set_rotation(float degrees){
+    if(degrees != rotation){
+        rotation = degrees;
+        version++;
+    }
+}
+
+void Camera::reset(){
+    set_position(glm::vec2(0.0f));
+    set_zoom(1.0f);
+    set_rotation(0.0f);
+}
+
+glm::mat4 Camera::get_pixel_view() const {
+    /* Around the center of the window: zoom, turn the world the other way, then to -1 to 1 with y down */
+    float angle = -glm::radians(rotation);
+    float c = glm::cos(angle);
+    float s = glm::sin(angle);
+    glm::mat2 turn{{c, s}, {-s, c}};
+    glm::mat2 to_ndc{{2.0f / resolution.x, 0.0f}, {0.0f, -2.0f / resolution.y}};
+    glm::mat2 linear = to_ndc * turn * zoom;
+    glm::vec2 center = position + resolution * 0.5f;
+    return to_mat4(linear, -(linear * center));
+}
+
+glm::mat4 Camera::get_view() const {
+    /* Object space spans 0 to 2 across the window with y down, world pixels have y up */
+    glm::mat4 to_pixels = to_mat4(glm::mat2{{resolution.x * 0.5f, 0.0f}, {0.0f, -resolution.y * 0.5f}}, glm::vec2(0.0f, resolution.y));
+    return get_pixel_view() * to_pixels;
+}
+
+glm::vec2 Camera::screen_to_world(glm::vec2 screen) const {
+    glm::vec2 ndc(2.0f * screen.x / resolution.x - 1.0f, 1.0f - 2.0f * screen.y / resolution.y);
+    return glm::vec2(glm::inverse(get_pixel_view()) * glm::vec4(ndc, 0.0f, 1.0f));
+}
+
+CameraBuffer::CameraBuffer(Device& device) : device{device} {
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    binding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info{};
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.bindingCount = 1;
+    set_layout_info.pBindings = &binding;
+
+    if(vkCreateDescriptorSetLayout(device.get_device(), &set_layout_info, nullptr, &set_layout) != VK_SUCCESS){
+        VK_ERROR("failed to create camera descriptor set layout");
+    }
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_size.descriptorCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = SwapChain::MAX_FRAMES_IN_FLIGHT;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+
+    if(vkCreateDescriptorPool(device.get_device(), &pool_info, nullptr, &descriptor_pool) != VK_SUCCESS){
+        VK_ERROR("failed to create camera descriptor pool");
+    }
+
+    /* Until the first update every frame draws the world as created */
+    view = Camera{}.get_view();
+    inverse_view = glm::inverse(view);
+    Uniform initial{view, Camera{}.get_pixel_view()};
+
+    for(auto& frame : frames){
+        device.create_buffer(
+            sizeof(Uniform),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.buffer,
+            frame.memory
+        );
+        if(vkMapMemory(device.get_device(), frame.memory, 0, sizeof(Uniform), 0, &frame.mapped) != VK_SUCCESS){
+            VK_ERROR("failed to map camera buffer");
+        }
+        std::memcpy(frame.mapped, &initial, sizeof(Uniform));
+
+        VkDescriptorSetAllocateInfo allocation_info{};
+        allocation_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocation_info.descriptorPool = descriptor_pool;
+        allocation_info.descriptorSetCount = 1;
+        allocation_info.pSetLayouts = &set_layout;
+
+        if(vkAllocateDescriptorSets(device.get_device(), &allocation_info, &frame.descriptor_set) != VK_SUCCESS){
+            VK_ERROR("failed to allocate camera descriptor set");
+        }
+
+        VkDescriptorBufferInfo buffer_info{frame.buffer, 0, sizeof(Uniform)};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frame.descriptor_set;
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write.pBufferInfo = &buffer_info;
+        vkUpdateDescriptorSets(device.get_device(), 1, &write, 0, nullptr);
+    }
+}
+
+CameraBuffer::~CameraBuffer(){
+    for(auto& frame : frames){
+        vkUnmapMemory(device.get_device(), frame.memory);
+        vkDestroyBuffer(device.get_device(), frame.buffer, nullptr);
+        vkFreeMemory(device.get_device(), frame.memory, nullptr);
+    }
+    vkDestroyDescriptorPool(device.get_device(), descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device.get_device(), set_layout, nullptr);
+    VK_INFO("destroyed camera buffers");
+}
+
+void CameraBuffer::update(int frame_index, const Camera& camera){
+    if(camera.get_version() != camera_version){
+        view = camera.get_view();
+        inverse_view = glm::inverse(view);
+        camera_version = camera.get_version();
+    }
+    Uniform uniform{view, camera.get_pixel_view()};
+    std::memcpy(frames[frame_index].mapped, &uniform, sizeof(Uniform));
+}
+
+void CameraBuffer::get_visible_bounds(VkRect2D area, VkExtent2D extent, glm::vec2& min, glm::vec2& max) const {
+    glm::vec2 ndc_min(2.0f * area.offset.x / extent.width - 1.0f, 2.0f * area.offset.y / extent.height - 1.0f);
+    glm::vec2 ndc_max(
+        2.0f * (area.offset.x + area.extent.width) / extent.width - 1.0f,
+        2.0f * (area.offset.y + area.extent.height) / extent.height - 1.0f
+    );
+    glm::vec2 corners[4] = {ndc_min, {ndc_max.x, ndc_min.y}, ndc_max, {ndc_min.x, ndc_max.y}};
+
+    min = glm::vec2(inverse_view * glm::vec4(corners[0], 0.0f, 1.0f));
+    max = min;
+    for(const glm::vec2& corner : corners){
+        glm::vec2 p(inverse_view * glm::vec4(corner, 0.0f, 1.0f));
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+}
+
+}
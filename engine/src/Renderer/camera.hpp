@@ -0,0 +1,184 @@
+/**
+ * @file camera.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * 2D camera that pans, zooms and rotates the view of the world, and the
+ * uniform buffer shaders read its projection from
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace hop {
+
+/**
+ * @brief What part of the world is shown in the window
+ *
+ * Position is the world pixel shown at the bottom left corner of the window,
+ * the default (0, 0) shows the world as it was created. Zoom and rotation are
+ * around the center of the window, a zoom of 2 shows everything twice as big
+ * and a positive rotation turns the view counter clockwise, in degrees.
+ *
+ * Moving the camera never touches the objects, only the projection the
+ * shaders use changes, see CameraBuffer.
+ */
+class Camera {
+public:
+    /**
+     * @brief Sets the size of the window in pixels
+     * @param width
+     * @param height
+     * @return void
+     */
+    void set_resolution(int width, int height);
+
+    void set_position(glm::vec2 new_position);
+    void move(glm::vec2 delta){ set_position(position + delta); }
+    void set_zoom(float new_zoom);
+    void set_rotation(float degrees);
+
+    /**
+     * @brief Puts the camera back where it started
+     * @return void
+     */
+    void reset();
+
+    glm::vec2 get_position() const { return position; }
+    float get_zoom() const { return zoom; }
+    float get_rotation() const { return rotation; }
+
+    /**
+     * @brief Projection of object space, the 0 to 2 space object vertices
+     *        are in, to normalized device coordinates
+     * @return The projection, only x and y are changed
+     */
+    glm::mat4 get_view() const;
+
+    /**
+     * @brief Projection of world pixels, measured up from the bottom left, to
+     *        normalized device coordinates
+     * @return The projection, only x and y are changed
+     */
+    glm::mat4 get_pixel_view() const;
+
+    /**
+     * @brief Converts a point on the window to the world pixel shown there
+     * @param screen Pixel on the window, measured from the bottom left
+     * @return The world pixel
+     */
+    glm::vec2 screen_to_world(glm::vec2 screen) const;
+
+    /**
+     * @brief Counter that changes whenever the camera changes
+     * @return The version
+     */
+    uint64_t get_version() const { return version; }
+
+private:
+    glm::vec2 position = glm::vec2(0.0f);
+    float zoom = 1.0f;
+    float rotation = 0.0f;
+    glm::vec2 resolution = glm::vec2(800.0f, 600.0f);
+    uint64_t version = 0;
+};
+
+/**
+ * @brief Per frame uniform buffer holding the camera's projections
+ *
+ * Every frame in flight has its own small host visible buffer and a
+ * descriptor set pointing at it, so updating the camera is one write into
+ * the frame's buffer no matter how many objects there are. Pipelines that
+ * draw the world put get_set_layout() at set 0 and bind
+ * get_descriptor_set() of the frame they draw in.
+ *
+ * The descriptor sets never change, so recorded command buffers that bind
+ * them stay valid when the camera moves.
+ */
+class CameraBuffer {
+public:
+    /* Laid out like the Camera block of the vertex shaders */
+    struct Uniform {
+        glm::mat4 view;
+        glm::mat4 pixel_view;
+    };
+
+    /**
+     * @brief Constructor
+     * @param device
+     */
+    CameraBuffer(Device& device);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the buffers may still be in flight
+     */
+    ~CameraBuffer();
+
+    // Prevents copying of this object
+    CameraBuffer(const CameraBuffer&) = delete;
+    CameraBuffer& operator=(const CameraBuffer&) = delete;
+
+    /**
+     * @brief Writes the camera into the buffer of a frame in flight
+     *
+     * NOTE: The GPU must be done with the frame's previous use of the buffer
+     *
+     * @param frame_index Frame in flight about to be recorded
+     * @param camera The camera to draw with
+     * @return void
+     */
+    void update(int frame_index, const Camera& camera);
+
+    VkDescriptorSetLayout get_set_layout() const { return set_layout; }
+    VkDescriptorSet get_descriptor_set(int frame_index) const { return frames[frame_index].descriptor_set; }
+
+    /**
+     * @brief Projection and version of the camera last written by update
+     */
+    const glm::mat4& get_view() const { return view; }
+    uint64_t get_version() const { return camera_version; }
+
+    /**
+     * @brief Box around the part of object space a render area shows
+     *
+     * NOTE: When the camera is rotated the box is larger than what is shown
+     *
+     * @param area Render area in framebuffer pixels
+     * @param extent Size of the framebuffer
+     * @param min Smallest corner in the 0 to 2 space of object vertices
+     * @param max Largest corner
+     * @return void
+     */
+    void get_visible_bounds(VkRect2D area, VkExtent2D extent, glm::vec2& min, glm::vec2& max) const;
+
+private:
+    struct FrameBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    };
+
+    Device& device;
+    VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+    FrameBuffer frames[SwapChain::MAX_FRAMES_IN_FLIGHT];
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 inverse_view = glm::mat4(1.0f);
+    uint64_t camera_version = 0;
+};
+
+}
@@ -0,0 +1,64 @@
+#include "gpu_timer.hpp"
+
+#include "Utilities/status_print.hpp"
+
+namespace hop {
+
+GpuTimer::GpuTimer(Device& device) : device{device} {
+    VkQueryPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = 2 * SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+    if(vkCreateQueryPool(device.get_device(), &pool_info, nullptr, &query_pool) != VK_SUCCESS){
+        VK_ERROR("failed to create timestamp query pool");
+    }
+    VK_INFO("created timestamp query pool");
+}
+
+GpuTimer::~GpuTimer(){
+    vkDestroyQueryPool(device.get_device(), query_pool, nullptr);
+    VK_INFO("destroyed timestamp query pool");
+}
+
+void GpuTimer::begin(VkCommandBuffer command_buffer, int frame_index){
+    uint32_t first = 2 * frame_index;
+
+    /* The frame's fence was waited on, so the results are ready and this never blocks */
+    if(written[frame_index]){
+        uint64_t timestamps[2] = {};
+        VkResult result = vkGetQueryPoolResults(
+            device.get_device(),
+            query_pool,
+            first,
+            2,
+            sizeof(timestamps),
+            timestamps,
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT
+        );
+        if(result == VK_SUCCESS && timestamps[1] >= timestamps[0]){
+            last_time = static_cast<float>((timestamps[1] - timestamps[0]) * static_cast<double>(device.get_timestamp_period()) * 1e-9);
+            has_new_time = true;
+        }
+        written[frame_index] = false;
+    }
+
+    vkCmdResetQueryPool(command_buffer, query_pool, first, 2);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query_pool, first);
+}
+
+void GpuTimer::end(VkCommandBuffer command_buffer, int frame_index){
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool, 2 * frame_index + 1);
+    written[frame_index] = true;
+}
+
+std::optional<float> GpuTimer::take_time(){
+    if(!has_new_time){
+        return std::nullopt;
+    }
+    has_new_time = false;
+    return last_time;
+}
+
+}
@@ -0,0 +1,101 @@
+/**
+ * @file gpu_timer.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Measures how long the GPU spends on each frame with timestamp queries
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+
+namespace hop {
+
+/**
+ * @brief Times frames on the GPU
+ *
+ * Every frame in flight writes a timestamp at the start and at the end of its
+ * command buffer. The pair is read back when the frame index comes around
+ * again, after its fence was waited on, so reading never stalls. The time is
+ * therefore a frame or two old.
+ *
+ * NOTE: Needs Device::supports_timestamps()
+ */
+class GpuTimer {
+public:
+    /**
+     * @brief Checks if a device can time frames
+     * @param device
+     * @return true if it can
+     */
+    static bool is_supported(const Device& device){ return device.supports_timestamps(); }
+
+    /**
+     * @brief Constructor
+     *
+     * Creates a query pool with two timestamps per frame in flight.
+     *
+     * @param device
+     */
+    GpuTimer(Device& device);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame writing timestamps may still be in flight
+     */
+    ~GpuTimer();
+
+    // Prevents copying of this object
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    /**
+     * @brief Reads the last time of a frame index and starts timing it again
+     *
+     * NOTE: Must be recorded first in the frame's command buffer, outside of a
+     *       render pass, after the frame's fence was waited on
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @param frame_index Frame in flight being recorded
+     * @return void
+     */
+    void begin(VkCommandBuffer command_buffer, int frame_index);
+
+    /**
+     * @brief Stops timing a frame
+     *
+     * NOTE: Must be recorded last in the frame's command buffer
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @param frame_index Same frame as begin
+     * @return void
+     */
+    void end(VkCommandBuffer command_buffer, int frame_index);
+
+    /**
+     * @brief Takes the newest time that wasn't taken yet
+     * @return GPU time of a finished frame in seconds, nothing if no frame
+     *         finished since the last call
+     */
+    std::optional<float> take_time();
+
+    /* GPU time of the last finished frame in seconds */
+    float get_last_time() const { return last_time; }
+
+private:
+    Device& device;
+    VkQueryPool query_pool = VK_NULL_HANDLE;
+    bool written[SwapChain::MAX_FRAMES_IN_FLIGHT] = {};
+    float last_time = 0.0f;
+    bool has_new_time = false;
+};
+
+}
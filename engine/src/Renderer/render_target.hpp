@@ -0,0 +1,104 @@
+/**
+ * @file render_target.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Offscreen image frames are drawn into before being scaled onto the swapchain
+ *
+ */
+
+#pragma once
+
+#include "Device/device.hpp"
+#include "Swapchain/swapchain.hpp"
+
+#include <vulkan/vulkan.h>
+
+namespace hop {
+
+/**
+ * @brief Color and depth images to draw a frame into instead of the swapchain
+ *
+ * The images are as big as the swapchain, a frame drawn at a lower resolution
+ * only uses the bottom left part of them and blit stretches that part over
+ * the whole swapchain image. Changing the resolution therefore never creates
+ * images.
+ *
+ * The render pass has the same attachment formats as the swapchain's, so
+ * pipelines and secondary command buffers made for the swapchain render pass
+ * work in it as well.
+ *
+ * NOTE: Only one frame can draw into it at a time, its render pass waits
+ *       for the blit of the frame before
+ */
+class RenderTarget {
+public:
+    /**
+     * @brief Checks if frames can be drawn offscreen and blitted to a swapchain
+     * @param device
+     * @param swapchain
+     * @return true if the images can be blitted with linear filtering
+     */
+    static bool is_supported(Device& device, SwapChain& swapchain);
+
+    /**
+     * @brief Constructor
+     *
+     * Creates the images, render pass and framebuffer at the swapchain's
+     * extent and formats.
+     *
+     * @param device
+     * @param swapchain
+     */
+    RenderTarget(Device& device, SwapChain& swapchain);
+
+    /**
+     * @brief Deconstructor
+     *
+     * NOTE: No frame using the images may still be in flight
+     */
+    ~RenderTarget();
+
+    // Prevents copying of this object
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    VkRenderPass get_render_pass() const { return render_pass; }
+    VkFramebuffer get_framebuffer() const { return framebuffer; }
+    VkExtent2D get_extent() const { return extent; }
+
+    /**
+     * @brief Stretches what was drawn onto a swapchain image
+     *
+     * Leaves the swapchain image ready to present.
+     *
+     * NOTE: Must be recorded after the render pass, outside of it
+     *
+     * @param command_buffer Primary command buffer of the frame
+     * @param image Swapchain image to present
+     * @param source Size of the part of the target the frame was drawn in
+     * @param destination Size of the swapchain image
+     * @return void
+     */
+    void blit(VkCommandBuffer command_buffer, VkImage image, VkExtent2D source, VkExtent2D destination);
+
+private:
+    void create_images(VkFormat color_format, VkFormat depth_format);
+    void create_render_pass(VkFormat color_format, VkFormat depth_format);
+    void create_framebuffer();
+
+    Device& device;
+    VkExtent2D extent;
+
+    VkImage color_image = VK_NULL_HANDLE;
+    VkDeviceMemory color_memory = VK_NULL_HANDLE;
+    VkImageView color_view = VK_NULL_HANDLE;
+    VkImage depth_image = VK_NULL_HANDLE;
+    VkDeviceMemory depth_memory = VK_NULL_HANDLE;
+    VkImageView depth_view = VK_NULL_HANDLE;
+
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+};
+
+}
@@ -2,14 +2,23 @@
 
 #include "Utilities/status_print.hpp"
 
+#include <algorithm>
+
 namespace hop {
 
-Renderer::Renderer(Window& window, Device& device) : window{window}, device{device}{
+Renderer::Renderer(Window& window, Device& device, LatencyMode mode) : window{window}, device{device}{
+    latency_mode = mode;
+    frames_in_flight = mode == LatencyMode::LOW_LATENCY ? 1 : SwapChain::MAX_FRAMES_IN_FLIGHT;
     recreate_swapchain();
     create_command_buffers();
+    if(GpuTimer::is_supported(device)){
+        gpu_timer = std::make_unique<GpuTimer>(device);
+    }
 }
 
 Renderer::~Renderer(){
+    /* The render target and timer are shared by every frame, let them all finish */
+    vkDeviceWaitIdle(device.get_device());
     free_command_buffers();
 }
 
@@ -29,6 +38,25 @@ VkCommandBuffer Renderer::begin_frame(){
 
     is_frame_started = true;
 
+    /* Draw everything this image missed, unless it's too much to be worth it */
+    ImageDamage& damage = image_damage[current_image_index];
+    VkExtent2D extent = get_render_extent();
+    render_area = {{0, 0}, extent};
+    partial_frame = false;
+    if(partial_redraw && !damage.full && render_target == nullptr){
+        float area = static_cast<float>(damage.area.extent.width) * damage.area.extent.height;
+        if(damage.empty){
+            /* A render area can't be empty, redraw a pixel that didn't change */
+            render_area = {{0, 0}, {1, 1}};
+            partial_frame = true;
+        } else if(area <= MAX_PARTIAL_FRACTION * extent.width * extent.height){
+            render_area = damage.area;
+            partial_frame = true;
+        }
+    }
+    damage = ImageDamage{};
+    damage.full = false;
+
     auto command_buffer = get_current_command_buffer();
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -36,6 +64,9 @@ VkCommandBuffer Renderer::begin_frame(){
     if(vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS){
         VK_ERROR("failed to begin to recording command buffer");
     }
+    if(gpu_timer != nullptr){
+        gpu_timer->begin(command_buffer, current_frame_index);
+    }
     return command_buffer;
 }
 
@@ -43,11 +74,20 @@ void Renderer::end_frame(){
     assert(is_frame_started);
 
     auto command_buffer = get_current_command_buffer();
+    if(gpu_timer != nullptr){
+        gpu_timer->end(command_buffer, current_frame_index);
+    }
     if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS){
         VK_ERROR("failed to record command buffer");
     }
 
-    auto result = swapchain->submit_command_buffers(&command_buffer, &current_image_index);
+    /* Rectangles are relative to the last presented image, which saw every earlier frame */
+    if(partial_frame && frame_damage.empty()){
+        frame_damage.push_back(render_area);
+    }
+    auto result = swapchain->submit_command_buffers(&command_buffer, &current_image_index, partial_frame ? &frame_damage : nullptr);
+    frame_damage.clear();
+    last_present_time = std::chrono::steady_clock::now();
     if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || window.was_window_resized()){
         window.reset_window_resized_flag();
         recreate_swapchain();
@@ -56,20 +96,23 @@ void Renderer::end_frame(){
     }
 
     is_frame_started = false;
-    current_frame_index = (current_frame_index + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+    current_frame_index = (current_frame_index + 1) % swapchain->get_frames_in_flight();
 }
 
-void Renderer::begin_swapchain_render_pass(VkCommandBuffer command_buffer){
+void Renderer::begin_swapchain_render_pass(VkCommandBuffer command_buffer, VkSubpassContents contents){
     assert(is_frame_started);
     assert(command_buffer == get_current_command_buffer());
 
     VkRenderPassBeginInfo render_pass_info = {};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_info.renderPass = swapchain->get_render_pass();
-    render_pass_info.framebuffer = swapchain->get_frame_buffer(current_image_index);
-
-    render_pass_info.renderArea.offset = {0, 0};
-    render_pass_info.renderArea.extent = swapchain->get_swapchain_extent();
+    if(render_target != nullptr){
+        render_pass_info.renderPass = render_target->get_render_pass();
+        render_pass_info.framebuffer = render_target->get_framebuffer();
+    } else {
+        render_pass_info.renderPass = partial_frame ? swapchain->get_preserving_render_pass() : swapchain->get_render_pass();
+        render_pass_info.framebuffer = swapchain->get_frame_buffer(current_image_index);
+    }
+    render_pass_info.renderArea = render_area;
 
     std::array<VkClearValue, 2> clear_values{};
     clear_values[0].color = {0.01f, 0.01f, 0.01f, 0.1f};
@@ -78,17 +121,20 @@ void Renderer::begin_swapchain_render_pass(VkCommandBuffer command_buffer){
     render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
     render_pass_info.pClearValues = clear_values.data();
 
-    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(command_buffer, &render_pass_info, contents);
+    if(contents != VK_SUBPASS_CONTENTS_INLINE){
+        return;
+    }
 
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swapchain->get_swapchain_extent().width);
-    viewport.height = static_cast<float>(swapchain->get_swapchain_extent().height);
+    viewport.width = static_cast<float>(get_render_extent().width);
+    viewport.height = static_cast<float>(get_render_extent().height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
 
-    VkRect2D scissor{{0, 0}, swapchain->get_swapchain_extent()};
+    VkRect2D scissor = render_area;
 
     vkCmdSetViewport(command_buffer, 0, 1, &viewport);
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
@@ -98,6 +144,83 @@ void Renderer::end_swapchain_render_pass(VkCommandBuffer command_buffer){
     assert(is_frame_started);
     assert(command_buffer == get_current_command_buffer());
     vkCmdEndRenderPass(command_buffer);
+    if(render_target != nullptr){
+        render_target->blit(command_buffer, swapchain->get_image(current_image_index), get_render_extent(), swapchain->get_swapchain_extent());
+    }
+}
+
+void Renderer::add_damage(const std::vector<VkRect2D>& rects){
+    assert(!is_frame_started);
+    frame_damage = rects;
+
+    for(ImageDamage& damage : image_damage){
+        if(damage.full){
+            continue;
+        }
+        for(const VkRect2D& r : rects){
+            if(damage.empty){
+                damage.area = r;
+                damage.empty = false;
+                continue;
+            }
+            int32_t x0 = std::min(damage.area.offset.x, r.offset.x);
+            int32_t y0 = std::min(damage.area.offset.y, r.offset.y);
+            int32_t x1 = std::max(damage.area.offset.x + static_cast<int32_t>(damage.area.extent.width), r.offset.x + static_cast<int32_t>(r.extent.width));
+            int32_t y1 = std::max(damage.area.offset.y + static_cast<int32_t>(damage.area.extent.height), r.offset.y + static_cast<int32_t>(r.extent.height));
+            damage.area = {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+        }
+    }
+}
+
+VkExtent2D Renderer::get_render_extent() const {
+    VkExtent2D extent = swapchain->get_swapchain_extent();
+    if(render_target == nullptr){
+        return extent;
+    }
+    return {
+        std::max(1u, static_cast<uint32_t>(extent.width * render_scale + 0.5f)),
+        std::max(1u, static_cast<uint32_t>(extent.height * render_scale + 0.5f))
+    };
+}
+
+bool Renderer::set_dynamic_resolution(bool enabled){
+    assert(!is_frame_started);
+    if(enabled == (render_target != nullptr)){
+        return true;
+    }
+    if(enabled && (gpu_timer == nullptr || !RenderTarget::is_supported(device, *swapchain))){
+        return false;
+    }
+
+    vkDeviceWaitIdle(device.get_device());
+    render_target = enabled ? std::make_unique<RenderTarget>(device, *swapchain) : nullptr;
+    render_scale = 1.0f;
+
+    /* Swapchain images held blitted frames, or were drawn to directly, either way nothing can be kept */
+    image_damage.assign(swapchain->image_count(), ImageDamage{});
+    return true;
+}
+
+void Renderer::set_render_scale(float scale){
+    render_scale = std::clamp(scale, 0.1f, 1.0f);
+}
+
+float Renderer::get_redrawn_fraction() const {
+    VkExtent2D extent = get_render_extent();
+    return static_cast<float>(render_area.extent.width) * render_area.extent.height / (static_cast<float>(extent.width) * extent.height);
+}
+
+void Renderer::set_latency_mode(LatencyMode mode){
+    assert(!is_frame_started);
+    latency_mode = mode;
+    frames_in_flight = mode == LatencyMode::LOW_LATENCY ? 1 : SwapChain::MAX_FRAMES_IN_FLIGHT;
+    recreate_swapchain();
+}
+
+void Renderer::set_frames_in_flight(int count){
+    assert(!is_frame_started);
+    frames_in_flight = std::clamp(count, 1, SwapChain::MAX_FRAMES_IN_FLIGHT);
+    recreate_swapchain();
 }
 
 void Renderer::create_command_buffers(){
@@ -130,15 +253,28 @@ void Renderer::recreate_swapchain(){
     vkDeviceWaitIdle(device.get_device());
 
     if(swapchain == nullptr){
-        swapchain = std::make_unique<SwapChain>(device, extent);
+        swapchain = std::make_unique<SwapChain>(device, extent, latency_mode, frames_in_flight);
     } else {
         std::shared_ptr<SwapChain> old_swapchain = std::move(swapchain);
-        swapchain = std::make_unique<SwapChain>(device, extent, old_swapchain);
+        swapchain = std::make_unique<SwapChain>(device, extent, latency_mode, frames_in_flight, old_swapchain);
 
         if(!old_swapchain->compare_swap_formats(*swapchain.get())){
             VK_ERROR("Swap chain image(or depth) format has changed!");
         } 
     }
+
+    /* Drawn at the old size and shared with the old swapchain's frames, which are done now */
+    if(render_target != nullptr){
+        render_target = RenderTarget::is_supported(device, *swapchain) ? std::make_unique<RenderTarget>(device, *swapchain) : nullptr;
+    }
+
+    /* The new swapchain starts at its first frame, stay in step with it */
+    current_frame_index = 0;
+
+    /* New images hold nothing that can be kept */
+    image_damage.assign(swapchain->image_count(), ImageDamage{});
+    frame_damage.clear();
+    swapchain_version++;
 }
 
 }
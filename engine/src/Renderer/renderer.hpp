@@ -12,11 +12,15 @@
 #include "Window/window.hpp"
 #include "Device/device.hpp"
 #include "Swapchain/swapchain.hpp"
+#include "render_target.hpp"
+#include "gpu_timer.hpp"
 
 #include <vulkan/vulkan.h>
 
 #include <cassert>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace hop {
@@ -39,7 +43,7 @@ public:
      * command buffers that are stored in the command pool in the device.
      *
      */
-    Renderer(Window& window, Device& device);
+    Renderer(Window& window, Device& device, LatencyMode mode = LatencyMode::THROUGHPUT);
     
     /**
      * @brief Default Deconstructor
@@ -82,6 +86,118 @@ public:
         assert(is_frame_started);
         return command_buffers[current_frame_index];
     }
+
+    /**
+     * @brief Index of the frame in flight currently being recorded
+     *
+     * Anything used by the GPU per frame (like secondary command buffers) can
+     * be kept per frame index. When a frame with an index begins, the previous
+     * frame with that index is done on the GPU.
+     *
+     * @return Index from 0 to SwapChain::MAX_FRAMES_IN_FLIGHT - 1
+     */
+    int get_frame_index() const { return current_frame_index; }
+
+    VkExtent2D get_swapchain_extent() const { return swapchain->get_swapchain_extent(); }
+
+    /**
+     * @brief Size of the image frames are drawn into
+     *
+     * The swapchain extent, or with dynamic resolution the part of the
+     * render target drawn at the current scale. Viewports must cover this.
+     *
+     * @return The extent in pixels
+     */
+    VkExtent2D get_render_extent() const;
+
+    /**
+     * @brief Counter that changes whenever the swapchain is recreated
+     *
+     * Anything recorded against the old swapchain's render pass or extent
+     * must be recorded again.
+     *
+     * @return The version
+     */
+    uint64_t get_swapchain_version() const { return swapchain_version; }
+
+    /**
+     * @brief Marks parts of the screen as changed for the next frame
+     *
+     * Every swapchain image keeps the damage from the frames since it was last
+     * drawn to, and only that area is drawn again when the image is reused.
+     * Must be called every frame before begin_frame(), see DamageTracker.
+     *
+     * @param rects Rectangles, in framebuffer pixels, that changed since the last frame
+     * @return void
+     */
+    void add_damage(const std::vector<VkRect2D>& rects);
+
+    /**
+     * @brief Turns drawing only the damaged area on or off
+     *
+     * When off, or when the damage covers more than MAX_PARTIAL_FRACTION of
+     * the image, the whole image is cleared and drawn.
+     *
+     * @param enabled true to only draw the damaged area
+     * @return void
+     */
+    void set_partial_redraw(bool enabled){ partial_redraw = enabled; }
+    bool get_partial_redraw() const { return partial_redraw; }
+
+    /**
+     * @brief Turns drawing into an offscreen target at a scaled resolution on or off
+     *
+     * Frames are drawn into a RenderTarget at get_render_scale() of the
+     * swapchain's resolution and blitted over the swapchain image. Every
+     * frame is drawn whole, partial redraw is skipped while it's on.
+     *
+     * NOTE: Must not be called while a frame is being recorded
+     *
+     * @param enabled true to draw offscreen
+     * @return false if the swapchain can't be blitted to or frames can't be
+     *         timed, frames are then drawn straight to the swapchain
+     */
+    bool set_dynamic_resolution(bool enabled);
+    bool get_dynamic_resolution() const { return render_target != nullptr; }
+
+    /**
+     * @brief Sets the resolution of the next frames drawn offscreen
+     *
+     * Only used with dynamic resolution.
+     *
+     * @param scale Fraction of the swapchain's width and height, clamped to 0.1 to 1
+     * @return void
+     */
+    void set_render_scale(float scale);
+
+    /**
+     * @brief Gets the scale frames are drawn at
+     * @return The scale, 1 without dynamic resolution
+     */
+    float get_render_scale() const { return render_target != nullptr ? render_scale : 1.0f; }
+
+    /**
+     * @brief Takes the GPU time of the newest finished frame, see GpuTimer
+     * @return Seconds, nothing if no frame finished since the last call or
+     *         frames can't be timed
+     */
+    std::optional<float> take_gpu_time(){ return gpu_timer != nullptr ? gpu_timer->take_time() : std::nullopt; }
+    float get_gpu_time() const { return gpu_timer != nullptr ? gpu_timer->get_last_time() : 0.0f; }
+
+    /**
+     * @brief Area of the image drawn this frame
+     *
+     * Anything drawn must be scissored to this area.
+     *
+     * @return The render area in framebuffer pixels
+     */
+    VkRect2D get_render_area() const { return render_area; }
+
+    /**
+     * @brief How much of the image the last frame drew
+     * @return Fraction from 0 to 1
+     */
+    float get_redrawn_fraction() const;
     
     /**
      * @brief Begins a new frame for rendering
@@ -122,11 +238,15 @@ public:
      *      https://developer.samsung.com/galaxy-gamedev/resources/articles/renderpasses.html
      *
      * NOTE: Ensure begin_frame() was called
+     * NOTE: With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the only thing
+     *       that can be recorded in the pass is vkCmdExecuteCommands, the
+     *       secondary command buffers set their own viewport and scissor
      * 
      * @param command_buffer The command buffer returned from begin_frame()
+     * @param contents Whether the pass is recorded inline or from secondary command buffers
      * @return void
      */
-    void begin_swapchain_render_pass(VkCommandBuffer command_buffer);
+    void begin_swapchain_render_pass(VkCommandBuffer command_buffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
     /**
      * @brief Ends the render pass
@@ -134,6 +254,8 @@ public:
      * Simply ends the render pass. This should be called once all commands
      * are finished recording.
      *
+     * With dynamic resolution this also blits the frame to the swapchain.
+     *
      * NOTE: Ensure a frame and the render pass has started
      * 
      * @param command_buffer The command buffer returned from begin_frame()
@@ -141,7 +263,67 @@ public:
      */
     void end_swapchain_render_pass(VkCommandBuffer command_buffer);
 
+    /**
+     * @brief Changes the latency mode
+     *
+     * The swapchain is recreated with the present mode that fits the latency
+     * mode, and the frames in flight are reset to the mode's default (1 for
+     * LOW_LATENCY, 2 otherwise).
+     *
+     * NOTE: Must not be called while a frame is being recorded
+     *
+     * @param mode The new latency mode
+     * @return void
+     */
+    void set_latency_mode(LatencyMode mode);
+
+    /**
+     * @brief Gets the current latency mode
+     * @return The latency mode
+     */
+    LatencyMode get_latency_mode() const { return latency_mode; }
+
+    /**
+     * @brief Changes how many frames the CPU can record ahead of the GPU
+     *
+     * More frames in flight lets the CPU and GPU work at the same time, but
+     * every extra frame adds a frame of latency. The swapchain is recreated.
+     *
+     * NOTE: Must not be called while a frame is being recorded
+     *
+     * @param count Frames in flight, clamped to 1 to SwapChain::MAX_FRAMES_IN_FLIGHT
+     * @return void
+     */
+    void set_frames_in_flight(int count);
+
+    /**
+     * @brief Gets how many frames can be in flight
+     * @return Frames in flight
+     */
+    int get_frames_in_flight() const { return frames_in_flight; }
+
+    /**
+     * @brief Gets the present mode the swapchain is using
+     * @return The present mode
+     */
+    VkPresentModeKHR get_present_mode() const { return swapchain->get_present_mode(); }
+
+    /**
+     * @brief Gets when the last frame was handed to the presentation engine
+     * @return Time point right after the last present call returned
+     */
+    std::chrono::steady_clock::time_point get_last_present_time() const { return last_present_time; }
+
+    static constexpr float MAX_PARTIAL_FRACTION = 0.5f;
+
 private:
+    /* What changed in a swapchain image since it was last drawn to */
+    struct ImageDamage {
+        VkRect2D area = {};
+        bool empty = true;
+        bool full = true;
+    };
+
     void create_command_buffers();
     void free_command_buffers();
     void recreate_swapchain();
@@ -149,11 +331,24 @@ private:
     Window& window;
     Device& device;
     std::unique_ptr<SwapChain> swapchain;
+    std::unique_ptr<RenderTarget> render_target;
+    std::unique_ptr<GpuTimer> gpu_timer;
+    float render_scale = 1.0f;
     std::vector<VkCommandBuffer> command_buffers;
 
     uint32_t current_image_index;
     int current_frame_index = 0;
+    LatencyMode latency_mode = LatencyMode::THROUGHPUT;
+    int frames_in_flight = SwapChain::MAX_FRAMES_IN_FLIGHT;
+    std::chrono::steady_clock::time_point last_present_time;
+    uint64_t swapchain_version = 0;
     bool is_frame_started = false;
+
+    bool partial_redraw = true;
+    bool partial_frame = false;
+    VkRect2D render_area = {};
+    std::vector<VkRect2D> frame_damage;
+    std::vector<ImageDamage> image_damage;
 };
 
 }
@@ -0,0 +1,57 @@
+#include "resolution_scaler.hpp"
+
+#include <algorithm>
+
+namespace hop {
+
+bool ResolutionScaler::update(float gpu_time){
+    /* Frames recorded before the last change still show the old scale */
+    if(settle_frames > 0){
+        settle_frames--;
+        return false;
+    }
+
+    average_time = samples == 0 ? gpu_time : average_time + (gpu_time - average_time) * SMOOTHING;
+    samples++;
+
+    float next = std::min(scale + SCALE_STEP, MAX_SCALE);
+    float expected = average_time * (next * next) / (scale * scale);
+    if(average_time > budget * LOWER_ABOVE){
+        over_frames++;
+        under_frames = 0;
+    } else if(next > scale && expected < budget * RAISE_BELOW){
+        under_frames++;
+        over_frames = 0;
+    } else {
+        over_frames = 0;
+        under_frames = 0;
+    }
+
+    float new_scale = scale;
+    if(over_frames >= LOWER_FRAMES){
+        new_scale = std::max(scale - SCALE_STEP, MIN_SCALE);
+    } else if(under_frames >= RAISE_FRAMES){
+        new_scale = next;
+    }
+    if(new_scale == scale){
+        return false;
+    }
+
+    scale = new_scale;
+    samples = 0;
+    over_frames = 0;
+    under_frames = 0;
+    settle_frames = SETTLE_FRAMES;
+    return true;
+}
+
+void ResolutionScaler::reset(){
+    scale = MAX_SCALE;
+    average_time = 0.0f;
+    samples = 0;
+    over_frames = 0;
+    under_frames = 0;
+    settle_frames = 0;
+}
+
+}
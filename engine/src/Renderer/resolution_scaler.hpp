@@ -0,0 +1,80 @@
+/**
+ * @file resolution_scaler.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Picks the resolution frames are drawn at from how long the GPU takes
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace hop {
+
+/**
+ * @brief Scales the resolution down when the GPU misses its budget and back up
+ *        when it has time to spare
+ *
+ * GPU times are smoothed, and the scale only moves after several frames agree
+ * on it, so a single slow frame changes nothing. Lowering is quick, raising
+ * waits much longer and only happens when the time expected at the higher
+ * scale (the GPU time grows with the pixel count, so with the square of the
+ * scale) still leaves room in the budget. The gap between where it lowers
+ * and where it raises keeps it from going back and forth. After every change
+ * the frames still in flight at the old scale are ignored.
+ */
+class ResolutionScaler {
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float SCALE_STEP = 0.1f;
+
+    /* Lowers when over this fraction of the budget */
+    static constexpr float LOWER_ABOVE = 0.95f;
+    /* Raises when the time at the next scale would be under this fraction */
+    static constexpr float RAISE_BELOW = 0.8f;
+
+    static constexpr uint32_t LOWER_FRAMES = 5;
+    static constexpr uint32_t RAISE_FRAMES = 60;
+    static constexpr uint32_t SETTLE_FRAMES = 8;
+    static constexpr float SMOOTHING = 0.2f;
+
+    /**
+     * @brief Constructor
+     * @param budget GPU time a frame may take in seconds
+     */
+    ResolutionScaler(float budget = 1.0f / 60.0f) : budget{budget} {}
+
+    /**
+     * @brief Feeds the GPU time of a finished frame
+     * @param gpu_time Seconds the GPU spent on the frame
+     * @return true if the scale changed
+     */
+    bool update(float gpu_time);
+
+    /**
+     * @brief Goes back to full resolution and forgets every time
+     * @return void
+     */
+    void reset();
+
+    void set_budget(float seconds){ budget = seconds; }
+    float get_budget() const { return budget; }
+    float get_scale() const { return scale; }
+
+    /* Smoothed GPU time in seconds */
+    float get_average_time() const { return average_time; }
+
+private:
+    float budget;
+    float scale = MAX_SCALE;
+    float average_time = 0.0f;
+    uint32_t samples = 0;
+    uint32_t over_frames = 0;
+    uint32_t under_frames = 0;
+    uint32_t settle_frames = 0;
+};
+
+}
@@ -2,15 +2,18 @@
 
 #include "Utilities/status_print.hpp"
 
+#include <algorithm>
 #include <limits>
 
 namespace hop {
 
-SwapChain::SwapChain(Device& d, VkExtent2D e) : device{d}, window_extent{e} {
+SwapChain::SwapChain(Device& d, VkExtent2D e, LatencyMode mode, int frames_in_flight) : device{d}, window_extent{e}, latency_mode{mode} {
+    this->frames_in_flight = std::clamp(frames_in_flight, 1, MAX_FRAMES_IN_FLIGHT);
     init();
 }
 
-SwapChain::SwapChain(Device& d, VkExtent2D e, std::shared_ptr<SwapChain> prev) : device{d}, window_extent{e}, old_swapchain{prev} { 
+SwapChain::SwapChain(Device& d, VkExtent2D e, LatencyMode mode, int frames_in_flight, std::shared_ptr<SwapChain> prev) : device{d}, window_extent{e}, latency_mode{mode}, old_swapchain{prev} { 
+    this->frames_in_flight = std::clamp(frames_in_flight, 1, MAX_FRAMES_IN_FLIGHT);
     init();
     old_swapchain = nullptr;
 }
@@ -39,10 +42,16 @@ SwapChain::~SwapChain(){
     VK_INFO("destroyed swapchain framebuffers");
 
     vkDestroyRenderPass(device.get_device(), render_pass, nullptr);
+    vkDestroyRenderPass(device.get_device(), preserving_render_pass, nullptr);
     VK_INFO("destroyed render pass");
 
+    /* Frames are idle by the time a swapchain is destroyed, upload semaphores can be reused */
+    for(auto& semaphores : upload_semaphores_in_flight){
+        device.recycle_semaphores(semaphores);
+    }
+
     // cleanup synchronization objects (semaphores)
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < in_flight_fences.size(); i++) {
         vkDestroySemaphore(device.get_device(), render_finished_semaphores[i], nullptr);
         vkDestroySemaphore(device.get_device(), image_available_semaphores[i], nullptr);
         vkDestroyFence(device.get_device(), in_flight_fences[i], nullptr);
@@ -68,11 +77,14 @@ VkFormat SwapChain::find_depth_format(){
 
 VkResult SwapChain::acquire_next_image(uint32_t* image_index){
     vkWaitForFences(device.get_device(), 1, &in_flight_fences[current_frame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+    /* The frame that waited on these uploads has finished */
+    device.recycle_semaphores(upload_semaphores_in_flight[current_frame]);
     VkResult result = vkAcquireNextImageKHR(device.get_device(), swapchain, std::numeric_limits<uint64_t>::max(), image_available_semaphores[current_frame], VK_NULL_HANDLE,image_index);
     return result;
 }
 
-VkResult SwapChain::submit_command_buffers(const VkCommandBuffer* buffers, uint32_t* image_index){
+VkResult SwapChain::submit_command_buffers(const VkCommandBuffer* buffers, uint32_t* image_index, const std::vector<VkRect2D>* changed){
     if (images_in_flight[*image_index] != VK_NULL_HANDLE) {
         vkWaitForFences(device.get_device(), 1, &images_in_flight[*image_index], VK_TRUE, UINT64_MAX);
     }
@@ -81,11 +93,22 @@ VkResult SwapChain::submit_command_buffers(const VkCommandBuffer* buffers, uint3
     VkSubmitInfo submit_info = {};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore wait_semaphores[] = { image_available_semaphores[current_frame] };
-    VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = wait_semaphores;
-    submit_info.pWaitDstStageMask = wait_stages;
+    /* 
+    Besides the swapchain image, wait on any uploads running on the transfer
+    queue. Only vertex input has to wait for them, everything before that 
+    (including the clear) can overlap with the copy.
+    */
+    std::vector<VkSemaphore> wait_semaphores = { image_available_semaphores[current_frame] };
+    std::vector<VkPipelineStageFlags> wait_stages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    std::vector<VkSemaphore>& uploads = upload_semaphores_in_flight[current_frame];
+    uploads = device.take_upload_semaphores();
+    for(VkSemaphore s : uploads){
+        wait_semaphores.push_back(s);
+        wait_stages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+    }
+    submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+    submit_info.pWaitSemaphores = wait_semaphores.data();
+    submit_info.pWaitDstStageMask = wait_stages.data();
 
     submit_info.commandBufferCount = 1;
     submit_info.pCommandBuffers = buffers;
@@ -111,9 +134,26 @@ VkResult SwapChain::submit_command_buffers(const VkCommandBuffer* buffers, uint3
 
     present_info.pImageIndices = image_index;
 
+    /* Lets the presentation engine only copy or compose what changed */
+    std::vector<VkRectLayerKHR> rectangles;
+    VkPresentRegionKHR region = {};
+    VkPresentRegionsKHR regions = {};
+    if(changed != nullptr && !changed->empty() && device.has_incremental_present()){
+        for(const VkRect2D& r : *changed){
+            rectangles.push_back({r.offset, r.extent, 0});
+        }
+        region.rectangleCount = static_cast<uint32_t>(rectangles.size());
+        region.pRectangles = rectangles.data();
+
+        regions.sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
+        regions.swapchainCount = 1;
+        regions.pRegions = &region;
+        present_info.pNext = &regions;
+    }
+
     auto result = vkQueuePresentKHR(device.get_present_que(), &present_info);
 
-    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    current_frame = (current_frame + 1) % frames_in_flight;
 
     return result;
 }
@@ -163,20 +203,18 @@ VkPresentModeKHR SwapChain::choose_swap_present_mode(const std::vector<VkPresent
             that the framerate is unlocked.
     */
 
-    /*
-    for(const auto& m : modes){
-        if(m == VK_PRESENT_MODE_IMMEDIATE_KHR){
-            VK_INFO("present mode: immediate");
-            return m;
-        }
+    auto supported = [&](VkPresentModeKHR mode){
+        return std::find(modes.begin(), modes.end(), mode) != modes.end();
+    };
+
+    if(latency_mode == LatencyMode::LOW_LATENCY && supported(VK_PRESENT_MODE_IMMEDIATE_KHR)){
+        VK_INFO("present mode: immediate");
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
     }
-    */
 
-    for(const auto& m : modes){
-        if(m == VK_PRESENT_MODE_MAILBOX_KHR){
-            VK_INFO("present mode: mailbox");
-            return m;
-        }
+    if(latency_mode != LatencyMode::POWER_SAVING && supported(VK_PRESENT_MODE_MAILBOX_KHR)){
+        VK_INFO("present mode: mailbox");
+        return VK_PRESENT_MODE_MAILBOX_KHR;
     }
 
     /* FIFO_KHR is guaranteed to be avalible */
@@ -199,10 +237,18 @@ void SwapChain::create_swap_chain(){
     SwapChainSupportDetails ss = device.get_swapchain_support();
 
     VkSurfaceFormatKHR surface_format = choose_swap_surface_format(ss.formats);
-    VkPresentModeKHR present_mode = choose_swap_present_mode(ss.present_modes);
+    present_mode = choose_swap_present_mode(ss.present_modes);
     VkExtent2D extent = choose_swap_extent(ss.capabilities);
 
-    uint32_t image_count = ss.capabilities.minImageCount + 1;
+    /*
+    IMMEDIATE never waits on the display so the minimum amount of images is
+    enough. Every other mode needs a spare image so we never block waiting
+    for the display to release one.
+    */
+    uint32_t image_count = ss.capabilities.minImageCount;
+    if(present_mode != VK_PRESENT_MODE_IMMEDIATE_KHR){
+        image_count++;
+    }
     if(ss.capabilities.maxImageCount > 0 && image_count > ss.capabilities.maxImageCount){
         image_count = ss.capabilities.maxImageCount;
     }
@@ -217,6 +263,12 @@ void SwapChain::create_swap_chain(){
     create_info.imageArrayLayers = 1;
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+    /* Lets a frame drawn somewhere else be blitted in, see RenderTarget */
+    transfer_dst = (ss.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+    if(transfer_dst){
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
     QueFamilyIndices indices = device.find_physical_que_families();
     uint32_t qfi[] = {indices.graphics_family.value(), indices.present_family.value()};
     if(indices.graphics_family != indices.present_family){
@@ -272,6 +324,16 @@ void SwapChain::create_image_views(){
 }
 
 void SwapChain::create_render_pass(){
+    render_pass = make_render_pass(VK_IMAGE_LAYOUT_UNDEFINED);
+
+    /*
+    Starting from the presented layout keeps the image's contents. Load ops
+    only touch the render area, so everything outside of it is preserved.
+    */
+    preserving_render_pass = make_render_pass(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+}
+
+VkRenderPass SwapChain::make_render_pass(VkImageLayout color_initial_layout){
     VkAttachmentDescription depth_attachment = {};
     depth_attachment.format = find_depth_format();
     depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -293,7 +355,7 @@ void SwapChain::create_render_pass(){
     color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    color_attachment.initialLayout = color_initial_layout;
     color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference color_attachment_ref = {};
@@ -324,10 +386,12 @@ void SwapChain::create_render_pass(){
     render_pass_info.dependencyCount = 1;
     render_pass_info.pDependencies = &dependency;
 
-    if(vkCreateRenderPass(device.get_device(), &render_pass_info, nullptr, &render_pass) != VK_SUCCESS){
+    VkRenderPass pass;
+    if(vkCreateRenderPass(device.get_device(), &render_pass_info, nullptr, &pass) != VK_SUCCESS){
         VK_ERROR("failed to create render pass!");
     }
     VK_INFO("Created render pass!");
+    return pass;
 }
 
 void SwapChain::create_depth_resources(){
@@ -399,9 +463,10 @@ void SwapChain::create_framebuffers(){
 }
 
 void SwapChain::create_sync_objects(){
-    image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    in_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+    image_available_semaphores.resize(frames_in_flight);
+    render_finished_semaphores.resize(frames_in_flight);
+    in_flight_fences.resize(frames_in_flight);
+    upload_semaphores_in_flight.resize(frames_in_flight);
     images_in_flight.resize(image_count(), VK_NULL_HANDLE);
 
     VkSemaphoreCreateInfo semaphore_info = {};
@@ -411,7 +476,7 @@ void SwapChain::create_sync_objects(){
     fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (int i = 0; i < frames_in_flight; i++) {
         if(vkCreateSemaphore(device.get_device(), &semaphore_info, nullptr, &image_available_semaphores[i]) != VK_SUCCESS){
             VK_ERROR("failed to create a synchronization object for images");
         }
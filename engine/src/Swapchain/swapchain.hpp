@@ -19,6 +19,29 @@
 
 namespace hop {
 
+/**
+ * @brief How the swapchain trades latency against smoothness and power
+ *
+ * LOW_LATENCY:
+ *      Presents right away (IMMEDIATE, or MAILBOX if tearing is not allowed)
+ *      with a single frame in flight. Input shows up on screen as soon as
+ *      possible, at the cost of tearing and less CPU/GPU overlap.
+ * THROUGHPUT:
+ *      MAILBOX with two frames in flight. Renders as fast as possible without
+ *      tearing. This is the default.
+ * POWER_SAVING:
+ *      FIFO (V-Sync) with two frames in flight. Never renders faster than the
+ *      display refreshes.
+ *
+ * If the preferred present mode is not supported, FIFO is used since it is
+ * the only mode guaranteed to be avalible.
+ */
+enum class LatencyMode {
+    LOW_LATENCY,
+    THROUGHPUT,
+    POWER_SAVING
+};
+
 /**
  * @brief Swapchain for game engine
  *
@@ -38,8 +61,10 @@ public:
      *
      * @param device
      * @param extent
+     * @param mode Latency mode that decides the present mode
+     * @param frames_in_flight Frames the CPU may record ahead of the GPU, 1 to MAX_FRAMES_IN_FLIGHT
      */
-    SwapChain(Device& d, VkExtent2D e);
+    SwapChain(Device& d, VkExtent2D e, LatencyMode mode, int frames_in_flight);
     
     /**
      * @brief Constructor
@@ -48,9 +73,11 @@ public:
      *
      * @param device
      * @param extent
+     * @param mode Latency mode that decides the present mode
+     * @param frames_in_flight Frames the CPU may record ahead of the GPU, 1 to MAX_FRAMES_IN_FLIGHT
      * @param prev
      */
-    SwapChain(Device& d, VkExtent2D e, std::shared_ptr<SwapChain> prev);
+    SwapChain(Device& d, VkExtent2D e, LatencyMode mode, int frames_in_flight, std::shared_ptr<SwapChain> prev);
     
     /**
      * @brief Default Deconstructor
@@ -81,6 +108,19 @@ public:
      * @return
      */
     VkRenderPass get_render_pass() { return render_pass; }
+
+    /**
+     * @brief Render pass that keeps what was drawn to the image before
+     *
+     * Compatible with get_render_pass(), but only the render area is cleared
+     * and drawn. Pixels outside of it keep what the image showed the last time
+     * it was presented.
+     *
+     * NOTE: Only use on images that were presented before
+     *
+     * @return The render pass
+     */
+    VkRenderPass get_preserving_render_pass() { return preserving_render_pass; }
     
     /**
      * @brief
@@ -91,6 +131,22 @@ public:
      */
     VkImageView get_image_view(int index) { return swapchain_image_views[index]; }
     
+    /**
+     * @brief Gets a swapchain image to copy into
+     *
+     * NOTE: Only a transfer destination if is_transfer_dst()
+     *
+     * @param index
+     * @return The image
+     */
+    VkImage get_image(int index) { return swapchain_images[index]; }
+
+    /**
+     * @brief Checks if images can be copied and blitted into
+     * @return true if the images were created with VK_IMAGE_USAGE_TRANSFER_DST_BIT
+     */
+    bool is_transfer_dst() const { return transfer_dst; }
+
     /**
      * @brief
      *
@@ -117,6 +173,18 @@ public:
      * @return
      */
     size_t image_count() { return swapchain_images.size(); }
+
+    /**
+     * @brief Gets how many frames can be recorded while others render
+     * @return Frames in flight
+     */
+    int get_frames_in_flight() const { return frames_in_flight; }
+
+    /**
+     * @brief Gets the present mode that was picked for the latency mode
+     * @return The present mode in use
+     */
+    VkPresentModeKHR get_present_mode() const { return present_mode; }
     
     /**
      * @brief
@@ -137,13 +205,16 @@ public:
     VkResult acquire_next_image(uint32_t* image_index);
     
     /**
-     * @brief
+     * @brief Submits the frame's command buffer and presents the image
      *
-     * A
-     *
-     * @return
+     * @param buffers Command buffer of the frame
+     * @param image_index Image the frame was drawn to
+     * @param changed Rectangles that differ from the last presented image,
+     *        nullptr if the whole image may have changed. Only used with
+     *        VK_KHR_incremental_present
+     * @return Result of presenting
      */
-    VkResult submit_command_buffers(const VkCommandBuffer* buffers, uint32_t* image_index);
+    VkResult submit_command_buffers(const VkCommandBuffer* buffers, uint32_t* image_index, const std::vector<VkRect2D>* changed = nullptr);
 
     /**
      * @brief
@@ -165,12 +236,17 @@ private:
     void create_swap_chain();
     void create_image_views();
     void create_render_pass();
+    VkRenderPass make_render_pass(VkImageLayout color_initial_layout);
     void create_depth_resources();
     void create_framebuffers();
     void create_sync_objects();
 
     Device& device;
     VkExtent2D window_extent;
+    LatencyMode latency_mode;
+    int frames_in_flight;
+    VkPresentModeKHR present_mode;
+    bool transfer_dst = false;
 
     VkSwapchainKHR swapchain;
     std::shared_ptr<SwapChain> old_swapchain;
@@ -186,11 +262,13 @@ private:
 
     std::vector<VkFramebuffer> swapchain_framebuffers;
     VkRenderPass render_pass;
+    VkRenderPass preserving_render_pass;
 
     std::vector<VkSemaphore> image_available_semaphores;
     std::vector<VkSemaphore> render_finished_semaphores;
     std::vector<VkFence> in_flight_fences;
     std::vector<VkFence> images_in_flight;
+    std::vector<std::vector<VkSemaphore>> upload_semaphores_in_flight;
     size_t current_frame = 0;
 };
 
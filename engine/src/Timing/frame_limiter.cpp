@@ -0,0 +1,140 @@
+#include "frame_limiter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace hop {
+
+FrameLimiter::FrameLimiter(int target_fps){
+    set_target_fps(target_fps);
+    frame_times.reserve(STATS_WINDOW);
+}
+
+void FrameLimiter::set_target_fps(int fps){
+    target_fps = std::max(fps, 0);
+    if(target_fps == 0){
+        frame_duration = Clock::duration::zero();
+    } else {
+        frame_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / target_fps));
+    }
+    started = false;
+}
+
+void FrameLimiter::wait(){
+    Clock::time_point now = Clock::now();
+
+    if(!started){
+        /* First frame, nothing to measure against yet */
+        started = true;
+        last_frame = now;
+        next_deadline = now + frame_duration;
+        delta = static_cast<float>(std::chrono::duration<double>(frame_duration).count());
+        return;
+    }
+
+    if(target_fps > 0){
+        if(now > next_deadline + frame_duration){
+            /* More than a whole frame late, don't try to catch up */
+            next_deadline = now;
+        } else {
+            sleep_until(next_deadline);
+        }
+    }
+
+    now = Clock::now();
+    delta = static_cast<float>(std::chrono::duration<double>(now - last_frame).count());
+    last_frame = now;
+    next_deadline += frame_duration;
+
+    record_frame(delta);
+}
+
+void FrameLimiter::sleep_until(Clock::time_point deadline){
+    using seconds = std::chrono::duration<double>;
+
+    /*
+    Sleep in 1ms steps while the remaining time is larger than the worst
+    sleep we expect. Each sleep updates the estimate (Welford's algorithm) so
+    it adapts to however precise the OS scheduler happens to be.
+    */
+    double remaining = seconds(deadline - Clock::now()).count();
+    while(remaining > sleep_estimate){
+        Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double observed = seconds(Clock::now() - start).count();
+
+        sleep_count++;
+        double d = observed - sleep_mean;
+        sleep_mean += d / sleep_count;
+        sleep_m2 += d * (observed - sleep_mean);
+        double stddev = std::sqrt(sleep_m2 / (sleep_count - 1));
+        sleep_estimate = sleep_mean + stddev;
+
+        remaining = seconds(deadline - Clock::now()).count();
+    }
+
+    /* Spin for what is left, this is where sub-millisecond accuracy comes from */
+    while(Clock::now() < deadline){
+        std::this_thread::yield();
+    }
+}
+
+void FrameLimiter::record_frame(float frame_time){
+    if(frame_times.size() < STATS_WINDOW){
+        frame_times.push_back(frame_time);
+    } else {
+        frame_times[frame_time_index] = frame_time;
+    }
+    frame_time_index = (frame_time_index + 1) % STATS_WINDOW;
+    frame_count++;
+}
+
+FrameStats FrameLimiter::get_stats() const {
+    FrameStats stats{};
+    stats.delta_time = delta;
+    stats.target_frame_time = static_cast<float>(std::chrono::duration<double>(frame_duration).count());
+    stats.frame_count = frame_count;
+
+    if(frame_times.empty()){ return stats; }
+
+    double sum = 0.0;
+    float min_time = frame_times[0];
+    float max_time = frame_times[0];
+    for(float t : frame_times){
+        sum += t;
+        min_time = std::min(min_time, t);
+        max_time = std::max(max_time, t);
+    }
+    double average = sum / frame_times.size();
+
+    /* Jitter is measured against the target, or the average if unlimited */
+    double reference = target_fps > 0 ? stats.target_frame_time : average;
+    double jitter_sum = 0.0;
+    double jitter_sq_sum = 0.0;
+    double jitter_max = 0.0;
+    for(float t : frame_times){
+        double j = std::abs(t - reference);
+        jitter_sum += j;
+        jitter_sq_sum += j * j;
+        jitter_max = std::max(jitter_max, j);
+    }
+    double jitter_mean = jitter_sum / frame_times.size();
+    double jitter_var = std::max(jitter_sq_sum / frame_times.size() - jitter_mean * jitter_mean, 0.0);
+
+    stats.average_frame_time = static_cast<float>(average);
+    stats.min_frame_time = min_time;
+    stats.max_frame_time = max_time;
+    stats.jitter_mean = static_cast<float>(jitter_mean);
+    stats.jitter_max = static_cast<float>(jitter_max);
+    stats.jitter_stddev = static_cast<float>(std::sqrt(jitter_var));
+    return stats;
+}
+
+void FrameLimiter::reset_stats(){
+    frame_times.clear();
+    frame_time_index = 0;
+    frame_count = 0;
+}
+
+}
@@ -0,0 +1,118 @@
+/**
+ * @file frame_limiter.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Classes for pacing the main game loop to a target frame rate and measuring
+ * how well that target was met
+ *
+ */
+
+#pragma once
+
+#include "frame_stats.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Paces a loop to a target frame rate
+ *
+ * Sleeping alone is not precise enough to hit a frame deadline, the OS
+ * scheduler can wake a thread up a millisecond or more late. To get around
+ * this the limiter sleeps in small steps while it is confident the sleep will
+ * not overshoot, then spins for the last fraction of a millisecond. How long a
+ * sleep "really" takes is estimated from previous sleeps.
+ *
+ * Deadlines are scheduled on a fixed grid (last deadline + frame time) so
+ * small errors do not accumulate into drift. If a frame runs more than a full
+ * frame late, the grid is reset instead of trying to catch up.
+ *
+ */
+class FrameLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor
+     *
+     * @param target_fps Frames per second to pace to, 0 means unlimited
+     */
+    FrameLimiter(int target_fps = 50);
+
+    /**
+     * @brief Sets the target frame rate
+     *
+     * A target of 0 disables the limiter, which is useful when the swapchain
+     * present mode (V-Sync) is already pacing the frames.
+     *
+     * @param fps Frames per second, 0 means unlimited
+     * @return void
+     */
+    void set_target_fps(int fps);
+
+    /**
+     * @brief Gets the target frame rate
+     * @return Frames per second, 0 means unlimited
+     */
+    int get_target_fps() const { return target_fps; }
+
+    /**
+     * @brief Waits until the next frame deadline
+     *
+     * This should be called exactly once per frame, after all the work of the
+     * frame is done. Once it returns the delta time and statistics are updated.
+     *
+     * @return void
+     */
+    void wait();
+
+    /**
+     * @brief Time between the start of the last two frames
+     * @return Delta time in seconds
+     */
+    float delta_time() const { return delta; }
+
+    /**
+     * @brief Gets the timing statistics of recent frames
+     *
+     * Statistics are computed over the last STATS_WINDOW frames.
+     *
+     * @return The frame statistics
+     */
+    FrameStats get_stats() const;
+
+    /**
+     * @brief Clears all recorded frame times
+     * @return void
+     */
+    void reset_stats();
+
+    static constexpr size_t STATS_WINDOW = 240;
+
+private:
+    void sleep_until(Clock::time_point deadline);
+    void record_frame(float frame_time);
+
+    int target_fps = 0;
+    Clock::duration frame_duration = Clock::duration::zero();
+    Clock::time_point next_deadline;
+    Clock::time_point last_frame;
+    bool started = false;
+    float delta = 0.0f;
+
+    /* Running estimate of how long a 1ms sleep really takes (seconds) */
+    double sleep_estimate = 5e-3;
+    double sleep_mean = 5e-3;
+    double sleep_m2 = 0.0;
+    uint64_t sleep_count = 1;
+
+    std::vector<float> frame_times;
+    size_t frame_time_index = 0;
+    uint64_t frame_count = 0;
+};
+
+}
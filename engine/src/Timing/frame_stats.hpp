@@ -0,0 +1,141 @@
+/**
+ * @file frame_stats.hpp
+ * @author Caleb Burke
+ * @date Oct 19, 2026
+ *
+ * Plain counters and timings the engine's systems keep about the last frame,
+ * and the statistics of recent frames they are gathered into
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hop {
+
+/**
+ * @brief Counters of the last rendered frame
+ *
+ * The object counts say how many objects were drawn from the merged static
+ * chunks and how many were drawn one by one. Each layer is recorded into its
+ * own command buffer, the command buffer counts say how many of those were
+ * reused as is and how many had to be recorded again.
+ *
+ * Redrawn fraction is how much of the screen the frame drew, see
+ * Game::set_partial_redraw. Immediate shapes counts the shapes drawn with
+ * Game::draw_rect and Game::draw_line, SDF shapes the ones drawn with
+ * Game::draw_circle, Game::draw_rounded_rect, Game::draw_ring and
+ * Game::draw_capsule.
+ *
+ * Culled objects is the amount of objects outside the render area left out
+ * by CPU culling. With gpu_culling the GPU culls them and they aren't counted.
+ */
+struct RenderStats {
+    uint32_t draw_calls = 0;
+    uint32_t static_objects = 0;
+    uint32_t dynamic_objects = 0;
+    uint32_t reused_command_buffers = 0;
+    uint32_t recorded_command_buffers = 0;
+    float redrawn_fraction = 1.0f;
+    uint32_t immediate_shapes = 0;
+    uint32_t sdf_shapes = 0;
+    uint32_t culled_objects = 0;
+    bool gpu_culling = false;
+};
+
+/**
+ * @brief Counters of the particle system
+ *
+ * Particles is the amount of live particles of CPU emitters and update_time
+ * the time spent moving and spawning them. Particles of the gpu_emitters GPU
+ * emitters aren't counted, dispatch_time is the CPU time spent recording
+ * their simulation. Times are in seconds.
+ */
+struct ParticleStats {
+    uint32_t particles = 0;
+    float update_time = 0.0f;
+    float dispatch_time = 0.0f;
+    uint32_t gpu_emitters = 0;
+};
+
+/**
+ * @brief What the last step did
+ *
+ * Candidate pairs are the pairs of bodies whose bounds overlapped and were
+ * tested for contact, contacts the ones that touched. Step time is in seconds.
+ */
+struct PhysicsStats {
+    uint32_t bodies = 0;
+    uint32_t candidate_pairs = 0;
+    uint32_t contacts = 0;
+    float step_time = 0.0f;
+};
+
+/**
+ * @brief How long one engine plugin's last update took, in seconds
+ */
+struct PluginTime {
+    std::string name;
+    float update_time = 0.0f;
+};
+
+/**
+ * @brief Timing statistics of recent frames
+ *
+ * All times are in seconds. Jitter is the difference between how long a frame
+ * actually took and how long it should have taken. When the frame rate is
+ * unlimited there is no target, so jitter is measured against the average
+ * frame time instead.
+ *
+ * Input latency is the time from a key event being received to the first
+ * frame that could show its result being handed to the presentation engine.
+ * It does not include the time the display takes to scan the image out.
+ *
+ * Skipped frames counts the updates that drew nothing because nothing
+ * changed, see Game::set_render_on_demand.
+ *
+ * Plugin times has the update time of every engine plugin, plugins that
+ * don't conflict update at the same time so these can add up to more than
+ * plugin_time, the wall time spent updating all of them.
+ *
+ * Physics time is the time spent stepping the physics world during the last
+ * update, over physics_steps steps (several or none with a fixed update).
+ *
+ * GPU time is how long the GPU spent on the newest finished frame, 0 when
+ * frames can't be timed. Render scale is the fraction of the window's
+ * resolution the last frame was drawn at, below 1 only with dynamic
+ * resolution.
+ *
+ * The counters of the renderer, the particle system and the last physics
+ * step are kept as they are, see RenderStats, ParticleStats and
+ * PhysicsStats.
+ *
+ */
+struct FrameStats {
+    float delta_time = 0.0f;
+    float target_frame_time = 0.0f;
+    float average_frame_time = 0.0f;
+    float min_frame_time = 0.0f;
+    float max_frame_time = 0.0f;
+    float jitter_mean = 0.0f;
+    float jitter_max = 0.0f;
+    float jitter_stddev = 0.0f;
+    float input_latency = 0.0f;
+    float average_input_latency = 0.0f;
+    uint64_t frame_count = 0;
+    uint64_t skipped_frames = 0;
+    float gpu_time = 0.0f;
+    float render_scale = 1.0f;
+    float plugin_time = 0.0f;
+    std::vector<PluginTime> plugin_times;
+    float physics_time = 0.0f;
+    uint32_t physics_steps = 0;
+    RenderStats render;
+    ParticleStats particles;
+    PhysicsStats physics;
+};
+
+}
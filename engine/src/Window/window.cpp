@@ -21,6 +21,7 @@ void Window::Initialize(bool fullscreen){
     }
     glfwSetWindowUserPointer(win, this);
     glfwSetFramebufferSizeCallback(win, framebuffer_resize_callback);
+    glfwSetWindowRefreshCallback(win, refresh_callback);
     window_open = true;
 }
 
@@ -43,6 +44,11 @@ void Window::framebuffer_resize_callback(GLFWwindow* window, int width, int heig
     _win->height = height;
 }
 
+void Window::refresh_callback(GLFWwindow* window){
+    auto _win = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+    _win->refresh_requested = true;
+}
+
 void Window::get_screen_resolution(){
     const GLFWvidmode* video_mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
     this->resolution_width = video_mode->width;
@@ -87,6 +87,20 @@ public:
      * @return void
      */
     void reset_window_resized_flag(){ framebuffer_resized = false; }
+
+    /**
+     * @brief Checks if the window system asked for the window to be redrawn
+     *
+     * This happens when the window was uncovered or restored. Checking clears
+     * the request.
+     *
+     * @return If the window has to be redrawn
+     */
+    bool take_refresh_request(){
+        bool requested = refresh_requested;
+        refresh_requested = false;
+        return requested;
+    }
     void Initialize(bool fullscreen);
     int get_resolution_width();
     int get_resolution_height();
@@ -97,8 +111,10 @@ public:
 private:
     
     static void framebuffer_resize_callback(GLFWwindow* win, int width, int height);
+    static void refresh_callback(GLFWwindow* win);
     void get_screen_resolution();
     bool framebuffer_resized = false;
+    bool refresh_requested = false;
     int width;
     int height;
     int resolution_width;
@@ -20,10 +20,14 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <Audio/audio.hpp>
+#include <Timing/frame_limiter.hpp>
+#include <Assets/asset_loader.hpp>
 #include <vector>
 #include <iostream>
 #include <chrono>
 #include <memory>
+#include <functional>
+#include <optional>
 
 namespace hop {
 typedef std::shared_ptr<hop::EngineRectangle> Rectangle;
@@ -31,6 +35,7 @@ typedef std::shared_ptr<hop::EngineCircle> Circle;
 typedef std::shared_ptr<hop::EngineGameObject> Triangle;
 typedef std::shared_ptr<hop::EngineGameObject> GameObject;
 typedef std::shared_ptr<hop::AudioEngine::EngineSound> Sound;
+typedef std::shared_ptr<hop::ParticleEmitter> Emitter;
 // Colors objects can be set to
 #define RED Color{1.0f, 0.0f, 0.0f}
 #define GREEN Color{0.0f, 1.0f, 0.0f}
@@ -54,10 +59,53 @@ class Game{
     void update();
     bool is_running();
     void stop();
+    void set_target_fps(int fps);
+    int get_target_fps();
+    float delta_time();
+    FrameStats get_frame_stats();
+    bool set_fixed_update(std::function<void(float)> callback, int updates_per_second = 120);
+    void set_latency_mode(LatencyMode mode);
+    LatencyMode get_latency_mode();
+    bool set_frames_in_flight(int frames);
+    int get_frames_in_flight();
+    bool set_static_promotion_frames(int frames);
+    bool set_render_on_demand(bool enabled, float max_idle_seconds = Engine::DEFAULT_IDLE_TIMEOUT);
+    void request_redraw();
+    void set_partial_redraw(bool enabled);
+    bool set_gpu_culling(bool enabled);
+    void set_front_to_back(bool enabled);
+    bool set_dynamic_resolution(bool enabled, int target_fps = 60);
+    void set_camera_position(float x, float y);
+    void move_camera(float x, float y);
+    bool set_camera_zoom(float zoom);
+    void set_camera_rotation(float degrees);
+    void reset_camera();
+    bool draw_rect(int x, int y, int width, int height, Color color);
+    bool draw_line(int x1, int y1, int x2, int y2, Color color, float thickness = 1.0f);
+    bool draw_circle(int x, int y, float radius, Color color);
+    bool draw_rounded_rect(int x, int y, int width, int height, float corner_radius, Color color);
+    bool draw_ring(int x, int y, float radius, float thickness, Color color);
+    bool draw_capsule(int x1, int y1, int x2, int y2, float radius, Color color);
+    Emitter create_emitter(int x, int y, const EmitterDesc& desc = {});
     Rectangle create_rectangle(int x, int y, int width, int height, Color color);
     Circle create_circle(int x, int y, int radius, Color color);
     Triangle create_triangle(int v1x, int v1y, int v2x, int v2y, int v3x, int v3y, Color color);
+    std::vector<Rectangle> create_rectangles(const std::vector<RectDesc>& rects);
+    std::vector<Circle> create_circles(const std::vector<CircleDesc>& circles);
+    std::vector<Triangle> create_triangles(const std::vector<TriangleDesc>& triangles);
     Sound create_sound(const char* file_name, bool loop_sound);
+    std::shared_future<Sound> load_sound(const char* file_name, bool loop_sound, std::function<void(const Sound&)> on_loaded = nullptr);
+    template<typename T>
+    std::shared_future<T> load_asset(std::function<T()> load, std::function<void(const T&)> on_loaded = nullptr){
+        return asset_loader.load<T>(std::move(load), std::move(on_loaded));
+    }
+    size_t assets_loading();
+    bool set_worker_threads(int count, bool pin_threads = false);
+    JobSystem& get_job_system();
+    Body add_body(const Rectangle& rectangle, BodyType type, const BodyDesc& desc = {});
+    Body add_body(const Circle& circle, BodyType type, const BodyDesc& desc = {});
+    void remove_body(Body body);
+    PhysicsWorld& get_physics();
     bool monitor_key(int key_code);
     bool key_pressed(int key);
     bool key_held(int key);
@@ -67,11 +115,26 @@ class Game{
     std::vector<int> get_released_keys();
 
     private:
+    friend class Image;
     AudioEngine audio_engine;
     std::shared_ptr<Engine> graphics_engine;
     std::shared_ptr<Keyboard> keyboard;
     bool engine_stopped = false;
     bool fullscreen = false;
+    FrameLimiter frame_limiter;
+    AssetLoader asset_loader;
+    std::function<void(float)> fixed_update;
+    float fixed_step = 0.0f;
+    float fixed_accumulator = 0.0f;
+    static constexpr int MAX_FIXED_STEPS = 8;
+    void run_fixed_updates();
+    void step_physics(float step);
+    float physics_time = 0.0f;
+    uint32_t physics_steps = 0;
+    static constexpr float MAX_PHYSICS_STEP = 1.0f / 30.0f;
+    float input_latency = 0.0f;
+    float average_input_latency = 0.0f;
+    void measure_input_latency(std::optional<std::chrono::steady_clock::time_point> input_time);
     void console_warning(const char* function, const char* error_msg);
     std::vector<int> valid_keys;
     void initialize_valid_keys();
@@ -97,15 +160,36 @@ class Image{
     int get_y();
     int get_height();
     int get_width();
+    const std::vector<GameObject>& get_objects();
+    bool bake();
+    void unbake();
+    bool is_baked();
 
     private:
+    struct BakeState {
+        Entity merged;
+        std::weak_ptr<BakeState> parent;
+    };
     int x;
     int y;
     int width;
     int height;
+    int origin_x;
+    /* Frees the scene node once the last copy of the image is gone */
+    struct NodeOwner {
+        NodeId node;
+        std::weak_ptr<Engine> engine;
+        ~NodeOwner();
+    };
+    NodeId node = NO_NODE;
+    std::shared_ptr<NodeOwner> node_owner;
+    std::shared_ptr<BakeState> bake_state = std::make_shared<BakeState>();
     std::vector<Image> images;
     inline static Game* game;
     void console_warning(const char* function, const char* error_msg);
+    bool attach(const GameObject& object);
+    void collect_entities(std::vector<Entity>& parts);
+    void unbake_parents();
     std::vector<GameObject> game_objects;
 
 };
@@ -0,0 +1,422 @@
+#include "hop.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// How long every benchmark runs for once everything is created
+const float BENCHMARK_SECONDS = 10.0f;
+
+void usage(){
+    std::cout << "usage: ./app.bin <benchmark>" << std::endl;
+    std::cout << "\tphysics    10000 boxes and circles falling into a pile" << std::endl;
+    std::cout << "\tparticles  100000 live particles from four emitters" << std::endl;
+    std::cout << "\tgpu        1000000 particles simulated by a compute shader" << std::endl;
+    std::cout << "\tculling    50000 moving rectangles, most off screen, culled on the CPU" << std::endl;
+    std::cout << "\tgpu-cull   the same rectangles culled by a compute shader" << std::endl;
+    std::cout << "\tsdf        20000 overlapping circles, tessellated and then as SDF quads" << std::endl;
+    std::cout << "\tcamera     50000 still rectangles panned over by the camera" << std::endl;
+    std::cout << "\tfill       64 stacked screen sized rectangles, back to front and then front to back" << std::endl;
+    std::cout << "\tresolution the blended rectangles with the resolution scaled to 60 fps" << std::endl;
+}
+
+// Runs the game loop for BENCHMARK_SECONDS, calling report with the stats of every frame
+void run_for(hop::Game& game, std::function<void(const hop::FrameStats&)> report){
+    auto start = std::chrono::steady_clock::now();
+    while(game.is_running()){
+        game.update();
+        if(game.key_pressed(KEY_ESCAPE)){
+            game.stop();
+        }
+        report(game.get_frame_stats());
+        if(std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() > BENCHMARK_SECONDS){
+            break;
+        }
+    }
+}
+
+void physics_benchmark(hop::Game& game){
+    const int BODIES = 10000;
+    const int SIZE = 6;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    // Walls and a floor to pile up in
+    game.add_body(game.create_rectangle(0, 0, width, 40, hop::WHITE), hop::BodyType::STATIC);
+    game.add_body(game.create_rectangle(0, 0, 40, height, hop::WHITE), hop::BodyType::STATIC);
+    game.add_body(game.create_rectangle(width - 40, 0, 40, height, hop::WHITE), hop::BodyType::STATIC);
+
+    // Half boxes, half circles, spread over the top of the screen
+    std::vector<hop::RectDesc> boxes;
+    std::vector<hop::CircleDesc> circles;
+    int columns = (width - 100) / (SIZE * 2);
+    for(int i = 0; i < BODIES; i++){
+        int x = 50 + (i % columns) * SIZE * 2;
+        int y = 100 + (i / columns) * SIZE * 2;
+        if(i % 2 == 0){
+            boxes.push_back({x, y, SIZE, SIZE, hop::RED});
+        } else {
+            circles.push_back({x, y, SIZE / 2, hop::GREEN});
+        }
+    }
+    for(auto& box : game.create_rectangles(boxes)){
+        game.add_body(box, hop::BodyType::DYNAMIC);
+    }
+    for(auto& circle : game.create_circles(circles)){
+        game.add_body(circle, hop::BodyType::DYNAMIC);
+    }
+
+    // Physics steps 60 times a second, rendering runs as fast as it can
+    game.set_target_fps(0);
+    game.set_fixed_update([](float){}, 60);
+
+    double physics_time = 0.0;
+    double frame_time = 0.0;
+    uint64_t frames = 0;
+    uint64_t steps = 0;
+    uint32_t contacts = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        physics_time += stats.physics_time;
+        steps += stats.physics_steps;
+        frame_time += stats.delta_time;
+        contacts = stats.physics.contacts;
+        frames++;
+    });
+
+    std::cout << "bodies:           " << game.get_physics().size() << std::endl;
+    std::cout << "contacts:         " << contacts << std::endl;
+    std::cout << "ms per step:      " << (steps > 0 ? physics_time / steps * 1000.0 : 0.0) << std::endl;
+    std::cout << "bodies per ms:    " << (physics_time > 0 ? game.get_physics().size() * steps / (physics_time * 1000.0) : 0.0) << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+void particle_benchmark(hop::Game& game){
+    const uint32_t PARTICLES = 100000;
+    const int EMITTERS = 4;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    // Every emitter spawns faster than its particles die, so the pools stay full
+    hop::EmitterDesc desc;
+    desc.max_particles = PARTICLES / EMITTERS;
+    desc.rate = 20000.0f;
+    desc.lifetime_min = 1.0f;
+    desc.lifetime_max = 2.0f;
+    desc.size_start = 3.0f;
+    desc.size_end = 1.0f;
+    desc.color_start = glm::vec3(1.0f, 0.8f, 0.2f);
+    desc.color_end = glm::vec3(1.0f, 0.1f, 0.0f);
+    for(int i = 0; i < EMITTERS; i++){
+        desc.shape = i % 2 == 0 ? hop::ParticleShape::QUAD : hop::ParticleShape::CIRCLE;
+        game.create_emitter(width * (i + 1) / (EMITTERS + 1), height / 3, desc);
+    }
+
+    game.set_target_fps(0);
+
+    double update_time = 0.0;
+    double frame_time = 0.0;
+    uint64_t frames = 0;
+    uint32_t particles = 0;
+    uint32_t draw_calls = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        update_time += stats.particles.update_time;
+        frame_time += stats.delta_time;
+        particles = stats.particles.particles;
+        draw_calls = stats.render.draw_calls;
+        frames++;
+    });
+
+    std::cout << "particles:        " << particles << std::endl;
+    std::cout << "draw calls:       " << draw_calls << std::endl;
+    std::cout << "ms per update:    " << (frames > 0 ? update_time / frames * 1000.0 : 0.0) << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+void gpu_particle_benchmark(hop::Game& game){
+    const uint32_t PARTICLES = 1000000;
+    const int EMITTERS = 4;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    hop::EmitterDesc desc;
+    desc.simulate_on_gpu = true;
+    desc.max_particles = PARTICLES / EMITTERS;
+    desc.rate = 200000.0f;
+    desc.lifetime_min = 1.0f;
+    desc.lifetime_max = 2.0f;
+    desc.size_start = 2.0f;
+    desc.size_end = 0.5f;
+    desc.color_start = glm::vec3(0.2f, 0.6f, 1.0f);
+    desc.color_end = glm::vec3(0.8f, 0.1f, 1.0f);
+    for(int i = 0; i < EMITTERS; i++){
+        game.create_emitter(width * (i + 1) / (EMITTERS + 1), height / 3, desc);
+    }
+
+    game.set_target_fps(0);
+
+    // Everything the CPU does for the particles, the GPU work only shows in the frame time
+    double cpu_time = 0.0;
+    double frame_time = 0.0;
+    uint64_t frames = 0;
+    uint32_t emitters = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        cpu_time += stats.particles.update_time + stats.particles.dispatch_time;
+        frame_time += stats.delta_time;
+        emitters = stats.particles.gpu_emitters;
+        frames++;
+    });
+
+    std::cout << "gpu emitters:     " << emitters << std::endl;
+    std::cout << "max particles:    " << PARTICLES << std::endl;
+    std::cout << "cpu ms per frame: " << (frames > 0 ? cpu_time / frames * 1000.0 : 0.0) << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+void culling_benchmark(hop::Game& game, bool on_gpu){
+    const int OBJECTS = 50000;
+    const int SIZE = 4;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    if(on_gpu && !game.set_gpu_culling(true)){
+        return;
+    }
+
+    // Spread over nine screens, so only about one in nine is visible
+    std::vector<hop::RectDesc> rects;
+    for(int i = 0; i < OBJECTS; i++){
+        int x = (i * 7919) % (width * 3) - width;
+        int y = (i * 6007) % (height * 3) - height;
+        rects.push_back({x, y, SIZE, SIZE, i % 2 == 0 ? hop::RED : hop::BLUE});
+    }
+    std::vector<hop::Rectangle> objects = game.create_rectangles(rects);
+
+    game.set_target_fps(0);
+
+    double frame_time = 0.0;
+    uint64_t frames = 0;
+    uint32_t draw_calls = 0;
+    uint32_t culled = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        // Everything moves every frame, so no layer's commands can be reused
+        int step = frames % 2 == 0 ? 1 : -1;
+        for(auto& object : objects){
+            object->move(step, 0);
+        }
+        frame_time += stats.delta_time;
+        draw_calls = stats.render.draw_calls;
+        culled = stats.render.culled_objects;
+        frames++;
+    });
+
+    std::cout << "objects:          " << objects.size() << std::endl;
+    std::cout << "gpu culling:      " << (on_gpu ? "on" : "off") << std::endl;
+    std::cout << "culled on cpu:    " << culled << std::endl;
+    std::cout << "draw calls:       " << draw_calls << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+void sdf_benchmark(hop::Game& game){
+    const int CIRCLES = 20000;
+    const int RADIUS = 40;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    // The whole screen is drawn every frame, so only the cost of filling the circles differs
+    game.set_target_fps(0);
+    game.set_partial_redraw(false);
+
+    std::vector<hop::CircleDesc> descs;
+    for(int i = 0; i < CIRCLES; i++){
+        int x = (i * 7919) % (width - 2 * RADIUS);
+        int y = (i * 6007) % (height - 2 * RADIUS);
+        descs.push_back({x, y, RADIUS, i % 2 == 0 ? hop::RED : hop::GREEN});
+    }
+
+    double tessellated_time = 0.0;
+    uint64_t tessellated_frames = 0;
+    std::vector<hop::Circle> circles = game.create_circles(descs);
+    run_for(game, [&](const hop::FrameStats& stats){
+        tessellated_time += stats.delta_time;
+        tessellated_frames++;
+    });
+    for(auto& circle : circles){
+        circle->destroy();
+    }
+
+    double sdf_time = 0.0;
+    uint64_t sdf_frames = 0;
+    uint32_t shapes = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        for(const auto& desc : descs){
+            game.draw_circle(desc.x + RADIUS, desc.y + RADIUS, RADIUS, desc.color);
+        }
+        sdf_time += stats.delta_time;
+        shapes = stats.render.sdf_shapes;
+        sdf_frames++;
+    });
+
+    std::cout << "circles:          " << CIRCLES << std::endl;
+    std::cout << "sdf shapes:       " << shapes << std::endl;
+    std::cout << "tessellated ms:   " << (tessellated_frames > 0 ? tessellated_time / tessellated_frames * 1000.0 : 0.0) << std::endl;
+    std::cout << "sdf ms:           " << (sdf_frames > 0 ? sdf_time / sdf_frames * 1000.0 : 0.0) << std::endl;
+}
+
+void camera_benchmark(hop::Game& game){
+    const int OBJECTS = 50000;
+    const int SIZE = 4;
+    const float SPEED = 200.0f;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    // A world nine screens big that never moves, only the camera does
+    std::vector<hop::RectDesc> rects;
+    for(int i = 0; i < OBJECTS; i++){
+        int x = (i * 7919) % (width * 3) - width;
+        int y = (i * 6007) % (height * 3) - height;
+        rects.push_back({x, y, SIZE, SIZE, i % 2 == 0 ? hop::RED : hop::BLUE});
+    }
+    std::vector<hop::Rectangle> objects = game.create_rectangles(rects);
+
+    game.set_target_fps(0);
+
+    double frame_time = 0.0;
+    uint64_t frames = 0;
+    uint32_t reused = 0;
+    uint32_t recorded = 0;
+    float time = 0.0f;
+    run_for(game, [&](const hop::FrameStats& stats){
+        // Sweeps back and forth over the world
+        time += stats.delta_time;
+        float x = std::fmod(time * SPEED, width * 4.0f);
+        game.set_camera_position((x < width * 2.0f ? x : width * 4.0f - x) - width, 0.0f);
+        frame_time += stats.delta_time;
+        reused = stats.render.reused_command_buffers;
+        recorded = stats.render.recorded_command_buffers;
+        frames++;
+    });
+
+    std::cout << "objects:          " << objects.size() << std::endl;
+    std::cout << "reused layers:    " << reused << std::endl;
+    std::cout << "recorded layers:  " << recorded << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+void fill_benchmark(hop::Game& game){
+    const int STACK = 64;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    // The whole screen is drawn every frame, so only the cost of filling it differs
+    game.set_target_fps(0);
+    game.set_partial_redraw(false);
+
+    // Opaque and on their own layers, so drawing them front to back lets the
+    // depth test reject everything below the top one before it's shaded
+    std::vector<hop::RectDesc> rects;
+    for(int i = 0; i < STACK; i++){
+        rects.push_back({0, 0, width, height, i % 2 == 0 ? hop::RED : hop::BLUE});
+    }
+    std::vector<hop::Rectangle> stack = game.create_rectangles(rects);
+    for(int i = 0; i < STACK; i++){
+        stack[i]->set_layer(i);
+    }
+
+    // The same rectangles drawn both ways, only the order of the layers differs
+    auto measure = [&](bool front_to_back){
+        game.set_front_to_back(front_to_back);
+        double time = 0.0;
+        uint64_t frames = 0;
+        run_for(game, [&](const hop::FrameStats& stats){
+            time += stats.delta_time;
+            frames++;
+        });
+        return frames > 0 ? time / frames * 1000.0 : 0.0;
+    };
+    double back_to_front_ms = measure(false);
+    double front_to_back_ms = measure(true);
+    for(auto& rect : stack){
+        rect->destroy();
+    }
+
+    double pixels = static_cast<double>(width) * height * STACK;
+    std::cout << "layers:           " << STACK << std::endl;
+    std::cout << "pixels per frame: " << pixels << std::endl;
+    std::cout << "back to front ms: " << back_to_front_ms << std::endl;
+    std::cout << "front to back ms: " << front_to_back_ms << std::endl;
+}
+
+void resolution_benchmark(hop::Game& game){
+    const int STACK = 64;
+    int width = game.get_resolution_width();
+    int height = game.get_resolution_height();
+
+    if(!game.set_dynamic_resolution(true, 60)){
+        return;
+    }
+    game.set_target_fps(0);
+
+    // Fill bound, so the frame time follows the resolution
+    double gpu_time = 0.0;
+    double frame_time = 0.0;
+    double scale = 0.0;
+    uint64_t frames = 0;
+    float last_scale = 1.0f;
+    int scale_changes = 0;
+    run_for(game, [&](const hop::FrameStats& stats){
+        for(int i = 0; i < STACK; i++){
+            game.draw_rounded_rect(0, 0, width, height, 0.0f, i % 2 == 0 ? hop::RED : hop::BLUE);
+        }
+        if(stats.render_scale != last_scale){
+            scale_changes++;
+            last_scale = stats.render_scale;
+        }
+        gpu_time += stats.gpu_time;
+        frame_time += stats.delta_time;
+        scale += stats.render_scale;
+        frames++;
+    });
+
+    std::cout << "final scale:      " << last_scale << std::endl;
+    std::cout << "average scale:    " << (frames > 0 ? scale / frames : 0.0) << std::endl;
+    std::cout << "scale changes:    " << scale_changes << std::endl;
+    std::cout << "gpu ms per frame: " << (frames > 0 ? gpu_time / frames * 1000.0 : 0.0) << std::endl;
+    std::cout << "ms per frame:     " << (frames > 0 ? frame_time / frames * 1000.0 : 0.0) << std::endl;
+}
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        usage();
+        return 1;
+    }
+
+    hop::Game game("Benchmark");
+    game.run();
+    game.monitor_key(KEY_ESCAPE);
+
+    if(std::strcmp(argv[1], "physics") == 0){
+        physics_benchmark(game);
+    } else if(std::strcmp(argv[1], "particles") == 0){
+        particle_benchmark(game);
+    } else if(std::strcmp(argv[1], "gpu") == 0){
+        gpu_particle_benchmark(game);
+    } else if(std::strcmp(argv[1], "culling") == 0){
+        culling_benchmark(game, false);
+    } else if(std::strcmp(argv[1], "gpu-cull") == 0){
+        culling_benchmark(game, true);
+    } else if(std::strcmp(argv[1], "sdf") == 0){
+        sdf_benchmark(game);
+    } else if(std::strcmp(argv[1], "camera") == 0){
+        camera_benchmark(game);
+    } else if(std::strcmp(argv[1], "fill") == 0){
+        fill_benchmark(game);
+    } else if(std::strcmp(argv[1], "resolution") == 0){
+        resolution_benchmark(game);
+    } else {
+        usage();
+        return 1;
+    }
+    return 0;
+}
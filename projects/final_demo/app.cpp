@@ -95,6 +95,12 @@ int main(){
     tom.create_circle (0,15,10,grey); //bunny tail
     tom.create_rectangle(20,0,10,10,grey); //bunny back feet
     tom.create_rectangle(60,0,10,10,grey); //bunny front feet
+
+    // these are only ever moved or flipped as a whole, draw each in one call
+    stairs.bake();
+    heart.bake();
+    hank.bake();
+    tom.bake();
  
 
     std::vector<hop::GameObject> background;
@@ -102,12 +108,10 @@ int main(){
 
     monitor_keys(&game);
     float falling_duration = 1.0;
-    while(game.is_running()){
-        game.update();
-        if(game.key_pressed(KEY_ESCAPE)){
-            game.stop();
-        }
-
+    // Gameplay runs at a fixed 50 updates per second no matter how fast the
+    // screen refreshes, rendering smoothly interpolates between updates
+    game.set_target_fps(120);
+    game.set_fixed_update([&](float){
         if(game.key_pressed(KEY_SPACE)&&(bunny_grounded(&hank,&stairs))){
             if(hank_right){
                 hank.move(200,100);   
@@ -149,6 +153,13 @@ int main(){
         else{
             falling_duration = 0.0;
         }
+    }, 50);
+
+    while(game.is_running()){
+        game.update();
+        if(game.key_pressed(KEY_ESCAPE)){
+            game.stop();
+        }
     }
 
     return 0;
@@ -192,7 +203,7 @@ bool bunny_grounded(hop::Image *hank, hop::Image* terrain){
     int bun_minx = hank->get_x();
     int bun_maxx = hank->get_x() + hank->get_width();
 
-    for(auto obj: terrain->game_objects){
+    for(auto obj: terrain->get_objects()){
         bool x_overlap = false;
         int obj_minx = obj->x;
         int obj_maxx = obj->x + obj->width;
@@ -135,18 +135,19 @@ int main(){
     int cpu_lives = 3;
     Ball ball(&game);
     hop::TextBox title(660,25,5,hop::GREEN,"PONG!");
-    hop::Sound background_music = game.create_sound("pong_background.mp3", true);
+    // The music is decoded in the background and starts once it's ready
+    game.load_sound("pong_background.mp3", true, [](const hop::Sound& background_music){
+        if(background_music!=NULL){
+            background_music->play();
+        }
+    });
     hop::Sound boing = game.create_sound("boing.wav", false);
-    if(background_music!=NULL){
-        background_music->play();
-    }
 
 
-    while(game.is_running()){
-        game.update();
-        if(game.key_pressed(KEY_ESCAPE)){
-            game.stop();
-        }    
+    // Gameplay runs at a fixed 50 updates per second no matter how fast the
+    // screen refreshes, rendering smoothly interpolates between updates
+    game.set_target_fps(120);
+    game.set_fixed_update([&](float){
         if(game.key_pressed(KEY_UP)||game.key_held(KEY_UP)){
             player_paddle.move_up(15);
         }
@@ -202,6 +203,13 @@ int main(){
                 hop::TextBox title(560,600,4,hop::RED,"You WIN!");
             }
         }
+    }, 50);
+
+    while(game.is_running()){
+        game.update();
+        if(game.key_pressed(KEY_ESCAPE)){
+            game.stop();
+        }    
     }
 
     return 0;